@@ -0,0 +1,150 @@
+#include "AlphaCoverage.h"
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <stb_image.h>
+
+using namespace std;
+
+void AlphaCoverage::analyze(const uint8_t *pixels, int width, int height, int tileSize)
+{
+    _width = width;
+    _height = height;
+    _tileSize = tileSize;
+    _cols = (width + tileSize - 1) / tileSize;
+    _rows = (height + tileSize - 1) / tileSize;
+    _tiles.assign(size_t(_cols) * _rows, COVERAGE_EMPTY);
+
+    // Menor e maior alfa de cada bloco de uma linha de blocos, varrendo as linhas de pixels em ordem
+    vector<uint8_t> lo(_cols), hi(_cols);
+    for (int row = 0; row < _rows; row++)
+    {
+        fill(lo.begin(), lo.end(), uint8_t(255));
+        fill(hi.begin(), hi.end(), uint8_t(0));
+        int y1 = min(height, (row + 1) * tileSize);
+        for (int y = row * tileSize; y < y1; y++)
+        {
+            const uint8_t *alpha = pixels + size_t(y) * width * 4 + 3;
+            for (int col = 0; col < _cols; col++)
+            {
+                int x1 = min(width, (col + 1) * tileSize);
+                uint8_t a = lo[col], b = hi[col];
+                for (int x = col * tileSize; x < x1; x++)
+                {
+                    a = min(a, alpha[x * 4]);
+                    b = max(b, alpha[x * 4]);
+                }
+                lo[col] = a;
+                hi[col] = b;
+            }
+        }
+
+        for (int col = 0; col < _cols; col++)
+        {
+            CoverageClass coverage = hi[col] == 0 ? COVERAGE_EMPTY : lo[col] == 255 ? COVERAGE_OPAQUE : COVERAGE_MIXED;
+            _tiles[size_t(row) * _cols + col] = coverage;
+        }
+    }
+
+    // Os níveis menores da textura (a GL pode começar num deles) misturam o alfa além da borda do bloco:
+    // só fica vazio ou opaco o bloco cujos vizinhos, nas 8 direções, são da mesma classe
+    vector<uint8_t> classes(_tiles);
+    for (int row = 0; row < _rows; row++)
+    {
+        for (int col = 0; col < _cols; col++)
+        {
+            uint8_t &coverage = _tiles[size_t(row) * _cols + col];
+            for (int y = max(0, row - 1); y <= min(_rows - 1, row + 1) && coverage != COVERAGE_MIXED; y++)
+            {
+                for (int x = max(0, col - 1); x <= min(_cols - 1, col + 1); x++)
+                {
+                    if (classes[size_t(y) * _cols + x] != coverage)
+                    {
+                        coverage = COVERAGE_MIXED;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool AlphaCoverage::load(const string &imagePath, int tileSize)
+{
+    MappedFile file;
+    if (file.open(textureFilePath(imagePath)))
+    {
+        const TextureFileHeader *header = textureFileHeader(file);
+        if (header)
+        {
+            analyze(file.data() + header->levels[0].offset, header->width, header->height, tileSize);
+            return true;
+        }
+    }
+
+    int width, height, channels;
+    unsigned char *data = stbi_load(imagePath.c_str(), &width, &height, &channels, 4);
+    if (!data)
+        return false;
+    analyze(data, width, height, tileSize);
+    stbi_image_free(data);
+    return true;
+}
+
+void AlphaCoverage::rects(CoverageClass coverage, vector<CoverageRect> &out) const
+{
+    out.clear();
+
+    // Retângulos que terminam na linha de blocos anterior e ainda podem crescer para baixo
+    vector<size_t> open, next;
+    for (int row = 0; row < _rows; row++)
+    {
+        int y = row * _tileSize, h = min(_height, y + _tileSize) - y;
+        next.clear();
+        for (int col = 0; col < _cols;)
+        {
+            if (tile(col, row) != coverage)
+            {
+                col++;
+                continue;
+            }
+            int first = col;
+            while (col < _cols && tile(col, row) == coverage)
+                col++;
+            int x = first * _tileSize, w = min(_width, col * _tileSize) - x;
+
+            auto same = find_if(open.begin(), open.end(), [&](size_t i)
+                                { return out[i].x == x && out[i].width == w; });
+            if (same != open.end())
+            {
+                out[*same].height += h;
+                next.push_back(*same);
+            }
+            else
+            {
+                next.push_back(out.size());
+                out.push_back({x, y, w, h});
+            }
+        }
+        open.swap(next);
+    }
+}
+
+double AlphaCoverage::fraction(CoverageClass coverage) const
+{
+    if (_width == 0 || _height == 0)
+        return 0.0;
+
+    // Os blocos da última coluna e da última linha podem ser menores
+    double area = 0.0;
+    for (int row = 0; row < _rows; row++)
+    {
+        int h = min(_height, (row + 1) * _tileSize) - row * _tileSize;
+        for (int col = 0; col < _cols; col++)
+        {
+            if (tile(col, row) == coverage)
+                area += double(min(_width, (col + 1) * _tileSize) - col * _tileSize) * h;
+        }
+    }
+    return area / (double(_width) * _height);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Cobertura do alfa de uma imagem, em blocos de tileSize x tileSize pixels:
+ *
+ *   vazio   todos os pixels com alfa 0: não precisa ser desenhado
+ *   opaco   todos com alfa 255: pode ir sem blend, da frente para trás, com depth
+ *   misto   o resto: precisa de blend
+ *
+ * Um bloco vazio ou opaco com algum vizinho (nas 8 direções) de outra classe
+ * também conta como misto, porque os mipmaps misturam o alfa além da borda.
+ *
+ * rects() junta os blocos da mesma classe em retângulos (faixas em cada linha
+ * de blocos, e faixas iguais em linhas seguidas), para malhas com poucos
+ * vértices. Sem GL: o Parallax monta as malhas a partir dos retângulos.
+ */
+
+enum CoverageClass : uint8_t
+{
+    COVERAGE_EMPTY,
+    COVERAGE_OPAQUE,
+    COVERAGE_MIXED
+};
+
+// Em pixels da imagem, com y de cima para baixo (a ordem das linhas do stbi_load e do .ptex)
+struct CoverageRect
+{
+    int x, y, width, height;
+};
+
+class AlphaCoverage
+{
+public:
+    // 4 bytes por pixel, linhas sem padding; o alfa é o quarto byte (RGBA ou BGRA)
+    void analyze(const uint8_t *pixels, int width, int height, int tileSize = 32);
+    // Nível 0 do .ptex ao lado da imagem, se houver; senão stbi_load
+    bool load(const std::string &imagePath, int tileSize = 32);
+
+    int width() const { return _width; }
+    int height() const { return _height; }
+    int tileSize() const { return _tileSize; }
+    int cols() const { return _cols; }
+    int rows() const { return _rows; }
+    CoverageClass tile(int col, int row) const { return CoverageClass(_tiles[size_t(row) * _cols + col]); }
+
+    void rects(CoverageClass coverage, std::vector<CoverageRect> &out) const;
+
+    // Fração da área da imagem nos blocos da classe
+    double fraction(CoverageClass coverage) const;
+
+private:
+    int _width = 0, _height = 0;
+    int _tileSize = 0, _cols = 0, _rows = 0;
+    std::vector<uint8_t> _tiles;
+};
@@ -0,0 +1,335 @@
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include "GLState.h"
+#include "MipChain.h"
+#include "Texture.h"
+#include "TextureFile.h"
+
+using namespace std;
+
+struct AssetLoader::Job
+{
+    int handle;
+    string path;
+    GLint filter;
+    int screenWidth, screenHeight;
+
+    bool ok = false;
+    int width = 0, height = 0;
+    GLenum format = GL_RGBA;
+
+    // Níveis vindos de um .ptex mapeado ou de um PNG decodificado + mipmaps da CPU
+    MappedFile file;
+    vector<vector<uint8_t>> levels;
+    vector<const uint8_t *> levelData;
+    vector<int> levelWidth, levelHeight;
+    size_t bytesSkipped = 0;
+
+    int level = 0;
+    int row = 0;
+};
+
+AssetLoader::AssetLoader(size_t bytesPerFrame, int workers)
+    : _budget(bytesPerFrame), _quit(false), _inFlight(0), _firstFrame(true)
+{
+    // Os tempos são medidos desde o glfwInit(), que é quando glfwGetTime() começa em zero
+    _start_s = 0.0;
+    _lastUpdate_s = glfwGetTime();
+
+    GLubyte gray[4] = {64, 64, 64, 255};
+    glGenTextures(1, &_placeholder);
+    GLState::bindTexture(GL_TEXTURE_2D, _placeholder);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, gray);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
+
+    glGenBuffers(1, &_pbo);
+
+    if (workers <= 0)
+        workers = max(1, int(thread::hardware_concurrency()) - 1);
+    for (int i = 0; i < workers; i++)
+        _workers.emplace_back(&AssetLoader::workerLoop, this);
+}
+
+AssetLoader::~AssetLoader()
+{
+    {
+        lock_guard<mutex> lock(_mutex);
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (thread &worker : _workers)
+        worker.join();
+}
+
+int AssetLoader::request(const string &filePath, GLint filter, GLint wrap, int screenWidth, int screenHeight)
+{
+    Entry entry;
+    glGenTextures(1, &entry.texID);
+    GLState::bindTexture(GL_TEXTURE_2D, entry.texID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureMagFilter(filter));
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
+    entry.resident = false;
+    _entries.push_back(entry);
+
+    unique_ptr<Job> job(new Job());
+    job->handle = int(_entries.size()) - 1;
+    job->path = filePath;
+    job->filter = filter;
+    job->screenWidth = screenWidth;
+    job->screenHeight = screenHeight;
+    {
+        lock_guard<mutex> lock(_mutex);
+        _pending.push_back(move(job));
+        _inFlight++;
+    }
+    _wake.notify_one();
+
+    _stats.requested++;
+    return int(_entries.size()) - 1;
+}
+
+GLuint AssetLoader::texture(int handle) const
+{
+    if (handle < 0 || handle >= int(_entries.size()) || !_entries[handle].resident)
+        return _placeholder;
+    return _entries[handle].texID;
+}
+
+bool AssetLoader::resident(int handle) const
+{
+    return handle >= 0 && handle < int(_entries.size()) && _entries[handle].resident;
+}
+
+bool AssetLoader::busy() const
+{
+    lock_guard<mutex> lock(_mutex);
+    return _inFlight > 0;
+}
+
+void AssetLoader::workerLoop()
+{
+    while (true)
+    {
+        unique_ptr<Job> job;
+        {
+            unique_lock<mutex> lock(_mutex);
+            _wake.wait(lock, [this]
+                       { return _quit || !_pending.empty(); });
+            if (_quit)
+                return;
+            job = move(_pending.front());
+            _pending.pop_front();
+        }
+
+        decode(*job);
+
+        lock_guard<mutex> lock(_mutex);
+        _decoded.push_back(move(job));
+    }
+}
+
+// Lê um byte de cada página, para que as faltas de página do arquivo mapeado aconteçam na thread de trabalho
+static void touchPages(const uint8_t *data, size_t size)
+{
+    const size_t PAGE = 4096;
+    volatile uint8_t sink = 0;
+    for (size_t i = 0; i < size; i += PAGE)
+        sink = sink + data[i];
+    if (size > 0)
+        sink = sink + data[size - 1];
+}
+
+void AssetLoader::decode(Job &job)
+{
+    if (job.file.open(textureFilePath(job.path)))
+    {
+        const TextureFileHeader *header = textureFileHeader(job.file);
+        if (header)
+        {
+            job.width = header->width;
+            job.height = header->height;
+            job.format = header->layout == LAYOUT_BGRA ? GL_BGRA : GL_RGBA;
+
+            // Só os níveis que a GL pode amostrar no tamanho pedido
+            int levelCount = int(header->levelCount);
+            int base = min(textureBaseLevel(job.width, job.height, job.screenWidth, job.screenHeight), levelCount - 1);
+            int count = min(textureLevelCount(job.width, job.height, base, job.filter), levelCount - base);
+            for (int i = 0; i < levelCount; i++)
+            {
+                if (i < base || i >= base + count)
+                {
+                    job.bytesSkipped += header->levels[i].size;
+                    continue;
+                }
+                job.levelData.push_back(job.file.data() + header->levels[i].offset);
+                touchPages(job.levelData.back(), header->levels[i].size);
+                job.levelWidth.push_back(header->levels[i].width);
+                job.levelHeight.push_back(header->levels[i].height);
+            }
+            job.ok = true;
+            return;
+        }
+        job.file.close();
+    }
+
+    int nrChannels;
+    unsigned char *data = stbi_load(job.path.c_str(), &job.width, &job.height, &nrChannels, 4);
+    if (!data)
+        return;
+
+    // Os mipmaps também saem da thread da GL; sem eles, só a cópia do nível 0
+    int base = textureBaseLevel(job.width, job.height, job.screenWidth, job.screenHeight);
+    int count = textureLevelCount(job.width, job.height, base, job.filter);
+    if (base == 0 && count == 1)
+        job.levels.emplace_back(data, data + size_t(job.width) * job.height * 4);
+    else
+        job.levels = buildMipChain(data, job.width, job.height);
+    stbi_image_free(data);
+
+    for (int i = 0; i < int(job.levels.size()); i++)
+    {
+        int width = max(1, job.width >> i), height = max(1, job.height >> i);
+        if (i < base || i >= base + count)
+        {
+            job.bytesSkipped += size_t(width) * height * 4;
+            continue;
+        }
+        job.levelData.push_back(job.levels[i].data());
+        job.levelWidth.push_back(width);
+        job.levelHeight.push_back(height);
+    }
+    job.ok = true;
+}
+
+void AssetLoader::beginUpload(Job &job)
+{
+    // Aloca todos os níveis de uma vez; o conteúdo chega aos poucos nos frames seguintes
+    GLState::bindTexture(GL_TEXTURE_2D, _entries[job.handle].texID);
+    for (size_t i = 0; i < job.levelData.size(); i++)
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, job.levelWidth[i], job.levelHeight[i], 0, job.format, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, job.levelData.size() - 1);
+}
+
+size_t AssetLoader::uploadRows(Job &job, size_t budget)
+{
+    size_t uploaded = 0;
+    GLState::bindTexture(GL_TEXTURE_2D, _entries[job.handle].texID);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pbo);
+
+    while (job.level < int(job.levelData.size()) && uploaded < budget)
+    {
+        int width = job.levelWidth[job.level];
+        int height = job.levelHeight[job.level];
+        size_t rowBytes = size_t(width) * 4;
+
+        // Pelo menos uma linha por vez, mesmo que passe do orçamento
+        int rows = int(max<size_t>(1, (budget - uploaded) / rowBytes));
+        rows = min(rows, height - job.row);
+        size_t bytes = rows * rowBytes;
+
+        // Orphaning + map: o driver não precisa esperar o envio anterior terminar
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (!dst)
+            break;
+        memcpy(dst, job.levelData[job.level] + job.row * rowBytes, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glTexSubImage2D(GL_TEXTURE_2D, job.level, 0, job.row, width, rows, job.format, GL_UNSIGNED_BYTE, (GLvoid *)0);
+
+        uploaded += bytes;
+        job.row += rows;
+        if (job.row >= height)
+        {
+            job.level++;
+            job.row = 0;
+        }
+    }
+
+    // A textura fica ligada: quem desenha liga a sua pelo GLState, que só emite se for outra
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return uploaded;
+}
+
+void AssetLoader::update()
+{
+    double now_s = glfwGetTime();
+    if (_firstFrame)
+    {
+        _stats.timeToFirstFrameMs = (now_s - _start_s) * 1000.0;
+        _firstFrame = false;
+    }
+    else if (busy())
+    {
+        _stats.worstFrameMs = max(_stats.worstFrameMs, (now_s - _lastUpdate_s) * 1000.0);
+    }
+    _lastUpdate_s = now_s;
+
+    {
+        lock_guard<mutex> lock(_mutex);
+        while (!_decoded.empty())
+        {
+            _uploads.push_back(move(_decoded.front()));
+            _decoded.pop_front();
+        }
+    }
+
+    size_t uploaded = 0;
+    while (!_uploads.empty() && uploaded < _budget)
+    {
+        Job &job = *_uploads.front();
+        bool done = !job.ok;
+
+        if (job.ok)
+        {
+            if (job.level == 0 && job.row == 0)
+                beginUpload(job);
+            uploaded += uploadRows(job, _budget - uploaded);
+            done = job.level >= int(job.levelData.size());
+        }
+
+        if (!done)
+            break;
+
+        if (job.ok)
+        {
+            _entries[job.handle].resident = true;
+            _stats.resident++;
+            _stats.bytesSkipped += job.bytesSkipped;
+        }
+        else
+        {
+            cout << "Failed to load texture: " << job.path << endl;
+            _stats.failed++;
+        }
+        _uploads.pop_front();
+
+        lock_guard<mutex> lock(_mutex);
+        _inFlight--;
+        if (_inFlight == 0)
+            _stats.timeToResidentMs = (glfwGetTime() - _start_s) * 1000.0;
+    }
+
+    _stats.bytesLastFrame = uploaded;
+    _stats.bytesUploaded += uploaded;
+}
+
+void AssetLoader::clear()
+{
+    for (Entry &entry : _entries)
+        GLState::deleteTexture(entry.texID);
+    _entries.clear();
+    GLState::deleteTexture(_placeholder);
+    glDeleteBuffers(1, &_pbo);
+}
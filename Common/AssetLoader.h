@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+
+/*
+ * AssetLoader
+ *
+ * Carrega texturas em segundo plano. As imagens são decodificadas (ou os
+ * .ptex mapeados) por um pool de threads; a thread da GL chama update() uma
+ * vez por frame e envia os pixels prontos por um pixel unpack buffer,
+ * respeitando um limite de bytes por frame para não travar o frame.
+ *
+ * texture(handle) devolve uma textura substituta (1x1 cinza) até que todos os
+ * níveis da textura real tenham sido enviados.
+ *
+ * Métricas: tempo até o primeiro frame, tempo até todas as texturas ficarem
+ * residentes e o pior intervalo entre frames enquanto havia streaming.
+ */
+class AssetLoader
+{
+public:
+    struct Stats
+    {
+        int requested = 0;
+        int resident = 0;
+        int failed = 0;
+        size_t bytesUploaded = 0;
+        // Níveis maiores que o tamanho na tela, que nem chegaram à GL
+        size_t bytesSkipped = 0;
+        size_t bytesLastFrame = 0;
+        double timeToFirstFrameMs = 0.0;
+        double timeToResidentMs = 0.0;
+        double worstFrameMs = 0.0;
+    };
+
+    AssetLoader(size_t bytesPerFrame = 8 * 1024 * 1024, int workers = 0);
+    ~AssetLoader();
+
+    // screenWidth x screenHeight: tamanho em pixels com que a textura aparece, como no loadTexture()
+    int request(const std::string &filePath, GLint filter = GL_NEAREST, GLint wrap = GL_REPEAT, int screenWidth = 0,
+                int screenHeight = 0);
+
+    GLuint texture(int handle) const;
+    bool resident(int handle) const;
+    bool busy() const;
+
+    void setBudget(size_t bytesPerFrame) { _budget = bytesPerFrame; }
+
+    // Chamado pela thread da GL uma vez por frame
+    void update();
+
+    const Stats &stats() const { return _stats; }
+
+    void clear();
+
+private:
+    struct Job;
+
+    struct Entry
+    {
+        GLuint texID;
+        bool resident;
+    };
+
+    static void decode(Job &job);
+
+    void workerLoop();
+    void beginUpload(Job &job);
+    size_t uploadRows(Job &job, size_t budget);
+
+    std::vector<Entry> _entries;
+    GLuint _placeholder;
+    GLuint _pbo;
+    size_t _budget;
+
+    std::vector<std::thread> _workers;
+    mutable std::mutex _mutex;
+    std::condition_variable _wake;
+    std::deque<std::unique_ptr<Job>> _pending;
+    std::deque<std::unique_ptr<Job>> _decoded;
+    bool _quit;
+    int _inFlight;
+
+    std::deque<std::unique_ptr<Job>> _uploads;
+
+    double _start_s;
+    double _lastUpdate_s;
+    bool _firstFrame;
+    Stats _stats;
+};
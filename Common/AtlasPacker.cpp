@@ -0,0 +1,357 @@
+#include "AtlasPacker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stb_image.h>
+
+#include "TextureFile.h"
+
+using namespace std;
+
+SkylinePacker::SkylinePacker(int width, int height)
+    : _width(width), _height(height), _usedHeight(0)
+{
+    _skyline.push_back({0, 0, width});
+}
+
+// Altura em que um retângulo começando no nó index ficaria apoiado
+bool SkylinePacker::fits(size_t index, int width, int height, int &y) const
+{
+    if (_skyline[index].x + width > _width)
+        return false;
+
+    y = 0;
+    int remaining = width;
+    while (remaining > 0)
+    {
+        y = max(y, _skyline[index].y);
+        if (y + height > _height)
+            return false;
+        remaining -= _skyline[index].width;
+        index++;
+    }
+    return true;
+}
+
+bool SkylinePacker::insert(int width, int height, AtlasRect &rect)
+{
+    size_t best = _skyline.size();
+    int bestBottom = INT_MAX, bestY = 0, bestNodeWidth = INT_MAX;
+    for (size_t i = 0; i < _skyline.size(); i++)
+    {
+        int y;
+        if (!fits(i, width, height, y))
+            continue;
+
+        // Mais baixo primeiro; no empate, o nó mais estreito (desperdiça menos)
+        int bottom = y + height;
+        if (bottom < bestBottom || (bottom == bestBottom && _skyline[i].width < bestNodeWidth))
+        {
+            best = i;
+            bestBottom = bottom;
+            bestY = y;
+            bestNodeWidth = _skyline[i].width;
+        }
+    }
+    if (best == _skyline.size())
+        return false;
+
+    rect = {_skyline[best].x, bestY, width, height};
+    _skyline.insert(_skyline.begin() + best, {rect.x, bestY + height, width});
+
+    // Corta os nós que ficaram por baixo do novo
+    for (size_t i = best + 1; i < _skyline.size();)
+    {
+        const Node &prev = _skyline[i - 1];
+        Node &node = _skyline[i];
+        int overlap = prev.x + prev.width - node.x;
+        if (overlap <= 0)
+            break;
+
+        node.x += overlap;
+        node.width -= overlap;
+        if (node.width > 0)
+            break;
+        _skyline.erase(_skyline.begin() + i);
+    }
+
+    // Junta vizinhos de mesma altura
+    for (size_t i = 0; i + 1 < _skyline.size();)
+    {
+        if (_skyline[i].y == _skyline[i + 1].y)
+        {
+            _skyline[i].width += _skyline[i + 1].width;
+            _skyline.erase(_skyline.begin() + i + 1);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    _usedHeight = max(_usedHeight, bestY + height);
+    return true;
+}
+
+bool packAtlas(const vector<AtlasSheet> &sheets, const vector<AtlasImage> &images,
+               AtlasLayout &layout, vector<uint8_t> &pixels)
+{
+    struct Item
+    {
+        int sheet, frame;
+        int width, height;
+    };
+
+    layout.sheets.clear();
+    vector<Item> items;
+    int widest = 1;
+    for (size_t s = 0; s < sheets.size(); s++)
+    {
+        const AtlasSheet &sheet = sheets[s];
+        int columns = images[s].width / sheet.frameWidth;
+        int rows = images[s].height / sheet.frameHeight;
+        if (columns == 0 || rows == 0)
+        {
+            cerr << "Folha " << sheet.name << " menor que um quadro" << endl;
+            return false;
+        }
+
+        layout.sheets.push_back({sheet.name, vector<AtlasRect>(columns * rows)});
+        for (int f = 0; f < columns * rows; f++)
+            items.push_back({int(s), f, sheet.frameWidth + 2 * ATLAS_PADDING, sheet.frameHeight + 2 * ATLAS_PADDING});
+        widest = max(widest, sheet.frameWidth + 2 * ATLAS_PADDING);
+    }
+
+    // Mais altos primeiro; stable_sort mantém a ordem das folhas no empate, então o resultado não muda entre execuções
+    stable_sort(items.begin(), items.end(), [](const Item &a, const Item &b)
+                { return a.height != b.height ? a.height > b.height : a.width > b.width; });
+
+    // Testa as larguras potência de 2 e fica com a de menor área
+    vector<AtlasRect> best;
+    long long bestArea = LLONG_MAX;
+    int minWidth = 1;
+    while (minWidth < widest)
+        minWidth *= 2;
+    for (int width = minWidth; width <= ATLAS_MAX_SIZE; width *= 2)
+    {
+        SkylinePacker packer(width, ATLAS_MAX_SIZE);
+        vector<AtlasRect> placed(items.size());
+        bool ok = true;
+        for (size_t i = 0; i < items.size() && ok; i++)
+            ok = packer.insert(items[i].width, items[i].height, placed[i]);
+        if (!ok)
+            continue;
+
+        int height = (packer.usedHeight() + 3) & ~3;
+        if ((long long)width * height < bestArea)
+        {
+            bestArea = (long long)width * height;
+            best = placed;
+            layout.width = width;
+            layout.height = height;
+        }
+    }
+    if (best.empty())
+    {
+        cerr << "As folhas não cabem em um atlas de " << ATLAS_MAX_SIZE << "x" << ATLAS_MAX_SIZE << endl;
+        return false;
+    }
+
+    pixels.assign(size_t(layout.width) * layout.height * 4, 0);
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const AtlasSheet &sheet = sheets[items[i].sheet];
+        const AtlasImage &image = images[items[i].sheet];
+        int columns = image.width / sheet.frameWidth;
+        int srcX = (items[i].frame % columns) * sheet.frameWidth;
+        int srcY = (items[i].frame / columns) * sheet.frameHeight;
+
+        AtlasRect &frame = layout.sheets[items[i].sheet].frames[items[i].frame];
+        frame = {best[i].x + ATLAS_PADDING, best[i].y + ATLAS_PADDING, sheet.frameWidth, sheet.frameHeight};
+
+        // Copia o quadro repetindo a borda na área de padding
+        for (int dy = -ATLAS_PADDING; dy < sheet.frameHeight + ATLAS_PADDING; dy++)
+        {
+            int sy = srcY + min(max(dy, 0), sheet.frameHeight - 1);
+            for (int dx = -ATLAS_PADDING; dx < sheet.frameWidth + ATLAS_PADDING; dx++)
+            {
+                int sx = srcX + min(max(dx, 0), sheet.frameWidth - 1);
+                const uint8_t *src = image.rgba + (size_t(sy) * image.width + sx) * 4;
+                uint8_t *dst = pixels.data() + (size_t(frame.y + dy) * layout.width + frame.x + dx) * 4;
+                copy(src, src + 4, dst);
+            }
+        }
+    }
+    return true;
+}
+
+static uint64_t fnv1a(uint64_t hash, const char *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ uint8_t(data[i])) * 1099511628211ull;
+    return (hash ^ 0xff) * 1099511628211ull;
+}
+
+uint64_t atlasKey(const vector<AtlasSheet> &sheets)
+{
+    uint64_t hash = 14695981039346656037ull;
+    int params[] = {int(ATLAS_MANIFEST_VERSION), ATLAS_PADDING, ATLAS_MAX_SIZE};
+    hash = fnv1a(hash, (const char *)params, sizeof(params));
+
+    for (const AtlasSheet &sheet : sheets)
+    {
+        ifstream file(sheet.path, ios::binary);
+        if (!file)
+            return 0;
+        string bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+        int frame[] = {sheet.frameWidth, sheet.frameHeight};
+        hash = fnv1a(hash, sheet.name.data(), sheet.name.size());
+        hash = fnv1a(hash, (const char *)frame, sizeof(frame));
+        hash = fnv1a(hash, bytes.data(), bytes.size());
+    }
+    return hash;
+}
+
+bool readAtlasManifest(const string &path, AtlasLayout &layout)
+{
+    ifstream file(path);
+    if (!file)
+        return false;
+
+    AtlasLayout result;
+    uint32_t version = 0;
+    string token;
+    while (file >> token)
+    {
+        if (token[0] == '#')
+        {
+            getline(file, token);
+            continue;
+        }
+
+        if (token == "version")
+            file >> version;
+        else if (token == "key")
+            file >> hex >> result.key >> dec;
+        else if (token == "size")
+            file >> result.width >> result.height;
+        else if (token == "sheet")
+        {
+            AtlasSheetFrames sheet;
+            size_t count = 0;
+            file >> sheet.name >> count;
+            for (size_t i = 0; i < count && file; i++)
+            {
+                AtlasRect rect;
+                file >> token >> rect.x >> rect.y >> rect.width >> rect.height;
+                if (token != "frame")
+                    return false;
+                sheet.frames.push_back(rect);
+            }
+            result.sheets.push_back(sheet);
+        }
+        else
+            return false;
+
+        if (!file)
+            return false;
+    }
+
+    if (version != ATLAS_MANIFEST_VERSION || result.width <= 0 || result.height <= 0)
+        return false;
+    layout = result;
+    return true;
+}
+
+bool writeAtlasManifest(const string &path, const AtlasLayout &layout)
+{
+    ofstream file(path, ios::trunc);
+    if (!file)
+        return false;
+
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)layout.key);
+
+    file << "# Atlas gerado por cookAtlas() (common/AtlasPacker.h), não editar" << endl;
+    file << "version " << ATLAS_MANIFEST_VERSION << endl;
+    file << "key " << key << endl;
+    file << "size " << layout.width << " " << layout.height << endl;
+    for (const AtlasSheetFrames &sheet : layout.sheets)
+    {
+        file << "sheet " << sheet.name << " " << sheet.frames.size() << endl;
+        for (const AtlasRect &rect : sheet.frames)
+            file << "frame " << rect.x << " " << rect.y << " " << rect.width << " " << rect.height << endl;
+    }
+    return bool(file);
+}
+
+bool cookAtlas(const string &manifestPath, const vector<AtlasSheet> &sheets, AtlasLayout &layout)
+{
+    auto start = chrono::steady_clock::now();
+    string texturePath = textureFilePath(manifestPath);
+
+    uint64_t key = atlasKey(sheets);
+    if (key == 0)
+    {
+        cerr << "Falha ao ler as folhas do atlas " << manifestPath << endl;
+        return false;
+    }
+
+    {
+        MappedFile file;
+        const TextureFileHeader *header = nullptr;
+        if (readAtlasManifest(manifestPath, layout) && layout.key == key && file.open(texturePath))
+            header = textureFileHeader(file);
+        if (header && int(header->width) == layout.width && int(header->height) == layout.height)
+        {
+            printf("Atlas %s: cache em %.2f ms\n", manifestPath.c_str(),
+                   chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+            return true;
+        }
+    }
+
+    vector<unsigned char *> decoded;
+    vector<AtlasImage> images;
+    bool ok = true;
+    for (const AtlasSheet &sheet : sheets)
+    {
+        int width, height, nrChannels;
+        unsigned char *data = stbi_load(sheet.path.c_str(), &width, &height, &nrChannels, 4);
+        if (!data)
+        {
+            cerr << "Falha ao carregar " << sheet.path << endl;
+            ok = false;
+            break;
+        }
+        decoded.push_back(data);
+        images.push_back({data, width, height});
+    }
+
+    vector<uint8_t> pixels;
+    ok = ok && packAtlas(sheets, images, layout, pixels);
+    for (unsigned char *data : decoded)
+        stbi_image_free(data);
+    if (!ok)
+        return false;
+    layout.key = key;
+
+    // Só um nível: os mipmaps misturariam quadros vizinhos. O manifesto é gravado por último,
+    // então um atlas gravado pela metade nunca é aceito como cache
+    vector<vector<uint8_t>> levels(1);
+    levels[0].swap(pixels);
+    if (!writeTextureFile(texturePath, levels, layout.width, layout.height, LAYOUT_RGBA, 0) ||
+        !writeAtlasManifest(manifestPath, layout))
+    {
+        cerr << "Falha ao gravar o atlas " << manifestPath << endl;
+        return false;
+    }
+
+    printf("Atlas %s: empacotado (%dx%d, %zu folhas) em %.2f ms\n", manifestPath.c_str(), layout.width,
+           layout.height, sheets.size(), chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    return true;
+}
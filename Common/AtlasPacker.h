@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Atlas de sprite sheets.
+ *
+ * Os quadros de várias folhas (pinkMonsterIdle, Walk, Climb...) são
+ * empacotados em uma única imagem com um empacotador skyline. Cada quadro
+ * ganha ATLAS_PADDING pixels de borda repetida, para o filtro não puxar cor
+ * do quadro vizinho.
+ *
+ * O resultado fica em cache em dois arquivos lado a lado:
+ *   pinkMonster.atlas  manifesto em texto com o retângulo de cada quadro
+ *   pinkMonster.ptex   pixels do atlas (formato de TextureFile.h)
+ *
+ * O manifesto guarda uma chave calculada a partir do conteúdo das folhas de
+ * origem; enquanto ela bater, cookAtlas() só lê o manifesto. O empacotamento
+ * é determinístico: as mesmas folhas geram sempre os mesmos bytes.
+ */
+
+const uint32_t ATLAS_MANIFEST_VERSION = 1;
+const int ATLAS_PADDING = 1;
+const int ATLAS_MAX_SIZE = 4096;
+
+struct AtlasRect
+{
+    int x, y, width, height;
+};
+
+// Skyline bottom-left: cada retângulo vai para a posição mais baixa (e depois mais à esquerda) em que cabe
+class SkylinePacker
+{
+public:
+    SkylinePacker(int width, int height);
+
+    bool insert(int width, int height, AtlasRect &rect);
+    int usedHeight() const { return _usedHeight; }
+
+private:
+    struct Node
+    {
+        int x, y, width;
+    };
+
+    bool fits(size_t index, int width, int height, int &y) const;
+
+    std::vector<Node> _skyline;
+    int _width, _height;
+    int _usedHeight;
+};
+
+// Folha de origem: imagem com quadros de frameWidth x frameHeight, lidos linha a linha
+struct AtlasSheet
+{
+    std::string name;
+    std::string path;
+    int frameWidth, frameHeight;
+};
+
+struct AtlasSheetFrames
+{
+    std::string name;
+    std::vector<AtlasRect> frames; // em pixels do atlas, sem a borda
+};
+
+struct AtlasLayout
+{
+    int width = 0, height = 0;
+    uint64_t key = 0;
+    std::vector<AtlasSheetFrames> sheets;
+};
+
+struct AtlasImage
+{
+    const uint8_t *rgba;
+    int width, height;
+};
+
+// Empacota os quadros das folhas já decodificadas (RGBA8) e monta os pixels do atlas
+bool packAtlas(const std::vector<AtlasSheet> &sheets, const std::vector<AtlasImage> &images,
+               AtlasLayout &layout, std::vector<uint8_t> &pixels);
+
+// Chave do cache: versão, borda, parâmetros e bytes dos arquivos de cada folha (0 se algum não puder ser lido)
+uint64_t atlasKey(const std::vector<AtlasSheet> &sheets);
+
+bool readAtlasManifest(const std::string &path, AtlasLayout &layout);
+bool writeAtlasManifest(const std::string &path, const AtlasLayout &layout);
+
+// Usa o cache se a chave bater; senão decodifica as folhas, empacota e grava manifesto + .ptex
+bool cookAtlas(const std::string &manifestPath, const std::vector<AtlasSheet> &sheets, AtlasLayout &layout);
@@ -0,0 +1,81 @@
+#include "ColorGame.h"
+#include "ColorLab.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void ColorGame::start(int cols, int rows, uint64_t seed, ThreadPool *pool, ColorMetric metric)
+{
+    _grid.reset(cols, rows);
+    _grid.randomize(seed, pool);
+    _grid.setMetric(metric, pool);
+
+    // O índice de cores só serve à regra da grade toda; as regiões, só à regra por região
+    _index.clear();
+    _regions.clear();
+    if (_connectivity == COLOR_CONNECT_NONE)
+        _index.build(_grid.matchPlane(0), _grid.matchPlane(1), _grid.matchPlane(2), _grid.size());
+    else if (_labelTolerance >= 0.0f)
+        _regions.build(_grid, _connectivity, colorMetricLimit(_labelTolerance, metric), pool);
+
+    _lastEliminated.clear();
+    _points = 0;
+    _turn = 1;
+}
+
+void ColorGame::setRegionRule(ColorConnectivity connectivity, float labelTolerance)
+{
+    _connectivity = connectivity;
+    _labelTolerance = labelTolerance;
+}
+
+int ColorGame::click(size_t cell, float tolerance)
+{
+    _lastEliminated.clear();
+    if (_connectivity != COLOR_CONNECT_NONE)
+    {
+        if (_regions.built() && tolerance == _labelTolerance)
+        {
+            // A região já rotulada: uma consulta e uma faixa contígua de células
+            uint32_t label = _regions.labelOf(cell);
+            for (const uint32_t *idx = _regions.begin(label); idx != _regions.end(label); idx++)
+            {
+                if (_grid.eliminate(*idx))
+                    _lastEliminated.push_back(*idx);
+            }
+        }
+        else
+        {
+            _regions.flood(_grid, cell, _connectivity, colorMetricLimit(tolerance, _grid.metric()), _lastEliminated);
+            for (uint32_t idx : _lastEliminated)
+                _grid.eliminate(idx);
+        }
+
+        int eliminatedCount = max(0, int(_lastEliminated.size()) - 1);
+        _points += (eliminatedCount * 10) / _turn;
+        _turn++;
+        return eliminatedCount;
+    }
+
+    uint8_t C[3];
+    _grid.matchColor(cell, C);
+    if (_grid.eliminate(cell))
+    {
+        _lastEliminated.push_back(uint32_t(cell));
+        _index.remove(uint32_t(cell), C);
+    }
+
+    _similar.clear();
+    _index.removeSimilar(C, colorMetricLimit(tolerance, _grid.metric()), _similar);
+    for (uint32_t idx : _similar)
+    {
+        _grid.eliminate(idx);
+        _lastEliminated.push_back(idx);
+    }
+
+    int eliminatedCount = int(_similar.size());
+    _points += (eliminatedCount * 10) / _turn;
+    _turn++;
+    return eliminatedCount;
+}
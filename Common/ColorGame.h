@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ColorGrid.h"
+#include "ColorIndex.h"
+#include "ColorRegions.h"
+
+class ThreadPool;
+
+/*
+ * Regras do Jogo das Cores, sem GL nem GLFW.
+ *
+ * Guarda a grade, o índice de cores, a pontuação e o turno. O JogoCores
+ * traduz cliques do mouse em click() e desenha a grade; o SimCores joga
+ * milhares de partidas sem janela com as mesmas regras:
+ *
+ *   - o clique elimina a célula clicada e todas as vivas com cor a até a
+ *     tolerância dela (mesmo se a clicada já estava eliminada), em RGB ou
+ *     em L*a*b* (colorMetricLimit())
+ *   - com a regra por região (setRegionRule()), o clique elimina só a região
+ *     conectada de cores parecidas da célula clicada (ColorRegions.h), e nada
+ *     se ela já estava eliminada
+ *   - pontos do turno = (eliminadas além da clicada * 10) / turno
+ *   - o jogo acaba quando não sobra célula viva
+ */
+class ColorGame
+{
+public:
+    // Nova grade com cores sorteadas por seed (ColorGrid::randomize), comparadas pela métrica
+    void start(int cols, int rows, uint64_t seed, ThreadPool *pool = nullptr, ColorMetric metric = COLOR_METRIC_RGB);
+
+    // Regra dos próximos start(): COLOR_CONNECT_NONE elimina as parecidas da grade toda; 4 ou 8 só a
+    // região conectada. Com labelTolerance >= 0 as regiões são rotuladas no start() para essa tolerância
+    // e os cliques com ela viram consultas; cliques com outra tolerância percorrem a grade
+    void setRegionRule(ColorConnectivity connectivity, float labelTolerance = -1.0f);
+    ColorConnectivity connectivity() const { return _connectivity; }
+
+    // Joga um turno e devolve quantas células foram eliminadas além da clicada
+    int click(size_t cell, float tolerance);
+
+    // Células que o último click() tirou do jogo, incluindo a clicada se ainda estava viva
+    const std::vector<uint32_t> &lastEliminated() const { return _lastEliminated; }
+
+    const ColorGrid &grid() const { return _grid; }
+    // Regiões rotuladas no start() (vazio sem labelTolerance)
+    const ColorRegions &regions() const { return _regions; }
+    int points() const { return _points; }
+    int turn() const { return _turn; }
+    bool over() const { return _grid.alive() == 0; }
+
+private:
+    ColorGrid _grid;
+    ColorIndex _index;
+    ColorRegions _regions;
+    ColorConnectivity _connectivity = COLOR_CONNECT_NONE;
+    float _labelTolerance = -1.0f;
+    std::vector<uint32_t> _similar;
+    std::vector<uint32_t> _lastEliminated;
+    int _points = 0;
+    int _turn = 1;
+};
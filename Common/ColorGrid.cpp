@@ -0,0 +1,123 @@
+#include "ColorGrid.h"
+#include "CounterRng.h"
+#include "CpuFeatures.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+void ColorGrid::reset(int cols, int rows)
+{
+    _cols = cols;
+    _rows = rows;
+    size_t count = size_t(cols) * rows;
+    _r.assign(count, 0);
+    _g.assign(count, 0);
+    _b.assign(count, 0);
+    for (vector<uint8_t> &plane : _lab)
+        plane.clear();
+    _metric = COLOR_METRIC_RGB;
+    _match[0] = _r.data();
+    _match[1] = _g.data();
+    _match[2] = _b.data();
+    _eliminated.assign((count + 63) / 64, 0);
+    _rowAlive.assign(rows, cols);
+    _alive = count;
+}
+
+void ColorGrid::randomize(uint64_t seed, ThreadPool *pool)
+{
+    RngKey key = rngKey(seed);
+    auto fill = [&](size_t begin, size_t end, int worker)
+    {
+        fillRandomColors(key, uint32_t(begin), end - begin, &_r[begin], &_g[begin], &_b[begin]);
+    };
+    if (pool)
+        pool->parallelFor(size(), 1 << 16, fill);
+    else
+        fill(0, size(), 0);
+}
+
+void ColorGrid::setMetric(ColorMetric metric, ThreadPool *pool)
+{
+    _metric = metric;
+    if (metric == COLOR_METRIC_RGB)
+    {
+        for (vector<uint8_t> &plane : _lab)
+            plane.clear();
+        _match[0] = _r.data();
+        _match[1] = _g.data();
+        _match[2] = _b.data();
+        return;
+    }
+
+    for (int k = 0; k < 3; k++)
+    {
+        _lab[k].resize(size());
+        _match[k] = _lab[k].data();
+    }
+    auto convert = [&](size_t begin, size_t end, int worker)
+    {
+        convertToLab(&_r[begin], &_g[begin], &_b[begin], end - begin, &_lab[0][begin], &_lab[1][begin], &_lab[2][begin]);
+    };
+    if (pool)
+        pool->parallelFor(size(), 1 << 16, convert);
+    else
+        convert(0, size(), 0);
+}
+
+bool ColorGrid::eliminate(size_t cell)
+{
+    uint64_t bit = uint64_t(1) << (cell % 64);
+    if (_eliminated[cell / 64] & bit)
+        return false;
+
+    _eliminated[cell / 64] |= bit;
+    _rowAlive[rowOf(cell)]--;
+    _alive--;
+    return true;
+}
+
+size_t ColorGrid::nextAlive(size_t cell) const
+{
+    if (_alive == 0)
+        return size();
+
+    // Pula 64 eliminadas por vez; os bits além de size() na última palavra nunca são marcados
+    size_t words = _eliminated.size();
+    size_t w = cell / 64;
+    uint64_t live = ~_eliminated[w] & (~uint64_t(0) << (cell % 64));
+    for (size_t n = 0; n <= words; n++)
+    {
+        if (live)
+        {
+            size_t found = w * 64 + countTrailingZeros64(live);
+            if (found < size())
+                return found;
+        }
+        w = (w + 1) % words;
+        live = ~_eliminated[w];
+    }
+    return size();
+}
+
+bool ColorGrid::nextRowRun(int row, int &first, int &last) const
+{
+    while (row < _rows && _rowAlive[row] == 0)
+        row++;
+    if (row >= _rows)
+        return false;
+
+    first = row;
+    while (row < _rows && _rowAlive[row] > 0)
+        row++;
+    last = row;
+    return true;
+}
+
+double ColorGrid::bytesPerCell() const
+{
+    if (_r.empty())
+        return 0.0;
+    size_t bytes = _r.size() * 3 + _lab[0].size() * 3 + _eliminated.size() * sizeof(uint64_t) + _rowAlive.size() * sizeof(int);
+    return double(bytes) / _r.size();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ColorLab.h"
+
+class ThreadPool;
+
+/*
+ * Grade do Jogo das Cores, sem nada de GL.
+ *
+ * A posição e o tamanho de cada célula saem de (coluna, linha), então a
+ * grade guarda só o que muda por célula:
+ *   - a cor em três planos de um byte (r, g, b), no formato de ColorMatch.h
+ *   - um bit de "eliminada"
+ * São pouco mais de 3 bytes por célula, contra os 40 do antigo struct Quad.
+ *
+ * As contagens de células vivas (total e por linha) são mantidas a cada
+ * eliminação: "acabou o jogo?" é O(1) e linhas vazias podem ser puladas no
+ * desenho e nas varreduras.
+ *
+ * Com a métrica Lab (ColorLab.h) a grade guarda também as cores convertidas
+ * para L*a*b*, em mais três planos. As comparações usam matchPlane() e
+ * matchColor(), que devolvem os planos da métrica atual; red()/green()/blue()
+ * continuam sendo as cores que aparecem na tela.
+ */
+
+class ColorGrid
+{
+public:
+    // Todas as células vivas e pretas, métrica RGB; as cores vêm depois com setColor()
+    void reset(int cols, int rows);
+
+    int cols() const { return _cols; }
+    int rows() const { return _rows; }
+    size_t size() const { return _r.size(); }
+
+    size_t index(int col, int row) const { return size_t(row) * _cols + col; }
+    int colOf(size_t cell) const { return int(cell % _cols); }
+    int rowOf(size_t cell) const { return int(cell / _cols); }
+
+    void setColor(size_t cell, uint8_t r, uint8_t g, uint8_t b)
+    {
+        _r[cell] = r;
+        _g[cell] = g;
+        _b[cell] = b;
+    }
+    void color(size_t cell, uint8_t rgb[3]) const
+    {
+        rgb[0] = _r[cell];
+        rgb[1] = _g[cell];
+        rgb[2] = _b[cell];
+    }
+
+    // Sorteia todas as cores com o gerador por contador (CounterRng.h): a cor da célula i depende só
+    // de (seed, i), então o resultado é o mesmo com ou sem pool e com qualquer número de threads
+    void randomize(uint64_t seed, ThreadPool *pool = nullptr);
+
+    // Planos de cor, para matchColors() e ColorIndex::build()
+    const uint8_t *red() const { return _r.data(); }
+    const uint8_t *green() const { return _g.data(); }
+    const uint8_t *blue() const { return _b.data(); }
+
+    // Métrica das comparações. Lab converte as cores atuais (chamar depois de randomize()/setColor())
+    void setMetric(ColorMetric metric, ThreadPool *pool = nullptr);
+    ColorMetric metric() const { return _metric; }
+
+    // Planos comparados pela métrica atual: r/g/b em RGB, L/a/b em Lab
+    const uint8_t *matchPlane(int channel) const { return _match[channel]; }
+    void matchColor(size_t cell, uint8_t color[3]) const
+    {
+        color[0] = _match[0][cell];
+        color[1] = _match[1][cell];
+        color[2] = _match[2][cell];
+    }
+
+    bool eliminated(size_t cell) const { return (_eliminated[cell / 64] >> (cell % 64)) & 1; }
+    // false se a célula já estava eliminada
+    bool eliminate(size_t cell);
+
+    size_t alive() const { return _alive; }
+    // Primeira célula viva a partir de cell, dando a volta na grade; size() se não houver
+    size_t nextAlive(size_t cell) const;
+    int aliveInRow(int row) const { return _rowAlive[row]; }
+
+    // Próxima faixa [first, last) de linhas com alguma célula viva a partir de row; false se não houver
+    bool nextRowRun(int row, int &first, int &last) const;
+
+    // Bytes por célula guardados pela grade (planos, bits e contadores por linha)
+    double bytesPerCell() const;
+
+private:
+    int _cols = 0, _rows = 0;
+    std::vector<uint8_t> _r, _g, _b;
+    std::vector<uint8_t> _lab[3];
+    const uint8_t *_match[3] = {nullptr, nullptr, nullptr};
+    ColorMetric _metric = COLOR_METRIC_RGB;
+    std::vector<uint64_t> _eliminated;
+    std::vector<int> _rowAlive;
+    size_t _alive = 0;
+};
@@ -0,0 +1,191 @@
+#include "ColorIndex.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void ColorIndex::build(const uint8_t *r, const uint8_t *g, const uint8_t *b, size_t count)
+{
+    vector<uint16_t> bucket(count);
+    _start.assign(COLOR_INDEX_BUCKETS + 1, 0);
+    _bucketSize.assign(COLOR_INDEX_BUCKETS, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        bucket[i] = uint16_t(bucketOf(r[i], g[i], b[i]));
+        _bucketSize[bucket[i]]++;
+    }
+
+    size_t largest = 0;
+    for (int k = 0; k < COLOR_INDEX_BUCKETS; k++)
+    {
+        _start[k + 1] = _start[k] + _bucketSize[k];
+        largest = max(largest, size_t(_bucketSize[k]));
+    }
+
+    _r.resize(count);
+    _g.resize(count);
+    _b.resize(count);
+    _cell.resize(count);
+    _mask.resize(colorMaskWords(largest));
+
+    // Ordenação por contagem: as células de cada balde ficam em ordem crescente
+    vector<uint32_t> next(_start.begin(), _start.end() - 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t slot = next[bucket[i]]++;
+        _r[slot] = r[i];
+        _g[slot] = g[i];
+        _b[slot] = b[i];
+        _cell[slot] = uint32_t(i);
+    }
+    _size = count;
+}
+
+void ColorIndex::clear()
+{
+    _start.clear();
+    _bucketSize.clear();
+    _r.clear();
+    _g.clear();
+    _b.clear();
+    _cell.clear();
+    _mask.clear();
+    _size = 0;
+}
+
+bool ColorIndex::remove(uint32_t cell, const uint8_t color[3])
+{
+    if (_start.empty())
+        return false;
+
+    int bucket = bucketOf(color[0], color[1], color[2]);
+    uint32_t begin = _start[bucket], end = begin + _bucketSize[bucket];
+    uint32_t slot = uint32_t(find(_cell.begin() + begin, _cell.begin() + end, cell) - _cell.begin());
+    if (slot == end)
+        return false;
+
+    // A última célula viva do balde ocupa o lugar da removida
+    uint32_t last = end - 1;
+    _r[slot] = _r[last];
+    _g[slot] = _g[last];
+    _b[slot] = _b[last];
+    _cell[slot] = _cell[last];
+    _bucketSize[bucket]--;
+    _size--;
+    return true;
+}
+
+template <typename Visit>
+void ColorIndex::visitBuckets(const uint8_t color[3], int limit, Visit visit)
+{
+    _stats = Stats();
+    if (limit < 0 || _size == 0)
+        return;
+
+    // Menor e maior distância ao quadrado da cor até cada faixa de baldes, por eixo
+    const int shift = 8 - COLOR_INDEX_BITS;
+    const int width = 1 << shift;
+    int radius = int(sqrt(double(limit)));
+    int first[3], last[3];
+    int near2[3][COLOR_INDEX_SIDE], far2[3][COLOR_INDEX_SIDE];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        int c = color[axis];
+        first[axis] = max(c - radius, 0) >> shift;
+        last[axis] = min(c + radius, 255) >> shift;
+        for (int k = first[axis]; k <= last[axis]; k++)
+        {
+            int lo = k * width, hi = lo + width - 1;
+            int nearest = c < lo ? lo - c : (c > hi ? c - hi : 0);
+            int farthest = max(c - lo, hi - c);
+            near2[axis][k] = nearest * nearest;
+            far2[axis][k] = farthest * farthest;
+        }
+    }
+
+    for (int kr = first[0]; kr <= last[0]; kr++)
+    {
+        for (int kg = first[1]; kg <= last[1]; kg++)
+        {
+            int near2rg = near2[0][kr] + near2[1][kg];
+            int far2rg = far2[0][kr] + far2[1][kg];
+            if (near2rg > limit)
+                continue;
+
+            for (int kb = first[2]; kb <= last[2]; kb++)
+            {
+                int bucket = (kr << (2 * COLOR_INDEX_BITS)) | (kg << COLOR_INDEX_BITS) | kb;
+                if (near2rg + near2[2][kb] > limit || _bucketSize[bucket] == 0)
+                    continue;
+
+                bool inside = far2rg + far2[2][kb] <= limit;
+                _stats.buckets++;
+                _stats.inside += inside;
+                _stats.tested += inside ? 0 : _bucketSize[bucket];
+                visit(bucket, inside);
+            }
+        }
+    }
+}
+
+size_t ColorIndex::query(const uint8_t color[3], int limit, vector<uint32_t> &cells, ColorKernel kernel)
+{
+    size_t found = cells.size();
+    auto collect = [&](int bucket, bool inside)
+    {
+        uint32_t start = _start[bucket], size = _bucketSize[bucket];
+        if (inside)
+        {
+            cells.insert(cells.end(), _cell.begin() + start, _cell.begin() + start + size);
+            return;
+        }
+
+        matchColors(&_r[start], &_g[start], &_b[start], size, color, limit, _mask.data(), kernel);
+        for (size_t w = 0; w < colorMaskWords(size); w++)
+        {
+            for (uint64_t bits = _mask[w]; bits; bits &= bits - 1)
+                cells.push_back(_cell[start + w * 64 + countTrailingZeros64(bits)]);
+        }
+    };
+    visitBuckets(color, limit, collect);
+    return cells.size() - found;
+}
+
+size_t ColorIndex::removeSimilar(const uint8_t color[3], int limit, vector<uint32_t> &cells, ColorKernel kernel)
+{
+    size_t found = cells.size();
+    auto extract = [&](int bucket, bool inside)
+    {
+        uint32_t start = _start[bucket], size = _bucketSize[bucket];
+        if (inside)
+        {
+            cells.insert(cells.end(), _cell.begin() + start, _cell.begin() + start + size);
+            _bucketSize[bucket] = 0;
+            return;
+        }
+
+        // Compacta o balde: as que não casaram descem para o começo da faixa
+        matchColors(&_r[start], &_g[start], &_b[start], size, color, limit, _mask.data(), kernel);
+        uint32_t kept = start;
+        for (uint32_t i = 0; i < size; i++)
+        {
+            if ((_mask[i / 64] >> (i % 64)) & 1)
+            {
+                cells.push_back(_cell[start + i]);
+                continue;
+            }
+            _r[kept] = _r[start + i];
+            _g[kept] = _g[start + i];
+            _b[kept] = _b[start + i];
+            _cell[kept] = _cell[start + i];
+            kept++;
+        }
+        _bucketSize[bucket] = kept - start;
+    };
+    visitBuckets(color, limit, extract);
+
+    _size -= cells.size() - found;
+    return cells.size() - found;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ColorMatch.h"
+
+/*
+ * Índice espacial de cores para o Jogo das Cores.
+ *
+ * O cubo RGB é dividido em COLOR_INDEX_SIDE³ baldes uniformes e cada célula
+ * viva fica no balde da sua cor. Os baldes são faixas contíguas de um único
+ * vetor (ordenação por contagem), com as cores em planos separados como em
+ * ColorMatch.h, então cada balde pode ser passado direto para matchColors().
+ *
+ * Uma consulta só visita os baldes que tocam a esfera da tolerância:
+ *   - balde fora da esfera     ignorado sem olhar as células
+ *   - balde dentro da esfera   todas as células casam, sem teste
+ *   - balde na borda           testado com matchColors()
+ *
+ * removeSimilar() faz a consulta e já tira as células do índice: baldes
+ * inteiros dentro da esfera são esvaziados de uma vez e os da borda são
+ * compactados em uma passada. Assim o índice acompanha as eliminações sem
+ * ser reconstruído e sem acessos aleatórios por célula.
+ */
+
+const int COLOR_INDEX_BITS = 4;
+const int COLOR_INDEX_SIDE = 1 << COLOR_INDEX_BITS;
+const int COLOR_INDEX_BUCKETS = COLOR_INDEX_SIDE * COLOR_INDEX_SIDE * COLOR_INDEX_SIDE;
+
+class ColorIndex
+{
+public:
+    struct Stats
+    {
+        size_t buckets = 0; // baldes com células vivas visitados
+        size_t inside = 0;  // desses, os inteiros dentro da esfera
+        size_t tested = 0;  // células comparadas uma a uma
+    };
+
+    // Indexa as células [0, count), todas vivas
+    void build(const uint8_t *r, const uint8_t *g, const uint8_t *b, size_t count);
+    void clear();
+
+    // Tira uma célula, procurando-a no balde da sua cor
+    bool remove(uint32_t cell, const uint8_t color[3]);
+    size_t size() const { return _size; }
+
+    // Acrescenta em cells as células vivas com distância² <= limit (mesma escala de colorToleranceLimit())
+    size_t query(const uint8_t color[3], int limit, std::vector<uint32_t> &cells,
+                 ColorKernel kernel = COLOR_KERNEL_AUTO);
+    // Igual a query(), mas as células encontradas saem do índice
+    size_t removeSimilar(const uint8_t color[3], int limit, std::vector<uint32_t> &cells,
+                         ColorKernel kernel = COLOR_KERNEL_AUTO);
+    const Stats &lastQuery() const { return _stats; }
+
+private:
+    // Chama visit(balde, inteiroDentro) para cada balde não vazio que toca a esfera
+    template <typename Visit>
+    void visitBuckets(const uint8_t color[3], int limit, Visit visit);
+
+    static int bucketOf(uint8_t r, uint8_t g, uint8_t b)
+    {
+        const int shift = 8 - COLOR_INDEX_BITS;
+        return ((r >> shift) << (2 * COLOR_INDEX_BITS)) | ((g >> shift) << COLOR_INDEX_BITS) | (b >> shift);
+    }
+
+    std::vector<uint32_t> _start;      // início de cada balde em _r/_g/_b/_cell
+    std::vector<uint32_t> _bucketSize; // células vivas no começo da faixa do balde
+    std::vector<uint8_t> _r, _g, _b;
+    std::vector<uint32_t> _cell;
+    std::vector<uint64_t> _mask;
+    size_t _size = 0;
+    Stats _stats;
+};
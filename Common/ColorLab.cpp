@@ -0,0 +1,112 @@
+#include "ColorLab.h"
+#include "ColorMatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// sRGB -> XYZ já dividido pelo branco D65 (Xn = 0.95047, Yn = 1, Zn = 1.08883)
+static const float TO_XYZ[3][3] = {
+    {0.4124564f / 0.95047f, 0.3575761f / 0.95047f, 0.1804375f / 0.95047f},
+    {0.2126729f, 0.7151522f, 0.0721750f},
+    {0.0193339f / 1.08883f, 0.1191920f / 1.08883f, 0.9503041f / 1.08883f},
+};
+
+static float linearize(uint8_t c)
+{
+    float v = c / 255.0f;
+    return v <= 0.04045f ? v / 12.92f : powf((v + 0.055f) / 1.055f, 2.4f);
+}
+
+// f(t) do CIELAB: raiz cúbica, com um trecho linear perto do preto
+static float labF(float t)
+{
+    const float delta = 6.0f / 29.0f;
+    return t > delta * delta * delta ? cbrtf(t) : t / (3.0f * delta * delta) + 4.0f / 29.0f;
+}
+
+static uint8_t toByte(float v)
+{
+    return uint8_t(min(255.0f, max(0.0f, v + 0.5f)));
+}
+
+const char *colorMetricName(ColorMetric metric)
+{
+    return metric == COLOR_METRIC_LAB ? "lab" : "rgb";
+}
+
+int colorMetricLimit(float tolerance, ColorMetric metric)
+{
+    if (metric == COLOR_METRIC_RGB)
+        return colorToleranceLimit(tolerance);
+    if (tolerance < 0.0f)
+        return -1;
+    double d = min(1.0, double(tolerance)) * LAB_MAX_DISTANCE;
+    return int(floor(d * d));
+}
+
+void srgbToLab(uint8_t r, uint8_t g, uint8_t b, float lab[3])
+{
+    const float rgb[3] = {linearize(r), linearize(g), linearize(b)};
+    float f[3];
+    for (int k = 0; k < 3; k++)
+        f[k] = labF(TO_XYZ[k][0] * rgb[0] + TO_XYZ[k][1] * rgb[1] + TO_XYZ[k][2] * rgb[2]);
+    lab[0] = 116.0f * f[1] - 16.0f;
+    lab[1] = 500.0f * (f[0] - f[1]);
+    lab[2] = 200.0f * (f[1] - f[2]);
+}
+
+// Intervalos da tabela de f(t) em [0, 1]; com interpolação linear o erro fica abaixo de 0,01 ΔE
+static const int F_STEPS = 1024;
+
+struct LabTables
+{
+    // Contribuição de cada canal para X/Xn, Y/Yn e Z/Zn: a soma das três é a linearização mais a matriz
+    float xyz[3][3][256];
+    float f[F_STEPS + 2];
+
+    LabTables()
+    {
+        for (int c = 0; c < 256; c++)
+        {
+            float v = linearize(uint8_t(c));
+            for (int k = 0; k < 3; k++)
+            {
+                for (int channel = 0; channel < 3; channel++)
+                    xyz[k][channel][c] = TO_XYZ[k][channel] * v;
+            }
+        }
+        for (int i = 0; i <= F_STEPS; i++)
+            f[i] = labF(float(i) / F_STEPS);
+        f[F_STEPS + 1] = f[F_STEPS];
+    }
+
+    float lookupF(float t) const
+    {
+        t = min(1.0f, max(0.0f, t)) * F_STEPS;
+        int i = int(t);
+        return f[i] + (f[i + 1] - f[i]) * (t - i);
+    }
+};
+
+static const LabTables &labTables()
+{
+    static const LabTables tables;
+    return tables;
+}
+
+void convertToLab(const uint8_t *r, const uint8_t *g, const uint8_t *b, size_t count, uint8_t *L, uint8_t *A,
+                  uint8_t *B)
+{
+    const LabTables &t = labTables();
+    for (size_t i = 0; i < count; i++)
+    {
+        float fx = t.lookupF(t.xyz[0][0][r[i]] + t.xyz[0][1][g[i]] + t.xyz[0][2][b[i]]);
+        float fy = t.lookupF(t.xyz[1][0][r[i]] + t.xyz[1][1][g[i]] + t.xyz[1][2][b[i]]);
+        float fz = t.lookupF(t.xyz[2][0][r[i]] + t.xyz[2][1][g[i]] + t.xyz[2][2][b[i]]);
+        L[i] = toByte(116.0f * fy - 16.0f);
+        A[i] = toByte(500.0f * (fx - fy) + 128.0f);
+        B[i] = toByte(200.0f * (fy - fz) + 128.0f);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Comparação perceptual das cores do Jogo das Cores (CIELAB).
+ *
+ * A distância euclidiana em RGB trata igual diferenças que o olho vê muito
+ * diferentes (dois verdes próximos contra dois azuis escuros próximos). Em
+ * L*a*b* (iluminante D65) a distância euclidiana, o ΔE*ab, acompanha melhor o
+ * que o jogador vê.
+ *
+ * A conversão é feita uma vez por célula, quando a grade é criada, e o
+ * resultado vai para três planos de um byte, com 1 unidade = 1 ΔE:
+ *
+ *   L* (0 a 100) -> L,  a* (-87 a 99) -> a + 128,  b* (-108 a 95) -> b + 128
+ *
+ * Assim os planos L*a*b* passam direto por matchColors(), ColorIndex e
+ * ColorSolver, que só veem três bytes por célula e um limite de distância²:
+ * durante o jogo o custo por célula é o mesmo do RGB. O arredondamento para
+ * bytes erra no máximo meio ΔE por canal, abaixo do que o olho distingue.
+ */
+
+enum ColorMetric
+{
+    COLOR_METRIC_RGB,
+    COLOR_METRIC_LAB
+};
+
+const char *colorMetricName(ColorMetric metric);
+
+// Maior ΔE*ab entre duas cores sRGB (azul e verde puros)
+const float LAB_MAX_DISTANCE = 258.68f;
+
+// Maior distância² aceita para a tolerância normalizada: em RGB é colorToleranceLimit(); em Lab a
+// tolerância é uma fração de LAB_MAX_DISTANCE
+int colorMetricLimit(float tolerance, ColorMetric metric);
+
+// Conversão exata de uma cor (pow e raiz cúbica em float), sem arredondar para bytes
+void srgbToLab(uint8_t r, uint8_t g, uint8_t b, float lab[3]);
+
+// Converte count cores para os planos L, A e B em bytes (formato acima). Usa tabelas da
+// linearização do sRGB e da raiz cúbica, sem pow nem cbrt por célula
+void convertToLab(const uint8_t *r, const uint8_t *g, const uint8_t *b, size_t count, uint8_t *L, uint8_t *A,
+                  uint8_t *B);
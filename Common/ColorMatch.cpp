@@ -0,0 +1,211 @@
+#include "ColorMatch.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+const int MAX_DISTANCE2 = 3 * 255 * 255;
+
+ColorKernel resolveColorKernel(ColorKernel kernel)
+{
+    if (kernel == COLOR_KERNEL_AUTO)
+        kernel = cpuHasAvx512() ? COLOR_KERNEL_AVX512 : cpuHasAvx2() ? COLOR_KERNEL_AVX2 : COLOR_KERNEL_SSE2;
+    if (kernel == COLOR_KERNEL_AVX512 && !cpuHasAvx512())
+        kernel = COLOR_KERNEL_AVX2;
+    if (kernel == COLOR_KERNEL_AVX2 && !cpuHasAvx2())
+        kernel = COLOR_KERNEL_SSE2;
+    if (kernel == COLOR_KERNEL_SSE2 && !cpuHasSse2())
+        kernel = COLOR_KERNEL_SCALAR;
+    return kernel;
+}
+
+const char *colorKernelName(ColorKernel kernel)
+{
+    switch (kernel)
+    {
+    case COLOR_KERNEL_SCALAR:
+        return "escalar";
+    case COLOR_KERNEL_SSE2:
+        return "sse2";
+    case COLOR_KERNEL_AVX2:
+        return "avx2";
+    case COLOR_KERNEL_AVX512:
+        return "avx512";
+    default:
+        return "auto";
+    }
+}
+
+int colorToleranceLimit(float tolerance)
+{
+    if (tolerance < 0.0f)
+        return -1;
+    // (d / 255)² / 3 <= t²  <=>  d² <= t² * 3 * 255²
+    double limit = floor(double(tolerance) * tolerance * MAX_DISTANCE2);
+    return int(min(limit, double(MAX_DISTANCE2)));
+}
+
+// Células [0, count) de uma palavra da máscara, count <= 64
+static uint64_t matchWordScalar(const uint8_t *r, const uint8_t *g, const uint8_t *b, int count,
+                                const uint8_t color[3], int limit)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int dr = r[i] - color[0];
+        int dg = g[i] - color[1];
+        int db = b[i] - color[2];
+        if (dr * dr + dg * dg + db * db <= limit)
+            bits |= uint64_t(1) << i;
+    }
+    return bits;
+}
+
+#ifdef PG_X86
+// |a - b| em bytes sem sinal
+PG_TARGET("sse2") static inline __m128i absDiffSse2(__m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+
+// 4 células: r e g intercalados em 16 bits, então um madd dá dr² + dg² em cada lane de 32 bits
+PG_TARGET("sse2") static inline int farSse2(__m128i rg, __m128i b0, __m128i limit)
+{
+    __m128i d2 = _mm_add_epi32(_mm_madd_epi16(rg, rg), _mm_madd_epi16(b0, b0));
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(d2, limit)));
+}
+
+// 64 células, 16 por vez
+PG_TARGET("sse2") static uint64_t matchWordSse2(const uint8_t *r, const uint8_t *g, const uint8_t *b,
+                                                const uint8_t color[3], int limit)
+{
+    const __m128i cr = _mm_set1_epi8(char(color[0]));
+    const __m128i cg = _mm_set1_epi8(char(color[1]));
+    const __m128i cb = _mm_set1_epi8(char(color[2]));
+    const __m128i lim = _mm_set1_epi32(limit);
+    const __m128i zero = _mm_setzero_si128();
+
+    uint64_t far = 0;
+    for (int i = 0; i < 64; i += 16)
+    {
+        __m128i ar = absDiffSse2(_mm_loadu_si128((const __m128i *)(r + i)), cr);
+        __m128i ag = absDiffSse2(_mm_loadu_si128((const __m128i *)(g + i)), cg);
+        __m128i ab = absDiffSse2(_mm_loadu_si128((const __m128i *)(b + i)), cb);
+
+        __m128i r16[2] = {_mm_unpacklo_epi8(ar, zero), _mm_unpackhi_epi8(ar, zero)};
+        __m128i g16[2] = {_mm_unpacklo_epi8(ag, zero), _mm_unpackhi_epi8(ag, zero)};
+        __m128i b16[2] = {_mm_unpacklo_epi8(ab, zero), _mm_unpackhi_epi8(ab, zero)};
+
+        uint64_t bits = 0;
+        for (int h = 0; h < 2; h++)
+        {
+            int lo = farSse2(_mm_unpacklo_epi16(r16[h], g16[h]), _mm_unpacklo_epi16(b16[h], zero), lim);
+            int hi = farSse2(_mm_unpackhi_epi16(r16[h], g16[h]), _mm_unpackhi_epi16(b16[h], zero), lim);
+            bits |= uint64_t(lo | (hi << 4)) << (h * 8);
+        }
+        far |= bits << i;
+    }
+    return ~far;
+}
+
+// 8 células a partir de bytes já subtraídos: g vai para a metade alta de cada lane de 32 bits
+PG_TARGET("avx2") static inline int farAvx2(__m128i ar, __m128i ag, __m128i ab, __m256i limit)
+{
+    __m256i r32 = _mm256_cvtepu8_epi32(ar);
+    __m256i g32 = _mm256_cvtepu8_epi32(ag);
+    __m256i b32 = _mm256_cvtepu8_epi32(ab);
+    __m256i rg = _mm256_or_si256(r32, _mm256_slli_epi32(g32, 16));
+    __m256i d2 = _mm256_add_epi32(_mm256_madd_epi16(rg, rg), _mm256_madd_epi16(b32, b32));
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(d2, limit)));
+}
+
+PG_TARGET("avx2") static uint64_t matchWordAvx2(const uint8_t *r, const uint8_t *g, const uint8_t *b,
+                                                const uint8_t color[3], int limit)
+{
+    const __m128i cr = _mm_set1_epi8(char(color[0]));
+    const __m128i cg = _mm_set1_epi8(char(color[1]));
+    const __m128i cb = _mm_set1_epi8(char(color[2]));
+    const __m256i lim = _mm256_set1_epi32(limit);
+
+    uint64_t far = 0;
+    for (int i = 0; i < 64; i += 16)
+    {
+        __m128i ar = absDiffSse2(_mm_loadu_si128((const __m128i *)(r + i)), cr);
+        __m128i ag = absDiffSse2(_mm_loadu_si128((const __m128i *)(g + i)), cg);
+        __m128i ab = absDiffSse2(_mm_loadu_si128((const __m128i *)(b + i)), cb);
+
+        int lo = farAvx2(ar, ag, ab, lim);
+        int hi = farAvx2(_mm_srli_si128(ar, 8), _mm_srli_si128(ag, 8), _mm_srli_si128(ab, 8), lim);
+        far |= uint64_t(lo | (hi << 8)) << i;
+    }
+    return ~far;
+}
+
+// 16 células do quarto Q (o índice do extract precisa ser constante); a comparação já devolve a máscara
+template <int Q>
+PG_TARGET("avx512f,avx512bw") static inline uint64_t nearAvx512(__m512i ar, __m512i ag, __m512i ab, __m512i limit)
+{
+    __m512i r32 = _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(ar, Q));
+    __m512i g32 = _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(ag, Q));
+    __m512i b32 = _mm512_cvtepu8_epi32(_mm512_extracti32x4_epi32(ab, Q));
+    __m512i rg = _mm512_or_si512(r32, _mm512_slli_epi32(g32, 16));
+    __m512i d2 = _mm512_add_epi32(_mm512_madd_epi16(rg, rg), _mm512_madd_epi16(b32, b32));
+    return uint64_t(_mm512_cmple_epi32_mask(d2, limit)) << (Q * 16);
+}
+
+PG_TARGET("avx512f,avx512bw") static uint64_t matchWordAvx512(const uint8_t *r, const uint8_t *g, const uint8_t *b,
+                                                              const uint8_t color[3], int limit)
+{
+    const __m512i cr = _mm512_set1_epi8(char(color[0]));
+    const __m512i cg = _mm512_set1_epi8(char(color[1]));
+    const __m512i cb = _mm512_set1_epi8(char(color[2]));
+    const __m512i lim = _mm512_set1_epi32(limit);
+
+    __m512i vr = _mm512_loadu_si512(r);
+    __m512i vg = _mm512_loadu_si512(g);
+    __m512i vb = _mm512_loadu_si512(b);
+    __m512i ar = _mm512_or_si512(_mm512_subs_epu8(vr, cr), _mm512_subs_epu8(cr, vr));
+    __m512i ag = _mm512_or_si512(_mm512_subs_epu8(vg, cg), _mm512_subs_epu8(cg, vg));
+    __m512i ab = _mm512_or_si512(_mm512_subs_epu8(vb, cb), _mm512_subs_epu8(cb, vb));
+
+    return nearAvx512<0>(ar, ag, ab, lim) | nearAvx512<1>(ar, ag, ab, lim) | nearAvx512<2>(ar, ag, ab, lim) |
+           nearAvx512<3>(ar, ag, ab, lim);
+}
+#endif
+
+size_t matchColors(const uint8_t *r, const uint8_t *g, const uint8_t *b, size_t count, const uint8_t color[3],
+                   int limit, uint64_t *mask, ColorKernel kernel)
+{
+    kernel = resolveColorKernel(kernel);
+    size_t full = count / 64;
+    size_t matched = 0;
+
+    for (size_t w = 0; w < full; w++)
+    {
+        size_t i = w * 64;
+        uint64_t bits;
+#ifdef PG_X86
+        if (kernel == COLOR_KERNEL_AVX512)
+            bits = matchWordAvx512(r + i, g + i, b + i, color, limit);
+        else if (kernel == COLOR_KERNEL_AVX2)
+            bits = matchWordAvx2(r + i, g + i, b + i, color, limit);
+        else if (kernel == COLOR_KERNEL_SSE2)
+            bits = matchWordSse2(r + i, g + i, b + i, color, limit);
+        else
+#endif
+            bits = matchWordScalar(r + i, g + i, b + i, 64, color, limit);
+        mask[w] = bits;
+        matched += popCount64(bits);
+    }
+
+    // Sobra da última palavra; os bits além de count ficam zerados
+    if (count % 64)
+    {
+        size_t i = full * 64;
+        mask[full] = matchWordScalar(r + i, g + i, b + i, int(count - i), color, limit);
+        matched += popCount64(mask[full]);
+    }
+    return matched;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Comparação de cores em lote para o Jogo das Cores.
+ *
+ * As cores ficam em três planos separados (r, g e b, um byte por célula),
+ * então os kernels leem 16, 32 ou 64 células por vez sem pular os outros
+ * campos da célula. A distância é comparada ao quadrado, em inteiros:
+ *
+ *   dr² + dg² + db² <= limite        (componentes de 0 a 255)
+ *
+ * onde limite = colorToleranceLimit(tolerancia) equivale ao teste antigo
+ * sqrt(dr² + dg² + db²) / sqrt(3) <= tolerancia com cores em [0, 1] (sem o
+ * arredondamento do float, que às vezes descartava células bem na borda).
+ *
+ * O resultado é uma máscara com 1 bit por célula (bit i % 64 da palavra
+ * i / 64). Os kernels SSE2, AVX2 e AVX-512 são escolhidos em tempo de
+ * execução (COLOR_KERNEL_AUTO) e geram exatamente a mesma máscara.
+ */
+
+enum ColorKernel
+{
+    COLOR_KERNEL_AUTO,
+    COLOR_KERNEL_SCALAR,
+    COLOR_KERNEL_SSE2,
+    COLOR_KERNEL_AVX2,
+    COLOR_KERNEL_AVX512
+};
+
+// Kernel que será usado de fato: AUTO vira o melhor disponível e kernels sem suporte na CPU caem para o próximo
+ColorKernel resolveColorKernel(ColorKernel kernel);
+const char *colorKernelName(ColorKernel kernel);
+
+// Maior distância ao quadrado (em unidades de 8 bits) aceita para a tolerância normalizada
+int colorToleranceLimit(float tolerance);
+
+inline size_t colorMaskWords(size_t count)
+{
+    return (count + 63) / 64;
+}
+
+// Preenche colorMaskWords(count) palavras de mask e devolve quantas células casaram
+size_t matchColors(const uint8_t *r, const uint8_t *g, const uint8_t *b, size_t count, const uint8_t color[3],
+                   int limit, uint64_t *mask, ColorKernel kernel = COLOR_KERNEL_AUTO);
@@ -0,0 +1,228 @@
+#include "ColorRegions.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+const char *colorConnectivityName(ColorConnectivity connectivity)
+{
+    switch (connectivity)
+    {
+    case COLOR_CONNECT_4:
+        return "4-conexo";
+    case COLOR_CONNECT_8:
+        return "8-conexo";
+    default:
+        return "grade toda";
+    }
+}
+
+static inline bool linked(const ColorGrid &grid, size_t a, size_t b, int limit)
+{
+    if (grid.eliminated(a) || grid.eliminated(b))
+        return false;
+    int dr = grid.matchPlane(0)[a] - grid.matchPlane(0)[b];
+    int dg = grid.matchPlane(1)[a] - grid.matchPlane(1)[b];
+    int db = grid.matchPlane(2)[a] - grid.matchPlane(2)[b];
+    return dr * dr + dg * dg + db * db <= limit;
+}
+
+// Com path halving. A raiz de cada árvore é a menor célula dela, então o pai é sempre menor que o filho
+static inline uint32_t findRoot(uint32_t *parent, uint32_t x)
+{
+    while (parent[x] != x)
+    {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+static inline void unite(uint32_t *parent, uint32_t a, uint32_t b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a < b)
+        parent[b] = a;
+    else if (b < a)
+        parent[a] = b;
+}
+
+// out[i] = 1 se as cores das células a + i e b + i estão a até limit. Laço simples sobre os planos,
+// que o compilador vetoriza; o union-find só vê as ligações que passaram
+static void similarPairs(const ColorGrid &grid, size_t a, size_t b, size_t count, int limit, uint8_t *out)
+{
+    const uint8_t *r = grid.matchPlane(0), *g = grid.matchPlane(1), *bl = grid.matchPlane(2);
+    for (size_t i = 0; i < count; i++)
+    {
+        int dr = r[a + i] - r[b + i];
+        int dg = g[a + i] - g[b + i];
+        int db = bl[a + i] - bl[b + i];
+        out[i] = dr * dr + dg * dg + db * db <= limit;
+    }
+}
+
+void ColorRegions::build(const ColorGrid &grid, ColorConnectivity connectivity, int limit, ThreadPool *pool)
+{
+    const int cols = grid.cols(), rows = grid.rows();
+    const bool allAlive = grid.alive() == grid.size();
+    _label.resize(grid.size());
+    uint32_t *parent = _label.data();
+    for (size_t i = 0; i < grid.size(); i++)
+        parent[i] = uint32_t(i);
+
+    // Liga as células [first, first + count) às [first + offset, ...) que passaram em similarPairs()
+    auto linkPairs = [&](size_t first, size_t offset, size_t count, vector<uint8_t> &flags)
+    {
+        similarPairs(grid, first, first + offset, count, limit, flags.data());
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t a = first + i, b = a + offset;
+            if (flags[i] && (allAlive || (!grid.eliminated(a) && !grid.eliminated(b))))
+                unite(parent, uint32_t(a), uint32_t(b));
+        }
+    };
+
+    // Ligações de uma linha com a vizinha da direita e com a linha de baixo (e as diagonais no 8-conexo)
+    auto linkRow = [&](int row, bool right, bool down, vector<uint8_t> &flags)
+    {
+        size_t base = grid.index(0, row);
+        if (right)
+            linkPairs(base, 1, cols - 1, flags);
+        if (!down)
+            return;
+        linkPairs(base, cols, cols, flags);
+        if (connectivity == COLOR_CONNECT_8)
+        {
+            linkPairs(base + 1, cols - 1, cols - 1, flags);
+            linkPairs(base, cols + 1, cols - 1, flags);
+        }
+    };
+
+    // Cada bloco de linhas só liga células dentro dele: as raízes também ficam no bloco e as
+    // threads não escrevem nos mesmos pais. A última linha de cada bloco não olha para baixo
+    size_t blockRows = pool ? max<size_t>(1, rows / (pool->size() * 4)) : max(1, rows);
+    vector<vector<uint8_t>> flags(pool ? pool->size() : 1, vector<uint8_t>(cols));
+    auto linkBlock = [&](size_t begin, size_t end, int worker)
+    {
+        for (size_t row = begin; row < end; row++)
+            linkRow(int(row), true, row + 1 < end, flags[worker]);
+    };
+    if (pool)
+        pool->parallelFor(rows, blockRows, linkBlock);
+    else
+        linkBlock(0, rows, 0);
+
+    // Bordas entre os blocos, na thread que chamou
+    for (size_t row = blockRows - 1; row + 1 < size_t(rows); row += blockRows)
+        linkRow(int(row), false, true, flags[0]);
+
+    // Rótulos densos em ordem de célula: o pai já foi renumerado quando o filho chega
+    uint32_t regions = 0;
+    for (size_t i = 0; i < grid.size(); i++)
+        _label[i] = _label[i] == i ? regions++ : _label[_label[i]];
+
+    // Células agrupadas por região (ordenação por contagem)
+    _start.assign(size_t(regions) + 1, 0);
+    for (size_t i = 0; i < grid.size(); i++)
+        _start[_label[i] + 1]++;
+    for (uint32_t k = 0; k < regions; k++)
+        _start[k + 1] += _start[k];
+    _cells.resize(grid.size());
+    for (size_t i = 0; i < grid.size(); i++)
+        _cells[_start[_label[i]]++] = uint32_t(i);
+
+    // Cada início andou até o início da região seguinte: volta uma posição
+    for (uint32_t k = regions; k > 0; k--)
+        _start[k] = _start[k - 1];
+    _start[0] = 0;
+
+    // Regiões da maior para a menor (ordenação por contagem do tamanho; no mesmo tamanho, pela menor célula)
+    uint32_t largestSize = 0;
+    for (uint32_t k = 0; k < regions; k++)
+        largestSize = max(largestSize, size(k));
+    vector<uint32_t> bySize(size_t(largestSize) + 2, 0);
+    for (uint32_t k = 0; k < regions; k++)
+        bySize[largestSize - size(k) + 1]++;
+    for (size_t n = 1; n < bySize.size(); n++)
+        bySize[n] += bySize[n - 1];
+    _order.resize(regions);
+    for (uint32_t k = 0; k < regions; k++)
+        _order[bySize[largestSize - size(k)]++] = k;
+    _firstAlive = 0;
+}
+
+void ColorRegions::clear()
+{
+    _label.clear();
+    _start.clear();
+    _cells.clear();
+    _order.clear();
+    _firstAlive = 0;
+}
+
+size_t ColorRegions::largest(const ColorGrid &grid, size_t k, vector<ColorMove> &moves) const
+{
+    // Regiões saem do jogo inteiras: basta olhar a primeira célula. As maiores costumam sair primeiro,
+    // então o começo já eliminado da ordem é pulado uma vez só
+    auto alive = [&](uint32_t label) { return !grid.eliminated(*begin(label)); };
+    while (_firstAlive < _order.size() && !alive(_order[_firstAlive]))
+        _firstAlive++;
+
+    moves.clear();
+    for (size_t n = _firstAlive; n < _order.size() && moves.size() < k; n++)
+    {
+        if (alive(_order[n]))
+            moves.push_back({*begin(_order[n]), size(_order[n])});
+    }
+    return moves.size();
+}
+
+size_t ColorRegions::flood(const ColorGrid &grid, size_t cell, ColorConnectivity connectivity, int limit,
+                           vector<uint32_t> &cells)
+{
+    if (grid.eliminated(cell))
+        return 0;
+
+    const int cols = grid.cols(), rows = grid.rows();
+    _visited.resize((grid.size() + 63) / 64);
+    auto visit = [&](size_t idx)
+    {
+        uint64_t bit = uint64_t(1) << (idx % 64);
+        if (_visited[idx / 64] & bit)
+            return false;
+        _visited[idx / 64] |= bit;
+        return true;
+    };
+
+    const int neighbours = connectivity == COLOR_CONNECT_8 ? 8 : 4;
+    const int dx[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+    const int dy[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+    size_t first = cells.size();
+    visit(cell);
+    _stack.assign(1, uint32_t(cell));
+    while (!_stack.empty())
+    {
+        uint32_t current = _stack.back();
+        _stack.pop_back();
+        cells.push_back(current);
+
+        int col = grid.colOf(current), row = grid.rowOf(current);
+        for (int n = 0; n < neighbours; n++)
+        {
+            int c = col + dx[n], r = row + dy[n];
+            if (c < 0 || r < 0 || c >= cols || r >= rows)
+                continue;
+            size_t idx = grid.index(c, r);
+            if (linked(grid, current, idx, limit) && visit(idx))
+                _stack.push_back(uint32_t(idx));
+        }
+    }
+
+    // Limpa só os bits marcados, sem varrer a grade
+    for (size_t i = first; i < cells.size(); i++)
+        _visited[cells[i] / 64] &= ~(uint64_t(1) << (cells[i] % 64));
+    return cells.size() - first;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ColorGrid.h"
+#include "ColorSolver.h"
+
+class ThreadPool;
+
+/*
+ * Regiões conectadas de cores parecidas, para a regra de eliminação por região.
+ *
+ * Duas células vizinhas (4 ou 8 vizinhos) estão ligadas quando as duas estão
+ * vivas e a distância² entre as cores é <= limite (mesma escala de
+ * colorMetricLimit()). Uma região é um componente conexo dessas ligações; um
+ * clique elimina a região inteira da célula clicada. Como as regiões só saem
+ * do jogo inteiras, as que sobram não mudam ao longo da partida.
+ *
+ * Há dois caminhos com o mesmo resultado:
+ *   - flood(): percorre a região a partir do clique (pilha, sem recursão),
+ *     custo proporcional ao tamanho da região
+ *   - build() + cells(): union-find sobre a grade inteira uma vez por
+ *     partida; depois o clique é uma consulta ao rótulo e uma faixa
+ *     contígua de células (rótulos ordenados por contagem)
+ *
+ * build() divide as linhas em blocos entre as threads do pool (cada bloco
+ * só liga raízes dentro dele) e depois junta as bordas entre os blocos.
+ */
+
+enum ColorConnectivity
+{
+    COLOR_CONNECT_NONE, // sem regiões: o clique elimina as parecidas da grade toda
+    COLOR_CONNECT_4,
+    COLOR_CONNECT_8
+};
+
+const char *colorConnectivityName(ColorConnectivity connectivity);
+
+class ColorRegions
+{
+public:
+    // Rotula as regiões de todas as células vivas da grade
+    void build(const ColorGrid &grid, ColorConnectivity connectivity, int limit, ThreadPool *pool = nullptr);
+    void clear();
+    bool built() const { return !_label.empty(); }
+
+    size_t count() const { return _start.empty() ? 0 : _start.size() - 1; }
+    uint32_t labelOf(size_t cell) const { return _label[cell]; }
+    // Células da região, em ordem crescente
+    const uint32_t *begin(uint32_t label) const { return _cells.data() + _start[label]; }
+    const uint32_t *end(uint32_t label) const { return _cells.data() + _start[label + 1]; }
+    uint32_t size(uint32_t label) const { return _start[label + 1] - _start[label]; }
+
+    // As k maiores regiões ainda vivas, como cliques (a célula é a de menor índice da região). Supõe que
+    // os cliques usam a tolerância do build(), para que as regiões saiam sempre inteiras
+    size_t largest(const ColorGrid &grid, size_t k, std::vector<ColorMove> &moves) const;
+
+    // Acrescenta em cells a região viva de cell percorrendo a grade, sem rótulos; nada se cell estiver eliminada
+    size_t flood(const ColorGrid &grid, size_t cell, ColorConnectivity connectivity, int limit,
+                 std::vector<uint32_t> &cells);
+
+private:
+    std::vector<uint32_t> _label;   // região de cada célula (durante build(), o pai no union-find)
+    std::vector<uint32_t> _start;   // início de cada região em _cells
+    std::vector<uint32_t> _cells;
+    std::vector<uint32_t> _order;   // regiões da maior para a menor
+    mutable size_t _firstAlive = 0; // antes dele, em _order, só há regiões eliminadas
+
+    std::vector<uint64_t> _visited; // bits de flood(), limpos ao final de cada chamada
+    std::vector<uint32_t> _stack;
+};
@@ -0,0 +1,322 @@
+#include "ColorSolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+
+using namespace std;
+
+static const uint32_t SIMD_MIN_RANGE = 64;
+
+static double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Raiz inteira (o sqrt em double é exato o bastante para os limites de 8 bits)
+static int isqrt(int x)
+{
+    return int(sqrt(double(x)));
+}
+
+ColorSolver::ColorSolver(ThreadPool &pool)
+    : _pool(pool), _forcedBits(0), _bits(COLOR_SOLVER_MIN_BITS)
+{
+    _scratch.resize(_pool.size());
+}
+
+// Pontos de troca medidos com o BenchSolver (tolerância 0.2)
+int ColorSolver::bitsFor(size_t alive)
+{
+    if (alive < 100000)
+        return 4;
+    if (alive < 2000000)
+        return 5;
+    return 6;
+}
+
+void ColorSolver::build(const ColorGrid &grid)
+{
+    auto start = chrono::steady_clock::now();
+
+    size_t alive = grid.alive();
+    _bits = _forcedBits ? _forcedBits : bitsFor(alive);
+    const int SHIFT = 8 - _bits, WIDTH = 1 << SHIFT, BUCKETS = 1 << (3 * _bits);
+    const uint8_t *r = grid.matchPlane(0), *g = grid.matchPlane(1), *b = grid.matchPlane(2);
+    const int residualBits = 3 * SHIFT;
+
+    // Ordenação radix em duas passadas estáveis: bits baixos das cores e depois o balde. Cada
+    // balde fica ordenado pela cor completa e, na mesma cor, pelo índice da célula
+    vector<uint32_t> residualStart((1 << residualBits) + 1, 0);
+    for (size_t i = 0; i < grid.size(); i++)
+    {
+        if (grid.eliminated(i))
+            continue;
+        int residual = ((r[i] & (WIDTH - 1)) << (2 * SHIFT)) | ((g[i] & (WIDTH - 1)) << SHIFT) | (b[i] & (WIDTH - 1));
+        residualStart[residual + 1]++;
+    }
+    for (size_t k = 1; k < residualStart.size(); k++)
+        residualStart[k] += residualStart[k - 1];
+
+    vector<uint32_t> byResidual(alive);
+    _start.assign(BUCKETS + 1, 0);
+    for (size_t i = 0; i < grid.size(); i++)
+    {
+        if (grid.eliminated(i))
+            continue;
+        int residual = ((r[i] & (WIDTH - 1)) << (2 * SHIFT)) | ((g[i] & (WIDTH - 1)) << SHIFT) | (b[i] & (WIDTH - 1));
+        byResidual[residualStart[residual]++] = uint32_t(i);
+        _start[bucketOf(r[i], g[i], b[i]) + 1]++;
+    }
+    for (int k = 1; k <= BUCKETS; k++)
+        _start[k] += _start[k - 1];
+
+    _r.resize(alive);
+    _g.resize(alive);
+    _b.resize(alive);
+    _cell.resize(alive);
+    vector<uint32_t> next(_start.begin(), _start.end() - 1);
+    for (uint32_t cell : byResidual)
+    {
+        uint32_t slot = next[bucketOf(r[cell], g[cell], b[cell])]++;
+        _r[slot] = r[cell];
+        _g[slot] = g[cell];
+        _b[slot] = b[cell];
+        _cell[slot] = cell;
+    }
+
+    _distinct.assign(BUCKETS, 0);
+    size_t candidates = 0;
+    for (int k = 0; k < BUCKETS; k++)
+    {
+        for (uint32_t slot = _start[k]; slot < _start[k + 1]; slot++)
+        {
+            bool repeated = slot > _start[k] && _r[slot] == _r[slot - 1] && _g[slot] == _g[slot - 1] && _b[slot] == _b[slot - 1];
+            _distinct[k] += !repeated;
+        }
+        candidates += _distinct[k];
+    }
+
+    _stats = Stats();
+    _stats.alive = alive;
+    _stats.candidates = candidates;
+    _stats.buildMs = elapsedMs(start);
+}
+
+template <typename Row>
+void ColorSolver::visitRows(const int lo[3], const int hi[3], int limit, Row row) const
+{
+    const int SHIFT = 8 - _bits, WIDTH = 1 << SHIFT;
+    // Menor e maior distância ao quadrado da caixa até cada faixa de baldes, em r e g
+    int radius = isqrt(limit);
+    int first[2], last[2];
+    int near2[2][1 << COLOR_SOLVER_MAX_BITS], far2[2][1 << COLOR_SOLVER_MAX_BITS];
+    for (int axis = 0; axis < 2; axis++)
+    {
+        first[axis] = max(lo[axis] - radius, 0) >> SHIFT;
+        last[axis] = min(hi[axis] + radius, 255) >> SHIFT;
+        for (int k = first[axis]; k <= last[axis]; k++)
+        {
+            int binLo = k * WIDTH, binHi = binLo + WIDTH - 1;
+            int nearest = hi[axis] < binLo ? binLo - hi[axis] : (lo[axis] > binHi ? lo[axis] - binHi : 0);
+            int farthest = max(binHi - lo[axis], hi[axis] - binLo);
+            near2[axis][k] = nearest * nearest;
+            far2[axis][k] = farthest * farthest;
+        }
+    }
+
+    for (int kr = first[0]; kr <= last[0]; kr++)
+    {
+        for (int kg = first[1]; kg <= last[1]; kg++)
+        {
+            int near2rg = near2[0][kr] + near2[1][kg];
+            if (near2rg > limit)
+                continue;
+
+            // Em b, a faixa ao alcance é um intervalo de cores; os baldes que o tocam ou cabem nele são contíguos
+            int reach = isqrt(limit - near2rg);
+            int A = max(lo[2] - reach, 0) >> SHIFT;
+            int B = min(hi[2] + reach, 255) >> SHIFT;
+
+            int a = B + 1, b = B;
+            int far2rg = far2[0][kr] + far2[1][kg];
+            if (far2rg <= limit)
+            {
+                int inner = isqrt(limit - far2rg);
+                a = max((max(hi[2] - inner, 0) + WIDTH - 1) >> SHIFT, A);
+                b = min(((min(lo[2] + inner, 255) + 1) >> SHIFT) - 1, B);
+                if (a > b)
+                {
+                    a = B + 1;
+                    b = B;
+                }
+            }
+
+            row((kr << (2 * _bits)) | (kg << _bits), A, a, b, B);
+        }
+    }
+}
+
+uint32_t ColorSolver::upperBound(int bucket, int limit) const
+{
+    const int SHIFT = 8 - _bits, WIDTH = 1 << SHIFT, SIDE = 1 << _bits;
+    int key[3] = {bucket >> (2 * _bits), (bucket >> _bits) & (SIDE - 1), bucket & (SIDE - 1)};
+    int lo[3], hi[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        lo[axis] = key[axis] << SHIFT;
+        hi[axis] = lo[axis] + WIDTH - 1;
+    }
+
+    uint32_t bound = 0;
+    auto sum = [&](int base, int A, int a, int b, int B)
+    {
+        bound += _start[base + B + 1] - _start[base + A];
+    };
+    visitRows(lo, hi, limit, sum);
+    return bound;
+}
+
+uint32_t ColorSolver::countNear(const uint8_t color[3], int limit, uint32_t threshold, Scratch &scratch,
+                                ColorKernel kernel) const
+{
+    int c[3] = {color[0], color[1], color[2]};
+    uint32_t inside = 0, border = 0;
+    scratch.ranges.clear();
+    auto split = [&](int base, int A, int a, int b, int B)
+    {
+        uint32_t s0 = _start[base + A], s1 = _start[base + a], s2 = _start[base + b + 1], s3 = _start[base + B + 1];
+        inside += s2 - s1;
+        border += (s1 - s0) + (s3 - s2);
+        if (s1 > s0)
+        {
+            scratch.ranges.push_back(s0);
+            scratch.ranges.push_back(s1);
+        }
+        if (s3 > s2)
+        {
+            scratch.ranges.push_back(s2);
+            scratch.ranges.push_back(s3);
+        }
+    };
+    visitRows(c, c, limit, split);
+
+    if (inside + border < threshold)
+        return 0;
+
+    // Faixas curtas não compensam a chamada ao kernel SIMD
+    uint32_t count = inside;
+    for (size_t i = 0; i < scratch.ranges.size(); i += 2)
+    {
+        uint32_t begin = scratch.ranges[i], size = scratch.ranges[i + 1] - begin;
+        if (size >= SIMD_MIN_RANGE)
+        {
+            if (scratch.mask.size() < colorMaskWords(size))
+                scratch.mask.resize(colorMaskWords(size));
+            count += uint32_t(matchColors(&_r[begin], &_g[begin], &_b[begin], size, color, limit, scratch.mask.data(), kernel));
+            continue;
+        }
+        for (uint32_t j = begin; j < begin + size; j++)
+        {
+            int dr = _r[j] - c[0], dg = _g[j] - c[1], db = _b[j] - c[2];
+            count += dr * dr + dg * dg + db * db <= limit;
+        }
+    }
+    scratch.exact++;
+    scratch.tested += border;
+    return count;
+}
+
+size_t ColorSolver::bestMoves(int limit, size_t k, vector<ColorMove> &moves, ColorKernel kernel)
+{
+    auto start = chrono::steady_clock::now();
+    kernel = resolveColorKernel(kernel);
+    moves.clear();
+    _stats.exact = _stats.binsPruned = _stats.tested = 0;
+    if (k == 0 || _cell.empty() || limit < 0)
+    {
+        _stats.solveMs = elapsedMs(start);
+        return 0;
+    }
+
+    // Limite superior de cada balde com candidatas, em paralelo; os maiores são avaliados primeiro
+    const int BUCKETS = 1 << (3 * _bits);
+    vector<int> buckets;
+    for (int bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        if (_distinct[bucket] > 0)
+            buckets.push_back(bucket);
+    }
+    vector<uint32_t> bound(BUCKETS, 0);
+    auto bounds = [&](size_t begin, size_t end, int worker)
+    {
+        for (size_t i = begin; i < end; i++)
+            bound[buckets[i]] = upperBound(buckets[i], limit);
+    };
+    _pool.parallelFor(buckets.size(), 64, bounds);
+    stable_sort(buckets.begin(), buckets.end(), [&](int x, int y)
+                { return bound[x] > bound[y]; });
+
+    for (Scratch &scratch : _scratch)
+    {
+        scratch.exact = scratch.binsPruned = scratch.tested = 0;
+    }
+
+    auto better = [](const ColorMove &x, const ColorMove &y)
+    {
+        return x.eliminated > y.eliminated || (x.eliminated == y.eliminated && x.cell < y.cell);
+    };
+
+    // moves fica ordenado; threshold é a contagem do k-ésimo quando já há k, e poda quem não pode alcançá-lo
+    mutex bestMutex;
+    atomic<uint32_t> threshold(0);
+    auto offer = [&](ColorMove move)
+    {
+        lock_guard<mutex> lock(bestMutex);
+        if (moves.size() == k && !better(move, moves.back()))
+            return;
+        moves.insert(upper_bound(moves.begin(), moves.end(), move, better), move);
+        if (moves.size() > k)
+            moves.pop_back();
+        if (moves.size() == k)
+            threshold.store(moves.back().eliminated, memory_order_relaxed);
+    };
+
+    auto evaluate = [&](size_t begin, size_t end, int worker)
+    {
+        Scratch &scratch = _scratch[worker];
+        for (size_t i = begin; i < end; i++)
+        {
+            int bucket = buckets[i];
+            if (bound[bucket] < threshold.load(memory_order_relaxed))
+            {
+                scratch.binsPruned++;
+                continue;
+            }
+
+            for (uint32_t slot = _start[bucket]; slot < _start[bucket + 1]; slot++)
+            {
+                if (slot > _start[bucket] && _r[slot] == _r[slot - 1] && _g[slot] == _g[slot - 1] && _b[slot] == _b[slot - 1])
+                    continue;
+
+                uint8_t color[3] = {_r[slot], _g[slot], _b[slot]};
+                uint32_t cut = threshold.load(memory_order_relaxed);
+                uint32_t count = countNear(color, limit, cut, scratch, kernel);
+                if (count > 0 && count >= cut)
+                    offer({_cell[slot], count});
+            }
+        }
+    };
+    _pool.parallelFor(buckets.size(), 1, evaluate);
+
+    for (const Scratch &scratch : _scratch)
+    {
+        _stats.exact += scratch.exact;
+        _stats.binsPruned += scratch.binsPruned;
+        _stats.tested += scratch.tested;
+    }
+    _stats.solveMs = elapsedMs(start);
+    return moves.size();
+}
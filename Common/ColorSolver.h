@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ColorGrid.h"
+#include "ColorMatch.h"
+#include "ThreadPool.h"
+
+/*
+ * Solver do Jogo das Cores: encontra os cliques que eliminam mais células.
+ *
+ * Um clique elimina todas as células vivas a até "limit" da cor clicada, então
+ * células da mesma cor valem o mesmo e só as cores distintas são candidatas.
+ * build() ordena as células vivas por cor em baldes uniformes do cubo RGB
+ * (ordenação por contagem); o vetor de inícios dos baldes é o histograma
+ * acumulado, então a quantidade de células em qualquer faixa de baldes
+ * contíguos sai em O(1). Com a métrica Lab, o "cubo" é o dos planos L*a*b*
+ * (ColorGrid::matchPlane()).
+ *
+ * Para cada candidata, cada linha (r, g) de baldes ao alcance da tolerância
+ * tem uma faixa de baldes em b inteiramente dentro da esfera (contada pelo
+ * histograma) e no máximo duas faixas na borda (testadas com matchColors()).
+ * Só a borda é cara; a soma das faixas é um limite superior barato.
+ *
+ * bestMoves() poda em dois níveis com esse limite: baldes inteiros de
+ * candidatas (limite da caixa do balde) e cada candidata antes da contagem
+ * exata. Os baldes são avaliados do maior limite para o menor, divididos
+ * entre as threads do pool, e o k-ésimo melhor resultado já encontrado é o
+ * corte compartilhado. O resultado não depende do número de threads: empates
+ * são decididos pelo menor índice de célula.
+ */
+
+// Bits por canal dos baldes. Com poucas células valem baldes grandes (menos linhas por consulta); com
+// muitas, baldes pequenos (borda da esfera mais fina, menos células testadas uma a uma)
+const int COLOR_SOLVER_MIN_BITS = 4;
+const int COLOR_SOLVER_MAX_BITS = 6;
+
+struct ColorMove
+{
+    uint32_t cell;       // célula a clicar (a de menor índice com essa cor)
+    uint32_t eliminated; // células eliminadas pelo clique, contando a clicada
+};
+
+class ColorSolver
+{
+public:
+    struct Stats
+    {
+        size_t alive = 0;      // células vivas indexadas
+        size_t candidates = 0; // cores distintas entre elas
+        size_t exact = 0;      // candidatas contadas exatamente (as outras foram podadas)
+        size_t binsPruned = 0; // baldes de candidatas descartados inteiros
+        size_t tested = 0;     // células comparadas uma a uma nas contagens exatas
+        double buildMs = 0.0;
+        double solveMs = 0.0;
+    };
+
+    // As candidatas são divididas entre as threads de pool
+    explicit ColorSolver(ThreadPool &pool);
+
+    // Fixa os bits por canal dos baldes no próximo build(); 0 volta à escolha pelo número de células vivas
+    void setBucketBits(int bits) { _forcedBits = bits; }
+    int bucketBits() const { return _bits; }
+
+    // Indexa as células vivas da grade; precisa ser chamado de novo depois de eliminações
+    void build(const ColorGrid &grid);
+
+    // Os k melhores cliques, do que elimina mais para o que elimina menos
+    size_t bestMoves(int limit, size_t k, std::vector<ColorMove> &moves, ColorKernel kernel = COLOR_KERNEL_AUTO);
+
+    int threads() const { return _pool.size(); }
+    const Stats &stats() const { return _stats; }
+
+private:
+    struct Scratch
+    {
+        std::vector<uint32_t> ranges; // pares [início, fim) de células na borda
+        std::vector<uint64_t> mask;
+        size_t exact = 0;
+        size_t binsPruned = 0;
+        size_t tested = 0;
+    };
+
+    // Chama row(base, A, a, b, B) para cada linha (r, g) de baldes ao alcance da caixa de cores [lo, hi]:
+    // [A, B] são os baldes em b que tocam a esfera e [a, b] os inteiramente dentro dela (a > b se nenhum)
+    template <typename Row>
+    void visitRows(const int lo[3], const int hi[3], int limit, Row row) const;
+
+    static int bitsFor(size_t alive);
+    int bucketOf(uint8_t r, uint8_t g, uint8_t b) const
+    {
+        const int shift = 8 - _bits;
+        return ((r >> shift) << (2 * _bits)) | ((g >> shift) << _bits) | (b >> shift);
+    }
+
+    uint32_t upperBound(int bucket, int limit) const;
+    // Células a até limit de color; 0 se o limite superior ficar abaixo de threshold
+    uint32_t countNear(const uint8_t color[3], int limit, uint32_t threshold, Scratch &scratch, ColorKernel kernel) const;
+
+    ThreadPool &_pool;
+    std::vector<Scratch> _scratch;
+    int _forcedBits;
+    int _bits;
+
+    std::vector<uint32_t> _start;    // histograma acumulado: início de cada balde
+    std::vector<uint32_t> _distinct; // cores distintas em cada balde
+    std::vector<uint8_t> _r, _g, _b;
+    std::vector<uint32_t> _cell;
+    Stats _stats;
+};
@@ -0,0 +1,211 @@
+#include "CounterRng.h"
+#include "CpuFeatures.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+RngKernel resolveRngKernel(RngKernel kernel)
+{
+    if (kernel == RNG_KERNEL_AUTO)
+        kernel = cpuHasAvx512() ? RNG_KERNEL_AVX512 : cpuHasAvx2() ? RNG_KERNEL_AVX2 : RNG_KERNEL_SSE2;
+    if (kernel == RNG_KERNEL_AVX512 && !cpuHasAvx512())
+        kernel = RNG_KERNEL_AVX2;
+    if (kernel == RNG_KERNEL_AVX2 && !cpuHasAvx2())
+        kernel = RNG_KERNEL_SSE2;
+    if (kernel == RNG_KERNEL_SSE2 && !cpuHasSse2())
+        kernel = RNG_KERNEL_SCALAR;
+    return kernel;
+}
+
+const char *rngKernelName(RngKernel kernel)
+{
+    switch (kernel)
+    {
+    case RNG_KERNEL_SCALAR:
+        return "escalar";
+    case RNG_KERNEL_SSE2:
+        return "sse2";
+    case RNG_KERNEL_AVX2:
+        return "avx2";
+    case RNG_KERNEL_AVX512:
+        return "avx512";
+    default:
+        return "auto";
+    }
+}
+
+RngKey rngKey(uint64_t seed)
+{
+    // SplitMix64
+    uint64_t z = seed + 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= z >> 31;
+    return {uint32_t(z), uint32_t(z >> 32)};
+}
+
+static void fillScalar(RngKey key, uint32_t first, size_t count, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t x = counterRandom(key, first + uint32_t(i));
+        r[i] = uint8_t(x);
+        g[i] = uint8_t(x >> 8);
+        b[i] = uint8_t(x >> 16);
+    }
+}
+
+#ifdef PG_X86
+// SSE2 não tem multiplicação de 32 bits por lane: duas de 64 bits (lanes pares e ímpares) e junta os resultados
+PG_TARGET("sse2") static inline __m128i mulloSse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+PG_TARGET("sse2") static inline __m128i lowbias32Sse2(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = mulloSse2(x, _mm_set1_epi32(0x7feb352d));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+    x = mulloSse2(x, _mm_set1_epi32(int(0x846ca68bu)));
+    return _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+}
+
+// Byte `shift / 8` de 16 números, em ordem
+PG_TARGET("sse2") static inline __m128i bytesSse2(const __m128i x[4], int shift)
+{
+    const __m128i low = _mm_set1_epi32(0xff);
+    __m128i x0 = _mm_and_si128(_mm_srli_epi32(x[0], shift), low);
+    __m128i x1 = _mm_and_si128(_mm_srli_epi32(x[1], shift), low);
+    __m128i x2 = _mm_and_si128(_mm_srli_epi32(x[2], shift), low);
+    __m128i x3 = _mm_and_si128(_mm_srli_epi32(x[3], shift), low);
+    return _mm_packus_epi16(_mm_packs_epi32(x0, x1), _mm_packs_epi32(x2, x3));
+}
+
+PG_TARGET("sse2") static size_t fillSse2(RngKey key, uint32_t first, size_t count, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    const __m128i k0 = _mm_set1_epi32(int(key.k0));
+    const __m128i k1 = _mm_set1_epi32(int(key.k1));
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i x[4];
+        for (int v = 0; v < 4; v++)
+        {
+            __m128i counter = _mm_add_epi32(_mm_set1_epi32(int(first + uint32_t(i) + 4 * v)), lanes);
+            x[v] = lowbias32Sse2(_mm_xor_si128(lowbias32Sse2(_mm_add_epi32(counter, k0)), k1));
+        }
+        _mm_storeu_si128((__m128i *)(r + i), bytesSse2(x, 0));
+        _mm_storeu_si128((__m128i *)(g + i), bytesSse2(x, 8));
+        _mm_storeu_si128((__m128i *)(b + i), bytesSse2(x, 16));
+    }
+    return i;
+}
+
+PG_TARGET("avx2") static inline __m256i lowbias32Avx2(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(int(0x846ca68bu)));
+    return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+}
+
+// Os packs do AVX2 trabalham em cada metade de 128 bits; os permutes recolocam os 16 bytes em ordem
+PG_TARGET("avx2") static inline __m128i bytesAvx2(__m256i x0, __m256i x1, int shift)
+{
+    const __m256i low = _mm256_set1_epi32(0xff);
+    x0 = _mm256_and_si256(_mm256_srli_epi32(x0, shift), low);
+    x1 = _mm256_and_si256(_mm256_srli_epi32(x1, shift), low);
+    __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(x0, x1), _MM_SHUFFLE(3, 1, 2, 0));
+    __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), _MM_SHUFFLE(3, 1, 2, 0));
+    return _mm256_castsi256_si128(bytes);
+}
+
+PG_TARGET("avx2") static size_t fillAvx2(RngKey key, uint32_t first, size_t count, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    const __m256i k0 = _mm256_set1_epi32(int(key.k0));
+    const __m256i k1 = _mm256_set1_epi32(int(key.k1));
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(int(first + uint32_t(i))), lanes);
+        __m256i c1 = _mm256_add_epi32(c0, _mm256_set1_epi32(8));
+        __m256i x0 = lowbias32Avx2(_mm256_xor_si256(lowbias32Avx2(_mm256_add_epi32(c0, k0)), k1));
+        __m256i x1 = lowbias32Avx2(_mm256_xor_si256(lowbias32Avx2(_mm256_add_epi32(c1, k0)), k1));
+        _mm_storeu_si128((__m128i *)(r + i), bytesAvx2(x0, x1, 0));
+        _mm_storeu_si128((__m128i *)(g + i), bytesAvx2(x0, x1, 8));
+        _mm_storeu_si128((__m128i *)(b + i), bytesAvx2(x0, x1, 16));
+    }
+    return i;
+}
+
+PG_TARGET("avx512f") static inline __m512i lowbias32Avx512(__m512i x)
+{
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+    x = _mm512_mullo_epi32(x, _mm512_set1_epi32(0x7feb352d));
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 15));
+    x = _mm512_mullo_epi32(x, _mm512_set1_epi32(int(0x846ca68bu)));
+    return _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+}
+
+// vpmovdb já trunca cada lane de 32 bits para o byte baixo
+PG_TARGET("avx512f") static size_t fillAvx512(RngKey key, uint32_t first, size_t count, uint8_t *r, uint8_t *g,
+                                              uint8_t *b)
+{
+    const __m512i k0 = _mm512_set1_epi32(int(key.k0));
+    const __m512i k1 = _mm512_set1_epi32(int(key.k1));
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512i counter = _mm512_add_epi32(_mm512_set1_epi32(int(first + uint32_t(i))), lanes);
+        __m512i x = lowbias32Avx512(_mm512_xor_si512(lowbias32Avx512(_mm512_add_epi32(counter, k0)), k1));
+        _mm_storeu_si128((__m128i *)(r + i), _mm512_cvtepi32_epi8(x));
+        _mm_storeu_si128((__m128i *)(g + i), _mm512_cvtepi32_epi8(_mm512_srli_epi32(x, 8)));
+        _mm_storeu_si128((__m128i *)(b + i), _mm512_cvtepi32_epi8(_mm512_srli_epi32(x, 16)));
+    }
+    return i;
+}
+#endif
+
+void fillRandomColors(RngKey key, uint32_t first, size_t count, uint8_t *r, uint8_t *g, uint8_t *b, RngKernel kernel)
+{
+    kernel = resolveRngKernel(kernel);
+    size_t done = 0;
+#ifdef PG_X86
+    if (kernel == RNG_KERNEL_AVX512)
+        done = fillAvx512(key, first, count, r, g, b);
+    else if (kernel == RNG_KERNEL_AVX2)
+        done = fillAvx2(key, first, count, r, g, b);
+    else if (kernel == RNG_KERNEL_SSE2)
+        done = fillSse2(key, first, count, r, g, b);
+#endif
+    // Sobra que não completa um bloco de 16
+    fillScalar(key, first + uint32_t(done), count - done, r + done, g + done, b + done);
+}
+
+uint64_t takeSeedOption(int &argc, char **argv, uint64_t fallback)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") != 0)
+            continue;
+        uint64_t seed = strtoull(argv[i + 1], nullptr, 10);
+        for (int j = i; j + 2 < argc; j++)
+            argv[j] = argv[j + 2];
+        argc -= 2;
+        return seed;
+    }
+    return fallback;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Gerador de números aleatórios por contador.
+ *
+ * O número da posição i depende só da semente e de i, sem estado entre uma
+ * chamada e outra: qualquer faixa de células pode ser sorteada em qualquer
+ * ordem, em várias threads ou em várias lanes SIMD, e o resultado é sempre o
+ * mesmo para a mesma semente.
+ *
+ * A semente passa pelo SplitMix64 uma vez e vira uma chave de 64 bits; cada
+ * número são duas rodadas do hash lowbias32 (multiplicações de 32 bits, que
+ * existem em SSE2/AVX2/AVX-512) sobre o contador misturado com a chave.
+ */
+
+enum RngKernel
+{
+    RNG_KERNEL_AUTO,
+    RNG_KERNEL_SCALAR,
+    RNG_KERNEL_SSE2,
+    RNG_KERNEL_AVX2,
+    RNG_KERNEL_AVX512
+};
+
+RngKernel resolveRngKernel(RngKernel kernel);
+const char *rngKernelName(RngKernel kernel);
+
+struct RngKey
+{
+    uint32_t k0, k1;
+};
+
+RngKey rngKey(uint64_t seed);
+
+inline uint32_t lowbias32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+inline uint32_t counterRandom(RngKey key, uint32_t counter)
+{
+    return lowbias32(lowbias32(counter + key.k0) ^ key.k1);
+}
+
+// Cores das posições [first, first + count): byte 0, 1 e 2 de counterRandom() em r[i], g[i] e b[i]
+void fillRandomColors(RngKey key, uint32_t first, size_t count, uint8_t *r, uint8_t *g, uint8_t *b,
+                      RngKernel kernel = RNG_KERNEL_AUTO);
+
+// Procura "--seed N" na linha de comando, tira os dois argumentos de argv e devolve N (ou fallback)
+uint64_t takeSeedOption(int &argc, char **argv, uint64_t fallback);
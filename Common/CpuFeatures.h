@@ -0,0 +1,116 @@
+#pragma once
+
+/*
+ * Detecção das extensões SIMD da CPU em tempo de execução.
+ *
+ * Os kernels vetorizados são compilados com PG_TARGET("avx2") etc. sem mudar
+ * as flags do projeto inteiro, e escolhidos na hora de rodar conforme o que a
+ * CPU suporta. Fora de x86 (ou em compiladores sem suporte) PG_X86 não é
+ * definido e só o caminho escalar existe.
+ */
+
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PG_X86 1
+#define PG_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define PG_X86 1
+#define PG_TARGET(isa)
+#include <intrin.h>
+#endif
+
+#ifdef PG_X86
+#include <immintrin.h>
+#endif
+
+#if defined(PG_X86) && defined(_MSC_VER)
+inline bool cpuHasLeaf7Bits(int ebxMask, bool needAvx512State)
+{
+    int regs[4];
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx)
+        return false;
+
+    // O sistema precisa salvar os registradores YMM (e ZMM para AVX-512)
+    unsigned long long xcr0 = _xgetbv(0);
+    unsigned long long state = needAvx512State ? 0xE6 : 0x06;
+    if ((xcr0 & state) != state)
+        return false;
+
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & ebxMask) == ebxMask;
+}
+#endif
+
+inline bool cpuHasSse2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true;
+#elif defined(PG_X86) && defined(__GNUC__)
+    return __builtin_cpu_supports("sse2");
+#elif defined(PG_X86)
+    int regs[4];
+    __cpuid(regs, 1);
+    return (regs[3] & (1 << 26)) != 0;
+#else
+    return false;
+#endif
+}
+
+inline bool cpuHasAvx2()
+{
+#if defined(PG_X86) && defined(__GNUC__)
+    return __builtin_cpu_supports("avx2");
+#elif defined(PG_X86)
+    return cpuHasLeaf7Bits(1 << 5, false);
+#else
+    return false;
+#endif
+}
+
+// AVX-512 F + BW (operações em bytes e palavras de 16 bits)
+inline bool cpuHasAvx512()
+{
+#if defined(PG_X86) && defined(__GNUC__)
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#elif defined(PG_X86)
+    return cpuHasLeaf7Bits((1 << 16) | (1 << 30), true);
+#else
+    return false;
+#endif
+}
+
+// Índice do bit 1 menos significativo (bits != 0) e contagem de bits 1
+inline int countTrailingZeros64(uint64_t bits)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return int(index);
+#elif defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int index = 0;
+    while (!(bits & 1))
+    {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+inline int popCount64(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(bits);
+#else
+    int count = 0;
+    for (; bits; bits &= bits - 1)
+        count++;
+    return count;
+#endif
+}
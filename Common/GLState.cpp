@@ -0,0 +1,188 @@
+#include "GLState.h"
+
+static const GLuint UNKNOWN = 0xFFFFFFFFu;
+static const int MAX_UNITS = 16;
+
+// Alvos de textura acompanhados; os outros passam direto
+static const GLenum TARGETS[] = {GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY};
+static const int TARGET_COUNT = 2;
+
+struct Shadow
+{
+    GLuint program = UNKNOWN;
+    GLuint vao = UNKNOWN;
+    GLenum activeUnit = UNKNOWN;
+    GLuint textures[MAX_UNITS][TARGET_COUNT];
+    GLuint blend = UNKNOWN;
+    GLuint depthTest = UNKNOWN;
+    GLenum blendSrc = UNKNOWN, blendDst = UNKNOWN;
+    GLenum depthFunc = UNKNOWN;
+    GLuint depthMask = UNKNOWN;
+
+    Shadow()
+    {
+        for (int u = 0; u < MAX_UNITS; u++)
+            for (int t = 0; t < TARGET_COUNT; t++)
+                textures[u][t] = UNKNOWN;
+    }
+};
+
+static Shadow shadow;
+static GLState::Stats stats;
+
+// Devolve true (e atualiza a cópia) se a chamada precisa ir para o driver
+template <typename T>
+static bool changed(T &current, T value)
+{
+    if (current == value)
+    {
+        stats.skipped++;
+        return false;
+    }
+    current = value;
+    stats.issued++;
+    return true;
+}
+
+static int targetIndex(GLenum target)
+{
+    for (int t = 0; t < TARGET_COUNT; t++)
+    {
+        if (TARGETS[t] == target)
+            return t;
+    }
+    return -1;
+}
+
+static GLuint *capability(GLenum cap)
+{
+    if (cap == GL_BLEND)
+        return &shadow.blend;
+    if (cap == GL_DEPTH_TEST)
+        return &shadow.depthTest;
+    return nullptr;
+}
+
+void GLState::useProgram(GLuint program)
+{
+    if (changed(shadow.program, program))
+        glUseProgram(program);
+}
+
+void GLState::bindVertexArray(GLuint vao)
+{
+    if (changed(shadow.vao, vao))
+        glBindVertexArray(vao);
+}
+
+void GLState::activeTexture(GLenum unit)
+{
+    if (changed(shadow.activeUnit, unit))
+        glActiveTexture(unit);
+}
+
+void GLState::bindTexture(GLenum target, GLuint texture)
+{
+    int unit = int(shadow.activeUnit - GL_TEXTURE0);
+    int t = targetIndex(target);
+    if (shadow.activeUnit == UNKNOWN || unit >= MAX_UNITS || t < 0)
+    {
+        stats.issued++;
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if (changed(shadow.textures[unit][t], texture))
+        glBindTexture(target, texture);
+}
+
+void GLState::bindTexture(GLenum unit, GLenum target, GLuint texture)
+{
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+void GLState::enable(GLenum cap)
+{
+    GLuint *current = capability(cap);
+    if (!current)
+    {
+        stats.issued++;
+        glEnable(cap);
+    }
+    else if (changed(*current, GLuint(1)))
+        glEnable(cap);
+}
+
+void GLState::disable(GLenum cap)
+{
+    GLuint *current = capability(cap);
+    if (!current)
+    {
+        stats.issued++;
+        glDisable(cap);
+    }
+    else if (changed(*current, GLuint(0)))
+        glDisable(cap);
+}
+
+void GLState::blendFunc(GLenum src, GLenum dst)
+{
+    if (shadow.blendSrc == src && shadow.blendDst == dst)
+    {
+        stats.skipped++;
+        return;
+    }
+    shadow.blendSrc = src;
+    shadow.blendDst = dst;
+    stats.issued++;
+    glBlendFunc(src, dst);
+}
+
+void GLState::depthFunc(GLenum func)
+{
+    if (changed(shadow.depthFunc, func))
+        glDepthFunc(func);
+}
+
+void GLState::depthMask(GLboolean flag)
+{
+    if (changed(shadow.depthMask, GLuint(flag)))
+        glDepthMask(flag);
+}
+
+// A GL desliga o objeto apagado de onde estiver ligado; a cópia faz o mesmo
+void GLState::deleteTexture(GLuint texture)
+{
+    for (int u = 0; u < MAX_UNITS; u++)
+    {
+        for (int t = 0; t < TARGET_COUNT; t++)
+        {
+            if (shadow.textures[u][t] == texture)
+                shadow.textures[u][t] = 0;
+        }
+    }
+    glDeleteTextures(1, &texture);
+}
+
+void GLState::deleteVertexArray(GLuint vao)
+{
+    if (shadow.vao == vao)
+        shadow.vao = 0;
+    glDeleteVertexArrays(1, &vao);
+}
+
+void GLState::invalidate()
+{
+    shadow = Shadow();
+}
+
+const GLState::Stats &GLState::frameStats()
+{
+    return stats;
+}
+
+void GLState::resetFrameStats()
+{
+    stats = Stats();
+}
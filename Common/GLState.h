@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/*
+ * GLState
+ *
+ * Cópia do estado da GL que os laços mais trocam: programa, VAO, unidade de
+ * textura ativa, textura ligada em cada unidade, blend e depth. Cada chamada
+ * compara com a cópia e só chega ao driver se o valor mudou; os contadores
+ * por frame mostram quantas chamadas foram emitidas e quantas evitadas.
+ *
+ * A cópia começa "desconhecida", então a primeira chamada de cada estado é
+ * sempre emitida. Ela só é confiável se o estado for alterado apenas por aqui:
+ * código que chama a GL direto deve chamar invalidate() depois, e objetos
+ * ligados devem ser apagados por deleteTexture()/deleteVertexArray().
+ */
+class GLState
+{
+public:
+    struct Stats
+    {
+        int issued = 0;
+        int skipped = 0;
+    };
+
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vao);
+
+    // unit é GL_TEXTURE0 + i; bindTexture liga na unidade ativa
+    static void activeTexture(GLenum unit);
+    static void bindTexture(GLenum target, GLuint texture);
+    static void bindTexture(GLenum unit, GLenum target, GLuint texture);
+
+    static void enable(GLenum cap);
+    static void disable(GLenum cap);
+    static void blendFunc(GLenum src, GLenum dst);
+    static void depthFunc(GLenum func);
+    static void depthMask(GLboolean flag);
+
+    static void deleteTexture(GLuint texture);
+    static void deleteVertexArray(GLuint vao);
+
+    // Esquece tudo: a próxima chamada de cada estado é emitida
+    static void invalidate();
+
+    static const Stats &frameStats();
+    static void resetFrameStats();
+};
@@ -0,0 +1,420 @@
+#include "MainLoop.h"
+#include "Profiler.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+static const double REPORT_INTERVAL_S = 60.0;
+
+// Mais que isso de atraso num frame (um breakpoint, a janela arrastada) é descartado em vez de simulado
+static const double MAX_FRAME_S = 0.25;
+
+static const double FRAME_LIMITS_HZ[] = {0.0, 30.0, 15.0};
+
+// Triângulo que cobre a tela, sem vértices: (-1,-1), (3,-1), (-1,3)
+static const char *repaintVertexSource = R"(
+ #version 400
+ void main()
+ {
+     vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+     gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+ }
+)";
+
+static const char *repaintFragmentSource = R"(
+ #version 400
+ uniform sampler2D frame;
+ out vec4 color;
+ void main()
+ {
+     color = texelFetch(frame, ivec2(gl_FragCoord.xy), 0);
+ }
+)";
+
+// Tempo de CPU do processo (usuário + sistema), todas as threads
+static double processCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user);
+    auto seconds = [](FILETIME t)
+    {
+        return ((uint64_t(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7;
+    };
+    return seconds(kernel) + seconds(user);
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+static MainLoop *loopOf(GLFWwindow *window)
+{
+    return static_cast<MainLoop *>(glfwGetWindowUserPointer(window));
+}
+
+MainLoop::MainLoop(GLFWwindow *window, bool idle) : _window(window), _idle(idle)
+{
+    glfwSetWindowUserPointer(window, this);
+    _prevKey = glfwSetKeyCallback(window, onKey);
+    _prevMouseButton = glfwSetMouseButtonCallback(window, onMouseButton);
+    _prevScroll = glfwSetScrollCallback(window, onScroll);
+    _prevFramebufferSize = glfwSetFramebufferSizeCallback(window, onFramebufferSize);
+    _prevRefresh = glfwSetWindowRefreshCallback(window, onRefresh);
+
+    // Ocioso: as animações andam no vsync. Contínuo: o laço antigo, sem limite
+    glfwSwapInterval(idle ? 1 : 0);
+}
+
+void MainLoop::setIdle(bool idle)
+{
+    _idle = idle;
+    _dirty = true;
+    glfwSwapInterval(idle ? 1 : 0);
+    printf("Laço %s\n", idle ? "ocioso: desenha só com eventos ou animação" : "contínuo: desenha sem parar");
+
+    _stats = Stats();
+    _reportStart_s = glfwGetTime();
+    _reportCpu_s = processCpuSeconds();
+}
+
+void MainLoop::setFrameRateLimit(double hz)
+{
+    _frameLimit_s = hz > 0.0 ? 1.0 / hz : 0.0;
+    _dirty = true;
+    if (hz > 0.0)
+        printf("Limite de %.0f frames por segundo\n", hz);
+    else
+        printf("Sem limite de frames\n");
+}
+
+void MainLoop::run(const function<void()> &frame)
+{
+    _reportStart_s = glfwGetTime();
+    _reportCpu_s = processCpuSeconds();
+
+    while (!glfwWindowShouldClose(_window))
+    {
+        if (!_idle)
+        {
+            if (throttled())
+                continue;
+            Profiler::beginFrame();
+            glfwPollEvents();
+            _lastFrame_s = glfwGetTime();
+            frame();
+            glfwSwapBuffers(_window);
+            _stats.drawn++;
+            report(glfwGetTime());
+            continue;
+        }
+
+        waitForWork();
+
+        double now_s = glfwGetTime();
+        if (_animating || (_interval_s > 0.0 && now_s - _lastFrame_s >= _interval_s))
+            _dirty = true;
+
+        if (_dirty && throttled())
+            continue;
+
+        if (_dirty)
+        {
+            // frame() pode pedir outro frame com invalidate()
+            _dirty = false;
+            Profiler::beginFrame();
+            frame();
+            keepFrame();
+            glfwSwapBuffers(_window);
+            Profiler::endFrame();
+            _lastFrame_s = now_s;
+            _exposed = false;
+            _stats.drawn++;
+        }
+        else if (_exposed)
+        {
+            _exposed = false;
+            if (repaint())
+            {
+                glfwSwapBuffers(_window);
+                _stats.repainted++;
+            }
+            else
+                _dirty = true;
+        }
+
+        report(now_s);
+    }
+
+    glDeleteFramebuffers(1, &_frameFbo);
+    glDeleteTextures(1, &_frameTex);
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteProgram(_program);
+    _frameFbo = _frameTex = _vao = _program = 0;
+    _frameValid = false;
+}
+
+void MainLoop::runFixed(double tick_s, const function<void(double)> &tick, const function<void(double)> &frame)
+{
+    double accumulator_s = 0.0;
+    double last_s = glfwGetTime();
+    bool running = false;
+
+    auto fixedFrame = [&]()
+    {
+        double now_s = glfwGetTime();
+        double elapsed_s = now_s - last_s;
+        last_s = now_s;
+
+        // Parado, o laço dormiu: quem acordou (uma tecla) vale a partir de agora
+        if (running)
+            accumulator_s += min(elapsed_s, MAX_FRAME_S);
+
+        {
+            ProfileScope cpu("update");
+            while (accumulator_s >= tick_s)
+            {
+                tick(tick_s);
+                accumulator_s -= tick_s;
+                _stats.ticks++;
+            }
+        }
+
+        frame(accumulator_s / tick_s);
+
+        // frame() decide se a animação continua
+        running = !_idle || _animating || _interval_s > 0.0;
+        if (!running)
+            accumulator_s = 0.0;
+    };
+    run(fixedFrame);
+}
+
+bool MainLoop::throttled()
+{
+    // Com limite de frames, espera o horário do próximo atendendo os eventos
+    if (_frameLimit_s <= 0.0)
+        return false;
+    double wait_s = _lastFrame_s + _frameLimit_s - glfwGetTime();
+    if (wait_s <= 0.0)
+        return false;
+    glfwWaitEventsTimeout(wait_s);
+    return true;
+}
+
+void MainLoop::waitForWork()
+{
+    if (_dirty || _exposed || _animating)
+    {
+        glfwPollEvents();
+        return;
+    }
+
+    // Dorme até um evento, o próximo tique do timer ou o próximo relatório
+    double now_s = glfwGetTime();
+    double timeout_s = _reportStart_s + REPORT_INTERVAL_S - now_s;
+    if (_interval_s > 0.0)
+        timeout_s = min(timeout_s, _lastFrame_s + _interval_s - now_s);
+
+    if (timeout_s > 0.0)
+        glfwWaitEventsTimeout(timeout_s);
+    else
+        glfwPollEvents();
+}
+
+void MainLoop::keepFrame()
+{
+    // Se outro frame já vem em seguida não vale a cópia
+    _frameValid = false;
+    if (_keepFailed || _dirty || _animating)
+        return;
+
+    int width, height;
+    glfwGetFramebufferSize(_window, &width, &height);
+    if (width == 0 || height == 0)
+        return;
+
+    GLint drawFbo, readFbo, texture;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFbo);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFbo);
+
+    bool resized = width != _frameWidth || height != _frameHeight;
+    if (resized)
+    {
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+        if (!_frameTex)
+        {
+            glGenTextures(1, &_frameTex);
+            glGenFramebuffers(1, &_frameFbo);
+        }
+        // Erros antigos não podem ser confundidos com os da alocação e da cópia
+        while (glGetError() != GL_NO_ERROR)
+        {
+        }
+
+        glBindTexture(GL_TEXTURE_2D, _frameTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        if (glGetError() != GL_NO_ERROR)
+        {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            printf("MainLoop: sem memória para a cópia do frame; exposições da janela vão redesenhar a cena\n");
+            _frameWidth = _frameHeight = 0;
+            _keepFailed = true;
+            return;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _frameFbo);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _frameTex, 0);
+        _frameWidth = width;
+        _frameHeight = height;
+    }
+
+    // Com MSAA na janela o blit também resolve as amostras
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _frameFbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFbo);
+
+    // Um formato de janela que o blit não aceita só aparece na primeira cópia
+    if (resized && glGetError() != GL_NO_ERROR)
+    {
+        printf("MainLoop: o frame não pôde ser copiado; exposições da janela vão redesenhar a cena\n");
+        _keepFailed = true;
+        return;
+    }
+    _frameValid = true;
+}
+
+bool MainLoop::repaint()
+{
+    int width, height;
+    glfwGetFramebufferSize(_window, &width, &height);
+    if (!_frameValid || width != _frameWidth || height != _frameHeight)
+        return false;
+
+    if (!_program)
+    {
+        _program = createShaderProgram(repaintVertexSource, repaintFragmentSource);
+        glGenVertexArrays(1, &_vao);
+    }
+
+    // A janela com MSAA não pode ser destino de um blit vindo de textura sem amostras, então a cópia
+    // volta por um triângulo. O estado tocado aqui é o mesmo que os exercícios e o GLState guardam
+    GLint program, vao, unit, texture, drawFbo, viewport[4];
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &unit);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFbo);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+
+    const GLenum caps[] = {GL_BLEND, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_CULL_FACE, GL_STENCIL_TEST};
+    GLboolean enabled[5];
+    for (int i = 0; i < 5; i++)
+    {
+        enabled[i] = glIsEnabled(caps[i]);
+        glDisable(caps[i]);
+    }
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+    glUseProgram(_program);
+    glBindVertexArray(_vao);
+    glBindTexture(GL_TEXTURE_2D, _frameTex);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    for (int i = 0; i < 5; i++)
+    {
+        if (enabled[i])
+            glEnable(caps[i]);
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glActiveTexture(unit);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFbo);
+    glBindVertexArray(vao);
+    glUseProgram(program);
+    return true;
+}
+
+void MainLoop::report(double now_s)
+{
+    double wall_s = now_s - _reportStart_s;
+    if (wall_s < REPORT_INTERVAL_S)
+        return;
+
+    double cpu_s = processCpuSeconds() - _reportCpu_s;
+    printf("Laço %s: %.2f s de CPU por minuto (%.1f%% de um núcleo), %d frames, %d repinturas, %d tiques\n",
+           _idle ? "ocioso" : "contínuo", cpu_s * 60.0 / wall_s, cpu_s / wall_s * 100.0, _stats.drawn, _stats.repainted,
+           _stats.ticks);
+
+    _stats = Stats();
+    _reportStart_s = now_s;
+    _reportCpu_s += cpu_s;
+}
+
+void MainLoop::onKey(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+    MainLoop *loop = loopOf(window);
+    if (loop->_prevKey)
+        loop->_prevKey(window, key, scancode, action, mods);
+
+    if (key == GLFW_KEY_F11 && action == GLFW_PRESS)
+        loop->setIdle(!loop->_idle);
+    if (key == GLFW_KEY_F10 && action == GLFW_PRESS)
+    {
+        loop->_frameLimit = (loop->_frameLimit + 1) % 3;
+        loop->setFrameRateLimit(FRAME_LIMITS_HZ[loop->_frameLimit]);
+    }
+    loop->invalidate();
+}
+
+void MainLoop::onMouseButton(GLFWwindow *window, int button, int action, int mods)
+{
+    MainLoop *loop = loopOf(window);
+    if (loop->_prevMouseButton)
+        loop->_prevMouseButton(window, button, action, mods);
+    loop->invalidate();
+}
+
+void MainLoop::onScroll(GLFWwindow *window, double dx, double dy)
+{
+    MainLoop *loop = loopOf(window);
+    if (loop->_prevScroll)
+        loop->_prevScroll(window, dx, dy);
+    loop->invalidate();
+}
+
+void MainLoop::onFramebufferSize(GLFWwindow *window, int width, int height)
+{
+    MainLoop *loop = loopOf(window);
+    if (loop->_prevFramebufferSize)
+        loop->_prevFramebufferSize(window, width, height);
+    loop->invalidate();
+}
+
+void MainLoop::onRefresh(GLFWwindow *window)
+{
+    MainLoop *loop = loopOf(window);
+    if (loop->_prevRefresh)
+        loop->_prevRefresh(window);
+    loop->_exposed = true;
+}
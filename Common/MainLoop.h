@@ -0,0 +1,117 @@
+#pragma once
+
+#include <functional>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+/*
+ * MainLoop
+ *
+ * Laço principal compartilhado pelos exercícios. No modo ocioso (o padrão)
+ * a thread dorme em glfwWaitEvents() e só desenha um frame quando algo pede:
+ *
+ *   - entrada (teclado, mouse, rolagem) ou mudança de tamanho da janela
+ *   - invalidate(), para mudanças que não vêm de eventos
+ *   - setAnimating(true): um frame por vsync enquanto durar
+ *   - setAnimationInterval(s): um frame a cada s segundos (timer de animação)
+ *
+ *   MainLoop loop(window);               depois dos glfwSet*Callback
+ *   loop.run([&]() { ...desenha... });   eventos, Profiler e swap ficam aqui
+ *
+ * Os callbacks que já estavam na janela continuam sendo chamados (o laço se
+ * encadeia na frente deles) e o ponteiro de usuário da janela passa a ser o
+ * laço. Movimento do mouse sozinho não gera frame.
+ *
+ * Cada frame desenhado é copiado para uma textura. Quando o sistema pede para
+ * repintar a janela (exposição) sem nada ter mudado, essa cópia é desenhada
+ * num triângulo de tela cheia no lugar da cena. O estado da GL tocado pela
+ * cópia e pela repintura é restaurado, então a cópia do GLState continua
+ * valendo.
+ *
+ * runFixed() separa simulação e desenho: tick(dt) roda em passos fixos de
+ * tempo real, quantos couberem no tempo desde o frame anterior, e frame(alpha)
+ * desenha interpolando entre os dois últimos estados da simulação. A
+ * velocidade do jogo deixa de depender da taxa de frames:
+ *
+ *   loop.runFixed(1.0 / 60.0, [&](double dt) { ...avança... }, [&](double alpha) { ...desenha... });
+ *
+ * A cada minuto no modo ocioso o laço imprime o tempo de CPU do processo no
+ * minuto, os frames desenhados e as repinturas. F11 alterna para o laço
+ * contínuo antigo (glfwPollEvents + frame sempre, sem vsync), para comparar, e
+ * F10 troca o limite de frames (sem limite, 30 Hz, 15 Hz).
+ */
+class MainLoop
+{
+public:
+    struct Stats
+    {
+        int drawn = 0;
+        int repainted = 0;
+        int ticks = 0;
+    };
+
+    MainLoop(GLFWwindow *window, bool idle = true);
+
+    // Roda até a janela fechar; frame() desenha no framebuffer padrão. Os objetos GL do laço
+    // são apagados na saída, antes do glfwTerminate
+    void run(const std::function<void()> &frame);
+
+    // Simulação em tiques de tick_s segundos; alpha em [0, 1) é a fração do próximo tique já passada.
+    // O tempo em que o laço dormiu sem animação não conta: a simulação estava parada
+    void runFixed(double tick_s, const std::function<void(double)> &tick, const std::function<void(double)> &frame);
+
+    void invalidate() { _dirty = true; }
+    void setAnimating(bool animating) { _animating = animating; }
+    void setAnimationInterval(double interval_s) { _interval_s = interval_s; }
+
+    // No máximo hz frames por segundo nos dois modos; 0 tira o limite
+    void setFrameRateLimit(double hz);
+
+    void setIdle(bool idle);
+    bool idle() const { return _idle; }
+
+    // Contagem desde o último relatório de CPU
+    const Stats &stats() const { return _stats; }
+
+private:
+    static void onKey(GLFWwindow *window, int key, int scancode, int action, int mods);
+    static void onMouseButton(GLFWwindow *window, int button, int action, int mods);
+    static void onScroll(GLFWwindow *window, double dx, double dy);
+    static void onFramebufferSize(GLFWwindow *window, int width, int height);
+    static void onRefresh(GLFWwindow *window);
+
+    void waitForWork();
+    bool throttled();
+    void keepFrame();
+    bool repaint();
+    void report(double now_s);
+
+    GLFWwindow *_window;
+    bool _idle;
+    bool _dirty = true;
+    bool _exposed = false;
+    bool _animating = false;
+    double _interval_s = 0.0;
+    double _lastFrame_s = 0.0;
+    double _frameLimit_s = 0.0;
+    int _frameLimit = 0; // índice do F10
+
+    // Último frame, para as repinturas
+    GLuint _frameFbo = 0;
+    GLuint _frameTex = 0;
+    GLuint _program = 0;
+    GLuint _vao = 0;
+    int _frameWidth = 0, _frameHeight = 0;
+    bool _frameValid = false;
+    bool _keepFailed = false;
+
+    Stats _stats;
+    double _reportStart_s = 0.0;
+    double _reportCpu_s = 0.0;
+
+    GLFWkeyfun _prevKey;
+    GLFWmousebuttonfun _prevMouseButton;
+    GLFWscrollfun _prevScroll;
+    GLFWframebuffersizefun _prevFramebufferSize;
+    GLFWwindowrefreshfun _prevRefresh;
+};
@@ -0,0 +1,359 @@
+#include "MipChain.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+
+using namespace std;
+
+int mipLevelCount(int width, int height)
+{
+    int levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = max(1, width / 2);
+        height = max(1, height / 2);
+        levels++;
+    }
+    return levels;
+}
+
+MipKernel resolveMipKernel(MipKernel kernel)
+{
+    if (kernel == MIP_KERNEL_AUTO)
+        kernel = cpuHasAvx2() ? MIP_KERNEL_AVX2 : MIP_KERNEL_SSE2;
+    if (kernel == MIP_KERNEL_AVX2 && !cpuHasAvx2())
+        kernel = MIP_KERNEL_SSE2;
+    if (kernel == MIP_KERNEL_SSE2 && !cpuHasSse2())
+        kernel = MIP_KERNEL_SCALAR;
+    return kernel;
+}
+
+const char *mipFilterName(MipFilter filter)
+{
+    return filter == MIP_FILTER_TENT ? "tent" : "box";
+}
+
+const char *mipKernelName(MipKernel kernel)
+{
+    switch (kernel)
+    {
+    case MIP_KERNEL_SCALAR:
+        return "escalar";
+    case MIP_KERNEL_SSE2:
+        return "sse2";
+    case MIP_KERNEL_AVX2:
+        return "avx2";
+    default:
+        return "auto";
+    }
+}
+
+// ---- Box 2x2 ----
+
+// Pixels [x, dstWidth) de uma linha do destino, a partir das duas linhas da origem
+static void boxRowScalar(const uint8_t *row0, const uint8_t *row1, int srcWidth, uint8_t *out, int x, int dstWidth)
+{
+    for (; x < dstWidth; x++)
+    {
+        int x0 = min(x * 2, srcWidth - 1) * 4;
+        int x1 = min(x * 2 + 1, srcWidth - 1) * 4;
+        for (int c = 0; c < 4; c++)
+        {
+            int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+            out[x * 4 + c] = uint8_t((sum + 2) >> 2);
+        }
+    }
+}
+
+#ifdef PG_X86
+// 4 pixels do destino por iteração; devolve onde parou
+PG_TARGET("sse2") static int boxRowSse2(const uint8_t *row0, const uint8_t *row1, uint8_t *out, int dstWidth)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 4 <= dstWidth; x += 4)
+    {
+        __m128i a0 = _mm_loadu_si128((const __m128i *)(row0 + x * 8));
+        __m128i b0 = _mm_loadu_si128((const __m128i *)(row0 + x * 8 + 16));
+        __m128i a1 = _mm_loadu_si128((const __m128i *)(row1 + x * 8));
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(row1 + x * 8 + 16));
+
+        // Soma vertical em 16 bits, dois pixels por registrador
+        __m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(a1, zero));
+        __m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(a1, zero));
+        __m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(b0, zero), _mm_unpacklo_epi8(b1, zero));
+        __m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(b0, zero), _mm_unpackhi_epi8(b1, zero));
+
+        // Soma horizontal de cada par: metade baixa + metade alta
+        s01 = _mm_add_epi16(s01, _mm_srli_si128(s01, 8));
+        s23 = _mm_add_epi16(s23, _mm_srli_si128(s23, 8));
+        s45 = _mm_add_epi16(s45, _mm_srli_si128(s45, 8));
+        s67 = _mm_add_epi16(s67, _mm_srli_si128(s67, 8));
+
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s01, s23), two), 2);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s45, s67), two), 2);
+        _mm_storeu_si128((__m128i *)(out + x * 4), _mm_packus_epi16(lo, hi));
+    }
+    return x;
+}
+
+// Mesma ideia com 8 pixels por iteração; as operações trabalham em cada metade de 128 bits
+PG_TARGET("avx2") static int boxRowAvx2(const uint8_t *row0, const uint8_t *row1, uint8_t *out, int dstWidth)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i two = _mm256_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 8 <= dstWidth; x += 8)
+    {
+        __m256i a0 = _mm256_loadu_si256((const __m256i *)(row0 + x * 8));
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)(row0 + x * 8 + 32));
+        __m256i a1 = _mm256_loadu_si256((const __m256i *)(row1 + x * 8));
+        __m256i b1 = _mm256_loadu_si256((const __m256i *)(row1 + x * 8 + 32));
+
+        __m256i aLo = _mm256_add_epi16(_mm256_unpacklo_epi8(a0, zero), _mm256_unpacklo_epi8(a1, zero));
+        __m256i aHi = _mm256_add_epi16(_mm256_unpackhi_epi8(a0, zero), _mm256_unpackhi_epi8(a1, zero));
+        __m256i bLo = _mm256_add_epi16(_mm256_unpacklo_epi8(b0, zero), _mm256_unpacklo_epi8(b1, zero));
+        __m256i bHi = _mm256_add_epi16(_mm256_unpackhi_epi8(b0, zero), _mm256_unpackhi_epi8(b1, zero));
+
+        aLo = _mm256_add_epi16(aLo, _mm256_srli_si256(aLo, 8));
+        aHi = _mm256_add_epi16(aHi, _mm256_srli_si256(aHi, 8));
+        bLo = _mm256_add_epi16(bLo, _mm256_srli_si256(bLo, 8));
+        bHi = _mm256_add_epi16(bHi, _mm256_srli_si256(bHi, 8));
+
+        // a = pixels 0,1 | 2,3 e b = 4,5 | 6,7; o pack intercala as metades e o permute desfaz
+        __m256i a = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(aLo, aHi), two), 2);
+        __m256i b = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(bLo, bHi), two), 2);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)(out + x * 4), packed);
+    }
+    return x;
+}
+#endif
+
+void downsampleBox(const uint8_t *src, int srcWidth, int srcHeight, uint8_t *dst, MipKernel kernel)
+{
+    kernel = resolveMipKernel(kernel);
+    int dstWidth = max(1, srcWidth / 2);
+    int dstHeight = max(1, srcHeight / 2);
+
+    for (int y = 0; y < dstHeight; y++)
+    {
+        const uint8_t *row0 = src + size_t(min(y * 2, srcHeight - 1)) * srcWidth * 4;
+        const uint8_t *row1 = src + size_t(min(y * 2 + 1, srcHeight - 1)) * srcWidth * 4;
+        uint8_t *out = dst + size_t(y) * dstWidth * 4;
+
+        int x = 0;
+#ifdef PG_X86
+        if (kernel == MIP_KERNEL_AVX2)
+            x = boxRowAvx2(row0, row1, out, dstWidth);
+        else if (kernel == MIP_KERNEL_SSE2)
+            x = boxRowSse2(row0, row1, out, dstWidth);
+#endif
+        boxRowScalar(row0, row1, srcWidth, out, x, dstWidth);
+    }
+}
+
+// ---- Tent [1 3 3 1]/8 ----
+//
+// Passada horizontal: cada linha da origem vira uma linha de dstWidth pixels em
+// 16 bits, ainda multiplicada por 8. Passada vertical: combina 4 dessas linhas e
+// divide por 64 com arredondamento. O pixel x do destino usa os texels
+// 2x-1 .. 2x+2 da origem, repetindo a borda.
+
+static void tentRowScalar(const uint8_t *row, int srcWidth, uint16_t *out, int x, int dstWidth)
+{
+    for (; x < dstWidth; x++)
+    {
+        int i0 = min(max(x * 2 - 1, 0), srcWidth - 1) * 4;
+        int i1 = min(x * 2, srcWidth - 1) * 4;
+        int i2 = min(x * 2 + 1, srcWidth - 1) * 4;
+        int i3 = min(x * 2 + 2, srcWidth - 1) * 4;
+        for (int c = 0; c < 4; c++)
+            out[x * 4 + c] = uint16_t(row[i0 + c] + 3 * (row[i1 + c] + row[i2 + c]) + row[i3 + c]);
+    }
+}
+
+static void tentColumnScalar(const uint16_t *const rows[4], uint8_t *out, int i, int count)
+{
+    for (; i < count; i++)
+        out[i] = uint8_t((rows[0][i] + 3 * (rows[1][i] + rows[2][i]) + rows[3][i] + 32) >> 6);
+}
+
+#ifdef PG_X86
+// Começa em x = 1 (o pixel 0 precisa da borda) e para antes dos pixels que leem além da linha
+PG_TARGET("sse2") static int tentRowSse2(const uint8_t *row, int srcWidth, uint16_t *out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    // Quatro texels a b c d: (a, b) * (1, 3) + (c, d) * (3, 1)
+    const __m128i weightsLo = _mm_setr_epi16(1, 1, 1, 1, 3, 3, 3, 3);
+    const __m128i weightsHi = _mm_setr_epi16(3, 3, 3, 3, 1, 1, 1, 1);
+
+    int x = 1;
+    for (; x * 2 + 4 < srcWidth; x += 2)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i *)(row + (x * 2 - 1) * 4));
+        __m128i q = _mm_loadu_si128((const __m128i *)(row + (x * 2 + 1) * 4));
+
+        __m128i sp = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), weightsLo),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), weightsHi));
+        __m128i sq = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(q, zero), weightsLo),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(q, zero), weightsHi));
+        sp = _mm_add_epi16(sp, _mm_srli_si128(sp, 8));
+        sq = _mm_add_epi16(sq, _mm_srli_si128(sq, 8));
+
+        _mm_storeu_si128((__m128i *)(out + x * 4), _mm_unpacklo_epi64(sp, sq));
+    }
+    return x;
+}
+
+PG_TARGET("sse2") static int tentColumnSse2(const uint16_t *const rows[4], uint8_t *out, int count)
+{
+    const __m128i three = _mm_set1_epi16(3);
+    const __m128i half = _mm_set1_epi16(32);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v[2];
+        for (int k = 0; k < 2; k++)
+        {
+            __m128i r0 = _mm_loadu_si128((const __m128i *)(rows[0] + i + k * 8));
+            __m128i r1 = _mm_loadu_si128((const __m128i *)(rows[1] + i + k * 8));
+            __m128i r2 = _mm_loadu_si128((const __m128i *)(rows[2] + i + k * 8));
+            __m128i r3 = _mm_loadu_si128((const __m128i *)(rows[3] + i + k * 8));
+            __m128i sum = _mm_add_epi16(_mm_add_epi16(r0, r3), _mm_mullo_epi16(_mm_add_epi16(r1, r2), three));
+            v[k] = _mm_srli_epi16(_mm_add_epi16(sum, half), 6);
+        }
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(v[0], v[1]));
+    }
+    return i;
+}
+
+// Uma leitura de 8 texels a partir de 2x-1 já cobre os pixels x e x+2 (uma metade cada)
+PG_TARGET("avx2") static int tentRowAvx2(const uint8_t *row, int srcWidth, uint16_t *out)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i weightsLo = _mm256_setr_epi16(1, 1, 1, 1, 3, 3, 3, 3, 1, 1, 1, 1, 3, 3, 3, 3);
+    const __m256i weightsHi = _mm256_setr_epi16(3, 3, 3, 3, 1, 1, 1, 1, 3, 3, 3, 3, 1, 1, 1, 1);
+
+    int x = 1;
+    for (; x * 2 + 8 < srcWidth; x += 4)
+    {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(row + (x * 2 - 1) * 4));
+        __m256i q = _mm256_loadu_si256((const __m256i *)(row + (x * 2 + 1) * 4));
+
+        __m256i sp = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(p, zero), weightsLo),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(p, zero), weightsHi));
+        __m256i sq = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(q, zero), weightsLo),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(q, zero), weightsHi));
+        sp = _mm256_add_epi16(sp, _mm256_srli_si256(sp, 8));
+        sq = _mm256_add_epi16(sq, _mm256_srli_si256(sq, 8));
+
+        // sp = x | x+2 e sq = x+1 | x+3, então o unpack já sai na ordem
+        _mm256_storeu_si256((__m256i *)(out + x * 4), _mm256_unpacklo_epi64(sp, sq));
+    }
+    return x;
+}
+
+PG_TARGET("avx2") static int tentColumnAvx2(const uint16_t *const rows[4], uint8_t *out, int count)
+{
+    const __m256i three = _mm256_set1_epi16(3);
+    const __m256i half = _mm256_set1_epi16(32);
+
+    int i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i v[2];
+        for (int k = 0; k < 2; k++)
+        {
+            __m256i r0 = _mm256_loadu_si256((const __m256i *)(rows[0] + i + k * 16));
+            __m256i r1 = _mm256_loadu_si256((const __m256i *)(rows[1] + i + k * 16));
+            __m256i r2 = _mm256_loadu_si256((const __m256i *)(rows[2] + i + k * 16));
+            __m256i r3 = _mm256_loadu_si256((const __m256i *)(rows[3] + i + k * 16));
+            __m256i sum = _mm256_add_epi16(_mm256_add_epi16(r0, r3), _mm256_mullo_epi16(_mm256_add_epi16(r1, r2), three));
+            v[k] = _mm256_srli_epi16(_mm256_add_epi16(sum, half), 6);
+        }
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(v[0], v[1]), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)(out + i), packed);
+    }
+    return i;
+}
+#endif
+
+static void tentRow(const uint8_t *row, int srcWidth, uint16_t *out, int dstWidth, MipKernel kernel)
+{
+    tentRowScalar(row, srcWidth, out, 0, 1);
+
+    int x = 1;
+#ifdef PG_X86
+    if (kernel == MIP_KERNEL_AVX2)
+        x = tentRowAvx2(row, srcWidth, out);
+    else if (kernel == MIP_KERNEL_SSE2)
+        x = tentRowSse2(row, srcWidth, out);
+#endif
+    tentRowScalar(row, srcWidth, out, x, dstWidth);
+}
+
+static void tentColumn(const uint16_t *const rows[4], uint8_t *out, int count, MipKernel kernel)
+{
+    int i = 0;
+#ifdef PG_X86
+    if (kernel == MIP_KERNEL_AVX2)
+        i = tentColumnAvx2(rows, out, count);
+    else if (kernel == MIP_KERNEL_SSE2)
+        i = tentColumnSse2(rows, out, count);
+#endif
+    tentColumnScalar(rows, out, i, count);
+}
+
+void downsampleTent(const uint8_t *src, int srcWidth, int srcHeight, uint8_t *dst, MipKernel kernel)
+{
+    kernel = resolveMipKernel(kernel);
+    int dstWidth = max(1, srcWidth / 2);
+    int dstHeight = max(1, srcHeight / 2);
+    int rowLength = dstWidth * 4;
+
+    // Anel com as últimas 4 linhas filtradas na horizontal: cada linha da origem serve a duas do destino
+    vector<uint16_t> filtered(size_t(rowLength) * 4);
+    int cachedRow[4] = {-1, -1, -1, -1};
+
+    for (int y = 0; y < dstHeight; y++)
+    {
+        const uint16_t *rows[4];
+        for (int t = 0; t < 4; t++)
+        {
+            int sy = min(max(y * 2 - 1 + t, 0), srcHeight - 1);
+            uint16_t *row = filtered.data() + size_t(sy & 3) * rowLength;
+            if (cachedRow[sy & 3] != sy)
+            {
+                tentRow(src + size_t(sy) * srcWidth * 4, srcWidth, row, dstWidth, kernel);
+                cachedRow[sy & 3] = sy;
+            }
+            rows[t] = row;
+        }
+        tentColumn(rows, dst + size_t(y) * rowLength, rowLength, kernel);
+    }
+}
+
+vector<vector<uint8_t>> buildMipChain(const uint8_t *rgba, int width, int height, MipFilter filter, MipKernel kernel)
+{
+    kernel = resolveMipKernel(kernel);
+    int count = mipLevelCount(width, height);
+    vector<vector<uint8_t>> levels(count);
+    levels[0].assign(rgba, rgba + size_t(width) * height * 4);
+
+    for (int i = 1; i < count; i++)
+    {
+        int w = max(1, width >> (i - 1));
+        int h = max(1, height >> (i - 1));
+        levels[i].resize(size_t(max(1, w / 2)) * max(1, h / 2) * 4);
+        if (filter == MIP_FILTER_TENT)
+            downsampleTent(levels[i - 1].data(), w, h, levels[i].data(), kernel);
+        else
+            downsampleBox(levels[i - 1].data(), w, h, levels[i].data(), kernel);
+    }
+    return levels;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Geração de mipmaps na CPU para imagens RGBA8.
+ *
+ * Cada nível tem metade da largura e altura do anterior (arredondando para
+ * baixo, mínimo 1), como no glGenerateMipmap. Em dimensões ímpares o último
+ * texel da linha/coluna fica de fora do nível seguinte; só um eixo de tamanho
+ * 1 repete o seu texel, e o tent repete o da borda nos taps que passam dela.
+ *
+ * Há dois filtros:
+ *   MIP_FILTER_BOX   média 2x2, o mesmo resultado do glGenerateMipmap
+ *   MIP_FILTER_TENT  filtro separável [1 3 3 1]/8 em cada eixo (4x4 texels),
+ *                    mais suave e com menos serrilhado nos níveis pequenos
+ *
+ * Cada filtro tem um kernel escalar e versões SSE2 e AVX2, escolhidas em tempo
+ * de execução (MIP_KERNEL_AUTO). Todos os kernels usam só aritmética inteira e
+ * geram exatamente os mesmos bytes.
+ */
+
+enum MipFilter
+{
+    MIP_FILTER_BOX = 0,
+    MIP_FILTER_TENT = 1
+};
+
+enum MipKernel
+{
+    MIP_KERNEL_AUTO,
+    MIP_KERNEL_SCALAR,
+    MIP_KERNEL_SSE2,
+    MIP_KERNEL_AVX2
+};
+
+int mipLevelCount(int width, int height);
+
+// Kernel que será usado de fato: AUTO vira o melhor disponível e kernels sem suporte na CPU caem para o escalar
+MipKernel resolveMipKernel(MipKernel kernel);
+
+const char *mipFilterName(MipFilter filter);
+const char *mipKernelName(MipKernel kernel);
+
+void downsampleBox(const uint8_t *src, int srcWidth, int srcHeight, uint8_t *dst, MipKernel kernel = MIP_KERNEL_AUTO);
+void downsampleTent(const uint8_t *src, int srcWidth, int srcHeight, uint8_t *dst, MipKernel kernel = MIP_KERNEL_AUTO);
+
+// levels[0] é uma cópia da imagem original
+std::vector<std::vector<uint8_t>> buildMipChain(const uint8_t *rgba, int width, int height,
+                                                MipFilter filter = MIP_FILTER_BOX, MipKernel kernel = MIP_KERNEL_AUTO);
@@ -0,0 +1,346 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+using namespace std;
+
+static const double BUCKET_MS = 0.05;
+static const int BUCKETS = 2000; // até 100 ms; acima disso vai para o último balde
+static const size_t TRACE_CAPACITY = 1 << 18;
+
+enum Track
+{
+    TRACK_FRAME = 1,
+    TRACK_CPU = 2,
+    TRACK_GPU = 3,
+    TRACK_COUNTER = 4 // duration_s guarda o valor
+};
+
+struct TraceEvent
+{
+    const char *name;
+    double start_s;
+    double duration_s;
+    int track;
+};
+
+struct GpuQuery
+{
+    GLuint id;
+    const char *name;
+    double start_s;
+};
+
+struct GpuTiming
+{
+    const char *name;
+    double ms;
+};
+
+struct CounterValue
+{
+    const char *name;
+    double value;
+};
+
+static string traceName = "profiler";
+static double frameStart_s = -1.0;
+
+static float history[PROFILER_HISTORY];
+static int historyHead = 0, historyCount = 0;
+static int histogram[BUCKETS + 1];
+
+static vector<TraceEvent> events;
+static size_t eventHead = 0;
+
+static vector<GLuint> freeQueries;
+static deque<GpuQuery> pendingQueries;
+static GpuQuery activeQuery;
+static bool gpuBusy = false;
+static vector<GpuTiming> gpuTimings;
+static vector<CounterValue> counters;
+
+static void push(const char *name, double start_s, double duration_s, int track)
+{
+    if (events.size() < TRACE_CAPACITY)
+    {
+        events.push_back({name, start_s, duration_s, track});
+        return;
+    }
+    // Buffer cheio: sobrescreve o evento mais antigo
+    events[eventHead] = {name, start_s, duration_s, track};
+    eventHead = (eventHead + 1) % TRACE_CAPACITY;
+}
+
+static int bucket(float ms)
+{
+    return min(int(ms / BUCKET_MS), BUCKETS);
+}
+
+static void addFrame(float ms)
+{
+    if (historyCount == PROFILER_HISTORY)
+        histogram[bucket(history[historyHead])]--;
+    else
+        historyCount++;
+
+    history[historyHead] = ms;
+    histogram[bucket(ms)]++;
+    historyHead = (historyHead + 1) % PROFILER_HISTORY;
+}
+
+// Lê os resultados de GPU que já chegaram, sem bloquear
+static void pollGpu(bool wait)
+{
+    while (!pendingQueries.empty())
+    {
+        GpuQuery query = pendingQueries.front();
+        if (!wait)
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+        }
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &ns);
+        push(query.name, query.start_s, ns * 1e-9, TRACK_GPU);
+
+        auto timing = find_if(gpuTimings.begin(), gpuTimings.end(), [&](const GpuTiming &t)
+                              { return strcmp(t.name, query.name) == 0; });
+        if (timing == gpuTimings.end())
+            gpuTimings.push_back({query.name, ns * 1e-6});
+        else
+            timing->ms = ns * 1e-6;
+
+        freeQueries.push_back(query.id);
+        pendingQueries.pop_front();
+    }
+}
+
+void Profiler::init(const string &name)
+{
+    traceName = name;
+    frameStart_s = -1.0;
+    events.reserve(TRACE_CAPACITY);
+}
+
+void Profiler::beginFrame()
+{
+    double now_s = glfwGetTime();
+    if (frameStart_s >= 0.0)
+    {
+        double duration_s = now_s - frameStart_s;
+        addFrame(float(duration_s * 1000.0));
+        push("frame", frameStart_s, duration_s, TRACK_FRAME);
+    }
+    frameStart_s = now_s;
+    pollGpu(false);
+}
+
+void Profiler::endFrame()
+{
+    if (frameStart_s < 0.0)
+        return;
+    double duration_s = glfwGetTime() - frameStart_s;
+    addFrame(float(duration_s * 1000.0));
+    push("frame", frameStart_s, duration_s, TRACK_FRAME);
+    frameStart_s = -1.0;
+}
+
+Profiler::Percentiles Profiler::frameTimes()
+{
+    Percentiles result;
+    result.samples = historyCount;
+    if (historyCount == 0)
+        return result;
+
+    result.max = *max_element(history, history + historyCount);
+
+    double *targets[] = {&result.p50, &result.p95, &result.p99};
+    const double ranks[] = {0.50, 0.95, 0.99};
+    int next = 0, seen = 0;
+    for (int b = 0; b <= BUCKETS && next < 3; b++)
+    {
+        seen += histogram[b];
+        while (next < 3 && seen >= int(ceil(ranks[next] * historyCount)))
+        {
+            // Centro do balde, limitado pelo máximo exato
+            *targets[next] = min((b + 0.5) * BUCKET_MS, result.max);
+            next++;
+        }
+    }
+    return result;
+}
+
+const char *Profiler::frameSummary()
+{
+    static char text[96];
+    Percentiles p = frameTimes();
+    snprintf(text, sizeof(text), "p50 %.2f p95 %.2f p99 %.2f max %.2f ms", p.p50, p.p95, p.p99, p.max);
+    return text;
+}
+
+double Profiler::gpuMs(const char *name)
+{
+    for (const GpuTiming &timing : gpuTimings)
+    {
+        if (strcmp(timing.name, name) == 0)
+            return timing.ms;
+    }
+    return 0.0;
+}
+
+void Profiler::counter(const char *name, double value)
+{
+    push(name, glfwGetTime(), value, TRACK_COUNTER);
+
+    auto current = find_if(counters.begin(), counters.end(), [&](const CounterValue &c)
+                           { return strcmp(c.name, name) == 0; });
+    if (current == counters.end())
+        counters.push_back({name, value});
+    else
+        current->value = value;
+}
+
+double Profiler::counterValue(const char *name)
+{
+    for (const CounterValue &current : counters)
+    {
+        if (strcmp(current.name, name) == 0)
+            return current.value;
+    }
+    return 0.0;
+}
+
+void Profiler::record(const char *name, double start_s, double duration_s)
+{
+    push(name, start_s, duration_s, TRACK_CPU);
+}
+
+int Profiler::beginGpu(const char *name)
+{
+    if (gpuBusy)
+        return -1;
+
+    GLuint id;
+    if (freeQueries.empty())
+        glGenQueries(1, &id);
+    else
+    {
+        id = freeQueries.back();
+        freeQueries.pop_back();
+    }
+
+    gpuBusy = true;
+    activeQuery = {id, name, glfwGetTime()};
+    glBeginQuery(GL_TIME_ELAPSED, id);
+    return int(id);
+}
+
+void Profiler::endGpu(int query)
+{
+    if (query < 0)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    gpuBusy = false;
+    pendingQueries.push_back(activeQuery);
+}
+
+void Profiler::handleKey(int key, int action)
+{
+    if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+        saveTrace();
+}
+
+static void writeString(ofstream &file, const char *text)
+{
+    file << '"';
+    for (const char *c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            file << '\\';
+        file << *c;
+    }
+    file << '"';
+}
+
+bool Profiler::saveTrace()
+{
+    string path = "trace_" + traceName + ".json";
+    ofstream file(path, ios::trunc);
+    if (!file)
+    {
+        cerr << "Falha ao gravar " << path << endl;
+        return false;
+    }
+
+    const char *tracks[] = {"", "frames", "cpu", "gpu"};
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (int t = TRACK_FRAME; t <= TRACK_GPU; t++)
+    {
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":\"" << tracks[t]
+             << "\"}},\n";
+    }
+
+    char line[128];
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const TraceEvent &event = events[(eventHead + i) % events.size()];
+        file << "{\"name\":";
+        writeString(file, event.name);
+        if (event.track == TRACK_COUNTER)
+            snprintf(line, sizeof(line), ",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                     event.start_s * 1e6, event.duration_s);
+        else
+            snprintf(line, sizeof(line), ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", event.track,
+                     event.start_s * 1e6, event.duration_s * 1e6);
+        file << line << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+
+    printf("Trace gravado em %s (%zu eventos; frames %s)\n", path.c_str(), events.size(), frameSummary());
+    return bool(file);
+}
+
+void Profiler::shutdown()
+{
+    glFinish();
+    pollGpu(true);
+    saveTrace();
+
+    for (GLuint id : freeQueries)
+        glDeleteQueries(1, &id);
+    freeQueries.clear();
+}
+
+ProfileScope::ProfileScope(const char *name)
+    : _name(name), _start_s(glfwGetTime())
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+    Profiler::record(_name, _start_s, glfwGetTime() - _start_s);
+}
+
+GpuProfileScope::GpuProfileScope(const char *name)
+    : _query(Profiler::beginGpu(name))
+{
+}
+
+GpuProfileScope::~GpuProfileScope()
+{
+    Profiler::endGpu(_query);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+
+/*
+ * Profiler
+ *
+ * Tempo de frame, trechos de CPU e trechos de GPU de um executável.
+ *
+ *   Profiler::init("Parallax");          depois de criar o contexto
+ *   Profiler::beginFrame();              no topo do laço principal
+ *   Profiler::endFrame();                opcional: fecha o frame sem abrir outro
+ *   { ProfileScope scope("update"); }    trecho de CPU até o fim do bloco
+ *   { GpuProfileScope gpu("draw"); }     trecho de GPU (GL_TIME_ELAPSED)
+ *   Profiler::counter("pixels", n);      valor de um contador neste instante
+ *   Profiler::handleKey(key, action);    no key_callback: F12 grava o trace
+ *   Profiler::shutdown();                antes do glfwTerminate: grava o trace
+ *
+ * Os tempos de frame dos últimos PROFILER_HISTORY frames ficam em um
+ * histograma com baldes de 0,05 ms, de onde saem p50/p95/p99; o máximo é
+ * exato. Os trechos vão para um buffer circular e são gravados em
+ * trace_<nome>.json no formato de eventos do Chrome (chrome://tracing ou
+ * ui.perfetto.dev), com uma trilha para frames, uma para CPU e uma para GPU,
+ * e os contadores como gráficos.
+ *
+ * As consultas de GPU não podem ser aninhadas (limite do GL_TIME_ELAPSED):
+ * um GpuProfileScope aberto dentro de outro é ignorado. Os resultados são
+ * lidos sem esperar a GPU, alguns frames depois, e aparecem no trace no
+ * instante em que os comandos foram enviados. Os nomes precisam ser literais.
+ */
+
+const int PROFILER_HISTORY = 600;
+
+class Profiler
+{
+public:
+    struct Percentiles
+    {
+        double p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+        int samples = 0;
+    };
+
+    static void init(const std::string &name);
+    static void beginFrame();
+    // Para laços que dormem entre frames (MainLoop): a espera até o próximo beginFrame() não conta
+    static void endFrame();
+
+    static Percentiles frameTimes();
+    // "p50 1.02 p95 1.80 p99 3.10 max 7.95 ms", para o título da janela
+    static const char *frameSummary();
+
+    // Último tempo medido de um trecho de GPU, em ms (0 se ainda não houver)
+    static double gpuMs(const char *name);
+
+    // O nome é guardado como ponteiro (precisa durar até o fim), mas as buscas comparam o texto
+    static void counter(const char *name, double value);
+    // Último valor do contador (0 se ainda não houver)
+    static double counterValue(const char *name);
+
+    static void handleKey(int key, int action);
+    static bool saveTrace();
+    static void shutdown();
+
+    // Usados pelos escopos abaixo
+    static void record(const char *name, double start_s, double duration_s);
+    static int beginGpu(const char *name); // -1 se já houver uma consulta aberta
+    static void endGpu(int query);
+};
+
+class ProfileScope
+{
+public:
+    ProfileScope(const char *name);
+    ~ProfileScope();
+
+private:
+    const char *_name;
+    double _start_s;
+};
+
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(const char *name);
+    ~GpuProfileScope();
+
+private:
+    int _query;
+};
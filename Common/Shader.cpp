@@ -0,0 +1,251 @@
+#include "Shader.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <GLFW/glfw3.h>
+
+using namespace std;
+
+// ARB_get_program_binary é core no 4.1, mas a GLAD do projeto foi gerada para 4.0
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+
+typedef void(APIENTRYP PFNGETPROGRAMBINARY)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void(APIENTRYP PFNPROGRAMBINARY)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void(APIENTRYP PFNPROGRAMPARAMETERI)(GLuint program, GLenum pname, GLint value);
+
+static PFNGETPROGRAMBINARY pGetProgramBinary = nullptr;
+static PFNPROGRAMBINARY pProgramBinary = nullptr;
+static PFNPROGRAMPARAMETERI pProgramParameteri = nullptr;
+
+static ShaderCacheStats cacheStats;
+
+static const char *CACHE_DIR = "shader_cache";
+static const uint32_t CACHE_MAGIC = 0x42534750; // "PGSB"
+static const uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t length;
+};
+
+static bool cacheAvailable()
+{
+    static int available = -1;
+    if (available >= 0)
+        return available == 1;
+
+    available = 0;
+    if (getenv("PGCCHIB_NO_SHADER_CACHE"))
+        return false;
+
+    pGetProgramBinary = (PFNGETPROGRAMBINARY)glfwGetProcAddress("glGetProgramBinary");
+    pProgramBinary = (PFNPROGRAMBINARY)glfwGetProcAddress("glProgramBinary");
+    pProgramParameteri = (PFNPROGRAMPARAMETERI)glfwGetProcAddress("glProgramParameteri");
+    if (!pGetProgramBinary || !pProgramBinary || !pProgramParameteri)
+        return false;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0)
+        return false;
+
+    available = 1;
+    return true;
+}
+
+static uint64_t fnv1a(uint64_t hash, const char *data)
+{
+    if (!data)
+        data = "";
+    for (; *data; data++)
+        hash = (hash ^ uint8_t(*data)) * 1099511628211ull;
+    // Separador para "ab" + "c" não colidir com "a" + "bc"
+    return (hash ^ 0xff) * 1099511628211ull;
+}
+
+static string cachePath(const char *vertexSource, const char *fragmentSource, const char *defines)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = fnv1a(hash, vertexSource);
+    hash = fnv1a(hash, fragmentSource);
+    hash = fnv1a(hash, defines);
+    hash = fnv1a(hash, (const char *)glGetString(GL_VENDOR));
+    hash = fnv1a(hash, (const char *)glGetString(GL_RENDERER));
+    hash = fnv1a(hash, (const char *)glGetString(GL_VERSION));
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s/%016llx.bin", CACHE_DIR, (unsigned long long)hash);
+    return name;
+}
+
+static bool loadBinary(GLuint program, const string &path)
+{
+    ifstream file(path, ios::binary | ios::ate);
+    if (!file)
+        return false;
+    uint64_t fileSize = uint64_t(file.tellg());
+    file.seekg(0);
+
+    CacheHeader header;
+    if (!file.read((char *)&header, sizeof(header)) || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION)
+        return false;
+
+    // Um tamanho corrompido não pode virar uma alocação enorme
+    if (header.length == 0 || header.length > fileSize - sizeof(header))
+        return false;
+
+    vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size()))
+        return false;
+
+    pProgramBinary(program, header.format, binary.data(), header.length);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success;
+}
+
+static void saveBinary(GLuint program, const string &path)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    vector<char> binary(length);
+    GLenum format = 0;
+    pGetProgramBinary(program, length, &length, &format, binary.data());
+
+    error_code ec;
+    filesystem::create_directories(CACHE_DIR, ec);
+
+    ofstream file(path, ios::binary);
+    if (!file)
+        return;
+
+    CacheHeader header = {CACHE_MAGIC, CACHE_VERSION, format, uint32_t(length)};
+    file.write((const char *)&header, sizeof(header));
+    file.write(binary.data(), length);
+}
+
+// Insere os defines logo depois da linha #version (que precisa ser a primeira diretiva)
+static string withDefines(const char *source, const char *defines)
+{
+    string code(source);
+    if (!defines || !*defines)
+        return code;
+
+    size_t version = code.find("#version");
+    size_t lineEnd = version == string::npos ? string::npos : code.find('\n', version);
+    if (lineEnd == string::npos)
+        return string(defines) + "\n" + code;
+
+    code.insert(lineEnd + 1, string(defines) + "\n");
+    return code;
+}
+
+static GLuint compileShader(GLenum type, const string &source)
+{
+    GLuint shader = glCreateShader(type);
+    const GLchar *code = source.c_str();
+    glShaderSource(shader, 1, &code, NULL);
+    glCompileShader(shader);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cout << (type == GL_VERTEX_SHADER ? "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" : "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n")
+                  << infoLog << std::endl;
+    }
+    return shader;
+}
+
+static bool compileAndLink(GLuint program, const char *vertexSource, const char *fragmentSource, const char *defines)
+{
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, withDefines(vertexSource, defines));
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, withDefines(fragmentSource, defines));
+
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    GLint success;
+    GLchar infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
+                  << infoLog << std::endl;
+    }
+
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return success;
+}
+
+GLuint createShaderProgram(const char *vertexSource, const char *fragmentSource, const char *defines)
+{
+    double start_s = glfwGetTime();
+
+    GLuint program = glCreateProgram();
+    bool useCache = cacheAvailable();
+    string path;
+    bool hit = false;
+
+    if (useCache)
+    {
+        path = cachePath(vertexSource, fragmentSource, defines);
+        hit = loadBinary(program, path);
+        if (!hit && filesystem::exists(path))
+        {
+            // Binário de outro driver ou corrompido: recompila e regrava
+            cacheStats.rejected++;
+            glDeleteProgram(program);
+            program = glCreateProgram();
+        }
+    }
+
+    if (!hit)
+    {
+        if (useCache)
+            pProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+        if (compileAndLink(program, vertexSource, fragmentSource, defines) && useCache)
+            saveBinary(program, path);
+    }
+
+    double elapsed_ms = (glfwGetTime() - start_s) * 1000.0;
+    cacheStats.totalMs += elapsed_ms;
+    if (hit)
+        cacheStats.hits++;
+    else
+        cacheStats.misses++;
+
+    printf("Shader %u: %s em %.2f ms\n", program,
+           !useCache ? "compilado (sem cache)" : hit ? "cache quente" : "cache frio, compilado", elapsed_ms);
+
+    return program;
+}
+
+const ShaderCacheStats &shaderCacheStats()
+{
+    return cacheStats;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glad/glad.h>
+
+/*
+ * Compilação de shaders compartilhada por todos os executáveis.
+ *
+ * createShaderProgram() compila e linka um vertex + fragment shader. Os
+ * programas linkados são guardados em disco (glGetProgramBinary) na pasta
+ * shader_cache/ do diretório de execução, com a chave sendo um hash dos
+ * fontes, dos defines e do driver (GL_VENDOR, GL_RENDERER, GL_VERSION).
+ * Se o binário não existir ou o driver recusá-lo, o programa é compilado do
+ * zero e o cache é regravado.
+ *
+ * Os defines (ex.: "#define USE_FOG\n") são inseridos logo após a linha
+ * #version. A variável de ambiente PGCCHIB_NO_SHADER_CACHE desliga o cache.
+ */
+
+struct ShaderCacheStats
+{
+    int hits = 0;
+    int misses = 0;
+    int rejected = 0;
+    double totalMs = 0.0;
+};
+
+GLuint createShaderProgram(const char *vertexSource, const char *fragmentSource, const char *defines = "");
+
+const ShaderCacheStats &shaderCacheStats();
@@ -0,0 +1,156 @@
+#include "ShaderProgram.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "GLState.h"
+
+using namespace std;
+
+static ShaderProgram::Stats frameCounters;
+
+ShaderProgram::ShaderProgram() : _id(0)
+{
+}
+
+ShaderProgram::ShaderProgram(GLuint id) : _id(id)
+{
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    vector<GLchar> nameBuffer(max(maxLength, 1));
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        Uniform uniform;
+        glGetActiveUniform(_id, i, nameBuffer.size(), &length, &uniform.size, &uniform.type, nameBuffer.data());
+
+        string name(nameBuffer.data(), length);
+        uniform.location = glGetUniformLocation(_id, name.c_str());
+        // Uniforms de blocos (UBO) não têm location
+        if (uniform.location < 0)
+            continue;
+
+        // Arrays aparecem como "nome[0]", mas são acessados pelo nome base
+        size_t bracket = name.find('[');
+        if (bracket != string::npos)
+            name = name.substr(0, bracket);
+
+        uniform.hash = uniformHash(name.c_str());
+        uniform.valid = false;
+        memset(uniform.shadow, 0, sizeof(uniform.shadow));
+        _uniforms.push_back(uniform);
+    }
+
+    sort(_uniforms.begin(), _uniforms.end(), [](const Uniform &a, const Uniform &b)
+         { return a.hash < b.hash; });
+
+    for (size_t i = 1; i < _uniforms.size(); i++)
+    {
+        if (_uniforms[i].hash == _uniforms[i - 1].hash)
+            cout << "WARNING::SHADER::UNIFORM_HASH_COLLISION in program " << _id << endl;
+    }
+}
+
+void ShaderProgram::use() const
+{
+    GLState::useProgram(_id);
+}
+
+ShaderProgram::Uniform *ShaderProgram::find(UniformName name)
+{
+    auto it = lower_bound(_uniforms.begin(), _uniforms.end(), name.hash, [](const Uniform &u, uint32_t hash)
+                          { return u.hash < hash; });
+    if (it == _uniforms.end() || it->hash != name.hash)
+        return nullptr;
+    return &*it;
+}
+
+bool ShaderProgram::has(UniformName name) const
+{
+    return const_cast<ShaderProgram *>(this)->find(name) != nullptr;
+}
+
+bool ShaderProgram::changed(Uniform *uniform, const void *data, size_t bytes)
+{
+    if (bytes > sizeof(uniform->shadow))
+    {
+        // Grande demais para a cópia: sempre envia
+        frameCounters.uploads++;
+        return true;
+    }
+    if (uniform->valid && memcmp(uniform->shadow, data, bytes) == 0)
+    {
+        frameCounters.skipped++;
+        return false;
+    }
+    memcpy(uniform->shadow, data, bytes);
+    uniform->valid = true;
+    frameCounters.uploads++;
+    return true;
+}
+
+void ShaderProgram::setInt(UniformName name, int value)
+{
+    Uniform *uniform = find(name);
+    if (uniform && changed(uniform, &value, sizeof(value)))
+        glUniform1i(uniform->location, value);
+}
+
+void ShaderProgram::setFloat(UniformName name, float value)
+{
+    Uniform *uniform = find(name);
+    if (uniform && changed(uniform, &value, sizeof(value)))
+        glUniform1f(uniform->location, value);
+}
+
+void ShaderProgram::setVec2(UniformName name, float x, float y)
+{
+    float v[2] = {x, y};
+    Uniform *uniform = find(name);
+    if (uniform && changed(uniform, v, sizeof(v)))
+        glUniform2fv(uniform->location, 1, v);
+}
+
+void ShaderProgram::setVec3(UniformName name, float x, float y, float z)
+{
+    float v[3] = {x, y, z};
+    Uniform *uniform = find(name);
+    if (uniform && changed(uniform, v, sizeof(v)))
+        glUniform3fv(uniform->location, 1, v);
+}
+
+void ShaderProgram::setVec4(UniformName name, float x, float y, float z, float w)
+{
+    float v[4] = {x, y, z, w};
+    Uniform *uniform = find(name);
+    if (uniform && changed(uniform, v, sizeof(v)))
+        glUniform4fv(uniform->location, 1, v);
+}
+
+void ShaderProgram::setMat4(UniformName name, const glm::mat4 &m)
+{
+    Uniform *uniform = find(name);
+    if (uniform && changed(uniform, &m[0][0], 16 * sizeof(float)))
+        glUniformMatrix4fv(uniform->location, 1, GL_FALSE, &m[0][0]);
+}
+
+void ShaderProgram::setFloatArray(UniformName name, const float *values, int count)
+{
+    Uniform *uniform = find(name);
+    if (uniform && changed(uniform, values, count * sizeof(float)))
+        glUniform1fv(uniform->location, count, values);
+}
+
+const ShaderProgram::Stats &ShaderProgram::frameStats()
+{
+    return frameCounters;
+}
+
+void ShaderProgram::resetFrameStats()
+{
+    frameCounters = Stats();
+}
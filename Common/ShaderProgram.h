@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+/*
+ * ShaderProgram
+ *
+ * Envolve um programa já linkado. No construtor, todas as uniforms ativas são
+ * lidas uma única vez (glGetActiveUniform) para uma tabela plana ordenada pelo
+ * hash do nome, então o laço principal nunca chama glGetUniformLocation.
+ *
+ * Cada uniform guarda uma cópia do último valor enviado; set* com o mesmo
+ * valor não gera glUniform*. Os contadores por frame mostram quantos envios
+ * foram evitados. Os set* valem para o programa em uso (como o glUniform*),
+ * e a cópia só é confiável se a uniform for alterada apenas por esta classe.
+ */
+
+// FNV-1a de 32 bits, calculado em tempo de compilação para nomes literais
+constexpr uint32_t uniformHash(const char *name, uint32_t hash = 2166136261u)
+{
+    return *name ? uniformHash(name + 1, (hash ^ uint8_t(*name)) * 16777619u) : hash;
+}
+
+struct UniformName
+{
+    uint32_t hash;
+    constexpr UniformName(const char *name) : hash(uniformHash(name)) {}
+};
+
+// "model"_u: hash do nome da uniform resolvido pelo compilador
+constexpr UniformName operator""_u(const char *name, size_t)
+{
+    return UniformName(name);
+}
+
+class ShaderProgram
+{
+public:
+    struct Stats
+    {
+        int uploads = 0;
+        int skipped = 0;
+    };
+
+    ShaderProgram();
+    ShaderProgram(GLuint id);
+
+    // Só pode haver um dono da cópia dos valores: duas cópias do mesmo programa pulariam envios uma da outra
+    ShaderProgram(const ShaderProgram &) = delete;
+    ShaderProgram &operator=(const ShaderProgram &) = delete;
+    ShaderProgram(ShaderProgram &&other) noexcept : _id(other._id), _uniforms(std::move(other._uniforms)) { other._id = 0; }
+    ShaderProgram &operator=(ShaderProgram &&other) noexcept
+    {
+        _id = other._id;
+        _uniforms = std::move(other._uniforms);
+        other._id = 0;
+        other._uniforms.clear();
+        return *this;
+    }
+
+    GLuint id() const { return _id; }
+    void use() const;
+
+    bool has(UniformName name) const;
+
+    void setInt(UniformName name, int value);
+    void setFloat(UniformName name, float value);
+    void setVec2(UniformName name, float x, float y);
+    void setVec3(UniformName name, float x, float y, float z);
+    void setVec4(UniformName name, float x, float y, float z, float w);
+    void setVec2(UniformName name, const glm::vec2 &v) { setVec2(name, v.x, v.y); }
+    void setVec3(UniformName name, const glm::vec3 &v) { setVec3(name, v.x, v.y, v.z); }
+    void setVec4(UniformName name, const glm::vec4 &v) { setVec4(name, v.x, v.y, v.z, v.w); }
+    void setMat4(UniformName name, const glm::mat4 &m);
+    void setFloatArray(UniformName name, const float *values, int count);
+
+    // Contadores somados de todos os programas desde o último resetFrameStats()
+    static const Stats &frameStats();
+    static void resetFrameStats();
+
+private:
+    struct Uniform
+    {
+        uint32_t hash;
+        GLint location;
+        GLenum type;
+        GLint size;
+        bool valid;
+        float shadow[16];
+    };
+
+    Uniform *find(UniformName name);
+    bool changed(Uniform *uniform, const void *data, size_t bytes);
+
+    GLuint _id;
+    std::vector<Uniform> _uniforms;
+};
@@ -0,0 +1,168 @@
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GLState.h"
+
+using namespace glm;
+
+SpriteBatch::SpriteBatch(int initialCapacity)
+    : _vao(0), _vbo(0), _ebo(0), _capacity(0)
+{
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_vbo);
+    glGenBuffers(1, &_ebo);
+
+    GLState::bindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+
+    reserve(initialCapacity);
+
+    GLState::bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::reserve(int sprites)
+{
+    if (sprites <= _capacity)
+        return;
+
+    int capacity = std::max(_capacity, 64);
+    while (capacity < sprites)
+        capacity *= 2;
+
+    // Os índices são fixos (dois triângulos por quad), só precisam crescer junto com o VBO
+    std::vector<GLuint> indices(capacity * 6);
+    for (int i = 0; i < capacity; i++)
+    {
+        GLuint v = i * 4;
+        indices[i * 6 + 0] = v + 0;
+        indices[i * 6 + 1] = v + 1;
+        indices[i * 6 + 2] = v + 2;
+        indices[i * 6 + 3] = v + 2;
+        indices[i * 6 + 4] = v + 1;
+        indices[i * 6 + 5] = v + 3;
+    }
+
+    GLState::bindVertexArray(_vao);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, capacity * 4 * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+
+    _capacity = capacity;
+}
+
+void SpriteBatch::begin()
+{
+    _entries.clear();
+    _vertices.clear();
+    _stats = Stats();
+}
+
+void SpriteBatch::draw(GLuint texID, GLuint shaderID, const mat4 &model, int layer, vec4 uvRect)
+{
+    Entry entry;
+    entry.layer = layer;
+    entry.shaderID = shaderID;
+    entry.texID = texID;
+    entry.index = int(_entries.size());
+    _entries.push_back(entry);
+
+    // Mesmos cantos e coordenadas de textura do quad de setupSprite()
+    vec4 v0 = model * vec4(-0.5f, 0.5f, 0.0f, 1.0f);
+    vec4 v1 = model * vec4(-0.5f, -0.5f, 0.0f, 1.0f);
+    vec4 v2 = model * vec4(0.5f, 0.5f, 0.0f, 1.0f);
+    vec4 v3 = model * vec4(0.5f, -0.5f, 0.0f, 1.0f);
+
+    _vertices.push_back({v0.x, v0.y, v0.z, uvRect.x, uvRect.w});
+    _vertices.push_back({v1.x, v1.y, v1.z, uvRect.x, uvRect.y});
+    _vertices.push_back({v2.x, v2.y, v2.z, uvRect.z, uvRect.w});
+    _vertices.push_back({v3.x, v3.y, v3.z, uvRect.z, uvRect.y});
+}
+
+void SpriteBatch::end()
+{
+    int count = int(_entries.size());
+    _stats.sprites = count;
+    if (count == 0)
+        return;
+
+    auto less = [](const Entry &a, const Entry &b)
+    {
+        if (a.layer != b.layer)
+            return a.layer < b.layer;
+        if (a.shaderID != b.shaderID)
+            return a.shaderID < b.shaderID;
+        if (a.texID != b.texID)
+            return a.texID < b.texID;
+        return a.index < b.index;
+    };
+
+    if (!std::is_sorted(_entries.begin(), _entries.end(), less))
+        std::sort(_entries.begin(), _entries.end(), less);
+
+    reserve(count);
+
+    GLState::bindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+
+    // Orphaning: o driver entrega um buffer novo e não precisa esperar o frame anterior
+    glBufferData(GL_ARRAY_BUFFER, _capacity * 4 * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+    Vertex *dst = (Vertex *)glMapBufferRange(GL_ARRAY_BUFFER, 0, count * 4 * sizeof(Vertex),
+                                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!dst)
+    {
+        GLState::bindVertexArray(0);
+        return;
+    }
+    for (int i = 0; i < count; i++)
+        memcpy(dst + i * 4, &_vertices[_entries[i].index * 4], 4 * sizeof(Vertex));
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+
+    GLuint currentShader = 0;
+    GLuint currentTex = 0;
+    int first = 0;
+    while (first < count)
+    {
+        const Entry &run = _entries[first];
+        int last = first + 1;
+        while (last < count && _entries[last].shaderID == run.shaderID && _entries[last].texID == run.texID)
+            last++;
+
+        if (run.shaderID != currentShader)
+        {
+            GLState::useProgram(run.shaderID);
+            currentShader = run.shaderID;
+            _stats.shaderChanges++;
+        }
+        if (run.texID != currentTex)
+        {
+            GLState::bindTexture(GL_TEXTURE_2D, run.texID);
+            currentTex = run.texID;
+            _stats.textureChanges++;
+        }
+
+        glDrawElements(GL_TRIANGLES, (last - first) * 6, GL_UNSIGNED_INT, (GLvoid *)(first * 6 * sizeof(GLuint)));
+        _stats.drawCalls++;
+
+        first = last;
+    }
+
+    // O VAO continua ligado: no próximo frame o GLState evita ligá-lo de novo
+}
+
+void SpriteBatch::clear()
+{
+    glDeleteBuffers(1, &_vbo);
+    glDeleteBuffers(1, &_ebo);
+    GLState::deleteVertexArray(_vao);
+    _capacity = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+/*
+ * SpriteBatch
+ *
+ * Acumula os sprites de um frame em um único VBO de streaming, ordena por
+ * (camada, shader, textura) e desenha cada sequência com a mesma textura e
+ * shader em uma única chamada de glDrawElements.
+ *
+ * Os vértices já saem transformados pela matriz model (x, y, z, s, t), no
+ * mesmo formato usado por setupSprite(). O shader usado com o batch deve,
+ * portanto, ter "model" igual à identidade e "projection" configurada uma vez
+ * antes do laço principal.
+ *
+ * Sprites de camadas diferentes nunca são reordenados entre si, então a
+ * camada serve para preservar a ordem de pintura quando há transparência.
+ *
+ * Programa, textura e VAO são ligados pelo GLState, e o VAO do batch continua
+ * ligado depois de end().
+ */
+class SpriteBatch
+{
+public:
+    struct Stats
+    {
+        int sprites = 0;
+        int drawCalls = 0;
+        int shaderChanges = 0;
+        int textureChanges = 0;
+    };
+
+    SpriteBatch(int initialCapacity = 1024);
+
+    void begin();
+    void draw(GLuint texID, GLuint shaderID, const glm::mat4 &model, int layer = 0,
+              glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    void end();
+
+    const Stats &stats() const { return _stats; }
+
+    void clear();
+
+private:
+    struct Vertex
+    {
+        float x, y, z;
+        float s, t;
+    };
+
+    struct Entry
+    {
+        int layer;
+        GLuint shaderID;
+        GLuint texID;
+        int index;
+    };
+
+    void reserve(int sprites);
+
+    GLuint _vao, _vbo, _ebo;
+    int _capacity;
+
+    std::vector<Entry> _entries;
+    std::vector<Vertex> _vertices;
+
+    Stats _stats;
+};
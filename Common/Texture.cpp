@@ -0,0 +1,419 @@
+#include "Texture.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include "GLState.h"
+#include "MipChain.h"
+#include "TextureFile.h"
+
+using namespace std;
+
+// Níveis enviados de uma textura e quanto teriam ocupado todos os níveis da imagem
+struct TextureUpload
+{
+    int base = 0;
+    int levels = 0;
+    size_t bytes = 0;
+    size_t fullBytes = 0;
+};
+
+static TextureQuality qualityFromEnvironment()
+{
+    const char *env = getenv("PGCCHIB_TEXTURE_QUALITY");
+    if (env && strcmp(env, "full") == 0)
+        return TEXTURE_QUALITY_FULL;
+    if (env && strcmp(env, "low") == 0)
+        return TEXTURE_QUALITY_LOW;
+    return TEXTURE_QUALITY_AUTO;
+}
+
+// Lida também pelas threads do AssetLoader: o static local é inicializado uma vez só, e o atomic cobre o set
+static atomic<int> &qualityValue()
+{
+    static atomic<int> value(qualityFromEnvironment());
+    return value;
+}
+
+void setTextureQuality(TextureQuality value)
+{
+    qualityValue().store(value);
+}
+
+TextureQuality textureQuality()
+{
+    return TextureQuality(qualityValue().load());
+}
+
+const char *textureQualityName(TextureQuality value)
+{
+    switch (value)
+    {
+    case TEXTURE_QUALITY_FULL:
+        return "full";
+    case TEXTURE_QUALITY_LOW:
+        return "low";
+    default:
+        return "auto";
+    }
+}
+
+int textureBaseLevel(int width, int height, int screenWidth, int screenHeight)
+{
+    TextureQuality current = textureQuality();
+    if (current == TEXTURE_QUALITY_FULL || screenWidth <= 0 || screenHeight <= 0)
+        return 0;
+
+    // Um nível só é pulado se os dois eixos continuarem com pelo menos um texel por pixel: sem filtro
+    // de mipmap (ou num mapeamento sem LOD) o eixo menos reduzido ficaria abaixo da resolução da tela
+    double scale = min(double(width) / screenWidth, double(height) / screenHeight);
+    int level = 0;
+    while (scale >= 2.0)
+    {
+        scale /= 2.0;
+        level++;
+    }
+    if (current == TEXTURE_QUALITY_LOW)
+        level++;
+    return min(level, mipLevelCount(width, height) - 1);
+}
+
+bool filterUsesMipmaps(GLint filter)
+{
+    return filter == GL_NEAREST_MIPMAP_NEAREST || filter == GL_NEAREST_MIPMAP_LINEAR ||
+           filter == GL_LINEAR_MIPMAP_NEAREST || filter == GL_LINEAR_MIPMAP_LINEAR;
+}
+
+GLint textureMagFilter(GLint filter)
+{
+    return filter == GL_NEAREST || filter == GL_NEAREST_MIPMAP_NEAREST || filter == GL_NEAREST_MIPMAP_LINEAR ? GL_NEAREST : GL_LINEAR;
+}
+
+int textureLevelCount(int width, int height, int base, GLint filter)
+{
+    // Em full, todos, como antes
+    if (textureQuality() == TEXTURE_QUALITY_FULL || filterUsesMipmaps(filter))
+        return mipLevelCount(width, height) - base;
+    return 1;
+}
+
+static size_t levelBytes(int width, int height, int first, int count)
+{
+    size_t bytes = 0;
+    for (int i = first; i < first + count; i++)
+        bytes += size_t(max(1, width >> i)) * max(1, height >> i) * 4;
+    return bytes;
+}
+
+static bool uploadTextureFile(const string &path, GLint filter, int screenWidth, int screenHeight, int *width, int *height,
+                              TextureUpload &upload)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+
+    const TextureFileHeader *header = textureFileHeader(file);
+    if (!header)
+    {
+        cout << "Arquivo de textura inválido: " << path << endl;
+        return false;
+    }
+
+    int levelCount = int(header->levelCount);
+    upload.base = min(textureBaseLevel(header->width, header->height, screenWidth, screenHeight), levelCount - 1);
+    upload.levels = min(textureLevelCount(header->width, header->height, upload.base, filter), levelCount - upload.base);
+
+    const TextureFileLevel &first = header->levels[upload.base];
+    const TextureFileLevel &last = header->levels[upload.base + upload.levels - 1];
+    GLsizeiptr dataSize = GLsizeiptr(last.offset + last.size - first.offset);
+
+    // O driver copia direto das páginas mapeadas para o buffer de upload
+    GLuint pbo;
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, dataSize, file.data() + first.offset, GL_STREAM_DRAW);
+
+    GLenum format = header->layout == LAYOUT_BGRA ? GL_BGRA : GL_RGBA;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (int i = 0; i < upload.levels; i++)
+    {
+        const TextureFileLevel &level = header->levels[upload.base + i];
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, level.width, level.height, 0, format, GL_UNSIGNED_BYTE,
+                     (const GLvoid *)(uintptr_t)(level.offset - first.offset));
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, upload.levels - 1);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &pbo);
+
+    upload.bytes = size_t(dataSize);
+    upload.fullBytes = size_t(last.offset + last.size - header->levels[0].offset);
+    if (width)
+        *width = header->width;
+    if (height)
+        *height = header->height;
+    return true;
+}
+
+static bool uploadImage(const string &path, GLint filter, int screenWidth, int screenHeight, int *width, int *height,
+                        TextureUpload &upload)
+{
+    int w, h, nrChannels;
+    if (!stbi_info(path.c_str(), &w, &h, &nrChannels))
+        return false;
+
+    upload.base = textureBaseLevel(w, h, screenWidth, screenHeight);
+    upload.levels = textureLevelCount(w, h, upload.base, filter);
+    upload.fullBytes = levelBytes(w, h, 0, mipLevelCount(w, h));
+    upload.bytes = levelBytes(w, h, upload.base, upload.levels);
+
+    if (upload.base == 0)
+    {
+        unsigned char *data = stbi_load(path.c_str(), &w, &h, &nrChannels, 0);
+        if (!data)
+            return false;
+
+        if (nrChannels == 3)
+        {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
+        if (upload.levels > 1)
+            glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, upload.levels - 1);
+
+        stbi_image_free(data);
+    }
+    else
+    {
+        // Os níveis menores saem da CPU (box 2x2, o mesmo do glGenerateMipmap); os maiores nem chegam à GL
+        unsigned char *data = stbi_load(path.c_str(), &w, &h, &nrChannels, 4);
+        if (!data)
+            return false;
+        vector<vector<uint8_t>> chain = buildMipChain(data, w, h);
+        stbi_image_free(data);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        for (int i = 0; i < upload.levels; i++)
+        {
+            int level = upload.base + i;
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, max(1, w >> level), max(1, h >> level), 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                         chain[level].data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, upload.levels - 1);
+    }
+
+    if (width)
+        *width = w;
+    if (height)
+        *height = h;
+    return true;
+}
+
+GLuint loadTexture(const string &filePath, GLint filter, GLint wrap, int *width, int *height, int screenWidth, int screenHeight)
+{
+    double start_s = glfwGetTime();
+
+    GLuint texID;
+
+    glGenTextures(1, &texID);
+    GLState::bindTexture(GL_TEXTURE_2D, texID);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureMagFilter(filter));
+
+    TextureUpload upload;
+    const char *source = "ptex";
+    if (!uploadTextureFile(textureFilePath(filePath), filter, screenWidth, screenHeight, width, height, upload))
+    {
+        source = "stbi";
+        if (!uploadImage(filePath, filter, screenWidth, screenHeight, width, height, upload))
+        {
+            std::cout << "Failed to load texture: " << filePath << std::endl;
+            source = nullptr;
+        }
+    }
+
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
+
+    if (source)
+    {
+        printf("Textura %s: %s em %.2f ms, nível %d + %d, %.1f de %.1f MB (%s)\n", filePath.c_str(), source,
+               (glfwGetTime() - start_s) * 1000.0, upload.base, upload.levels - 1, upload.bytes / (1024.0 * 1024.0),
+               upload.fullBytes / (1024.0 * 1024.0), textureQualityName(textureQuality()));
+    }
+
+    return texID;
+}
+
+// Tamanho de uma imagem sem decodificá-la: cabeçalho do .ptex ou stbi_info
+static bool imageSize(const string &path, int &width, int &height)
+{
+    MappedFile file;
+    if (file.open(textureFilePath(path)))
+    {
+        const TextureFileHeader *header = textureFileHeader(file);
+        if (header)
+        {
+            width = header->width;
+            height = header->height;
+            return true;
+        }
+    }
+    int channels;
+    return stbi_info(path.c_str(), &width, &height, &channels) != 0;
+}
+
+// Os níveis [base, base + levels) de um .ptex na camada layer; false se não houver .ptex válido com eles
+static bool uploadTextureFileLayer(const string &path, int layer, int width, int height, int base, int levels)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+
+    const TextureFileHeader *header = textureFileHeader(file);
+    if (!header || int(header->width) != width || int(header->height) != height || int(header->levelCount) < base + levels)
+        return false;
+
+    const TextureFileLevel &first = header->levels[base];
+    const TextureFileLevel &last = header->levels[base + levels - 1];
+    GLsizeiptr dataSize = GLsizeiptr(last.offset + last.size - first.offset);
+
+    GLuint pbo;
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, dataSize, file.data() + first.offset, GL_STREAM_DRAW);
+
+    GLenum format = header->layout == LAYOUT_BGRA ? GL_BGRA : GL_RGBA;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (int i = 0; i < levels; i++)
+    {
+        const TextureFileLevel &level = header->levels[base + i];
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, level.width, level.height, 1, format, GL_UNSIGNED_BYTE,
+                        (const GLvoid *)(uintptr_t)(level.offset - first.offset));
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &pbo);
+    return true;
+}
+
+GLuint loadTextureArray(const vector<string> &filePaths, GLint filter, GLint wrap, int *width, int *height, int screenWidth,
+                        int screenHeight)
+{
+    double start_s = glfwGetTime();
+    if (filePaths.empty())
+        return 0;
+
+    int w, h;
+    for (size_t i = 0; i < filePaths.size(); i++)
+    {
+        int layerWidth, layerHeight;
+        if (!imageSize(filePaths[i], layerWidth, layerHeight))
+        {
+            cout << "Failed to load texture: " << filePaths[i] << endl;
+            return 0;
+        }
+        if (i == 0)
+        {
+            w = layerWidth;
+            h = layerHeight;
+        }
+        else if (layerWidth != w || layerHeight != h)
+        {
+            printf("Camada %s tem %dx%d, diferente de %dx%d: não cabe no array\n", filePaths[i].c_str(), layerWidth,
+                   layerHeight, w, h);
+            return 0;
+        }
+    }
+
+    GLint maxLayers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (int(filePaths.size()) > maxLayers)
+    {
+        printf("%d camadas, mais que GL_MAX_ARRAY_TEXTURE_LAYERS (%d)\n", int(filePaths.size()), maxLayers);
+        return 0;
+    }
+
+    int base = textureBaseLevel(w, h, screenWidth, screenHeight);
+    int levels = textureLevelCount(w, h, base, filter);
+
+    GLuint texID;
+    glGenTextures(1, &texID);
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, texID);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, textureMagFilter(filter));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    for (int i = 0; i < levels; i++)
+    {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, i, GL_RGBA, max(1, w >> (base + i)), max(1, h >> (base + i)),
+                     GLsizei(filePaths.size()), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    // Os mipmaps das camadas sem .ptex saem da CPU, camada a camada: um glGenerateMipmap no array
+    // refaria também os níveis das camadas do .ptex, gerados com o filtro do cook
+    int cooked = 0;
+    for (size_t i = 0; i < filePaths.size(); i++)
+    {
+        if (uploadTextureFileLayer(textureFilePath(filePaths[i]), int(i), w, h, base, levels))
+        {
+            cooked++;
+            continue;
+        }
+
+        int layerWidth, layerHeight, channels;
+        unsigned char *data = stbi_load(filePaths[i].c_str(), &layerWidth, &layerHeight, &channels, 4);
+        if (!data)
+        {
+            cout << "Failed to load texture: " << filePaths[i] << endl;
+            GLState::deleteTexture(texID);
+            return 0;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (base == 0 && levels == 1)
+        {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, GLint(i), w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
+        else
+        {
+            vector<vector<uint8_t>> chain = buildMipChain(data, w, h);
+            for (int l = 0; l < levels; l++)
+            {
+                int level = base + l;
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, GLint(i), max(1, w >> level), max(1, h >> level), 1, GL_RGBA,
+                                GL_UNSIGNED_BYTE, chain[level].data());
+            }
+        }
+        stbi_image_free(data);
+    }
+
+    GLState::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    if (width)
+        *width = w;
+    if (height)
+        *height = h;
+    size_t layers = filePaths.size();
+    printf("Array de texturas %dx%d com %d camadas (%d ptex, %d stbi) em %.2f ms, nível %d + %d, %.1f de %.1f MB (%s)\n",
+           w, h, int(layers), cooked, int(layers) - cooked, (glfwGetTime() - start_s) * 1000.0, base, levels - 1,
+           levelBytes(w, h, base, levels) * layers / (1024.0 * 1024.0),
+           levelBytes(w, h, 0, mipLevelCount(w, h)) * layers / (1024.0 * 1024.0), textureQualityName(textureQuality()));
+    return texID;
+}
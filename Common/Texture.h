@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+/*
+ * Carregamento de texturas compartilhado pelos executáveis.
+ *
+ * Se existir um .ptex ao lado da imagem (gerado pelo tools/TextureCook), ele
+ * é mapeado em memória e os níveis vão das páginas mapeadas para um pixel
+ * unpack buffer e dali para a textura, sem cópia intermediária no heap e sem
+ * glGenerateMipmap. Caso contrário a imagem é decodificada com stbi_load como
+ * antes. O tempo de cada carga é impresso no terminal.
+ *
+ * Com o tamanho em pixels com que a textura aparece na tela (screenWidth x
+ * screenHeight), só os níveis que a GL pode amostrar são enviados: o nível
+ * base é floor(log2(escala)), com a escala do eixo menos reduzido, para que
+ * os dois eixos fiquem com pelo menos um texel por pixel, e sem filtro de
+ * mipmap (GL_NEAREST, GL_LINEAR) vai só ele. A qualidade vem de setTextureQuality() ou da variável de ambiente
+ * PGCCHIB_TEXTURE_QUALITY:
+ *
+ *   full   todos os níveis da imagem, como se o tamanho na tela não fosse dado
+ *   auto   o padrão descrito acima
+ *   low    um nível abaixo do auto
+ */
+
+enum TextureQuality
+{
+    TEXTURE_QUALITY_FULL,
+    TEXTURE_QUALITY_AUTO,
+    TEXTURE_QUALITY_LOW
+};
+
+void setTextureQuality(TextureQuality quality);
+TextureQuality textureQuality();
+const char *textureQualityName(TextureQuality quality);
+
+// Primeiro nível enviado de uma imagem width x height mostrada em screenWidth x screenHeight (0 = tamanho desconhecido)
+int textureBaseLevel(int width, int height, int screenWidth, int screenHeight);
+bool filterUsesMipmaps(GLint filter);
+// Filtro de ampliação que acompanha o de redução: GL_NEAREST para os *NEAREST_MIPMAP_*, GL_LINEAR para o resto
+GLint textureMagFilter(GLint filter);
+// Quantos níveis vão para a GL a partir do base: só ele sem filtro de mipmap, todos os menores com
+int textureLevelCount(int width, int height, int baseLevel, GLint filter);
+
+// width/height devolvem o tamanho da imagem original, não o do nível enviado
+GLuint loadTexture(const std::string &filePath, GLint filter = GL_NEAREST, GLint wrap = GL_REPEAT,
+                   int *width = nullptr, int *height = nullptr, int screenWidth = 0, int screenHeight = 0);
+
+// Imagens do mesmo tamanho em uma GL_TEXTURE_2D_ARRAY, uma camada por caminho, na ordem dada.
+// Devolve 0 (nada fica alocado) se alguma faltar ou tiver outro tamanho
+GLuint loadTextureArray(const std::vector<std::string> &filePaths, GLint filter = GL_NEAREST, GLint wrap = GL_REPEAT,
+                        int *width = nullptr, int *height = nullptr, int screenWidth = 0, int screenHeight = 0);
@@ -0,0 +1,59 @@
+#include "TextureAtlas.h"
+
+#include "GLState.h"
+#include "Texture.h"
+#include "TextureFile.h"
+
+using namespace std;
+using namespace glm;
+
+TextureAtlas::TextureAtlas()
+    : _texID(0)
+{
+}
+
+bool TextureAtlas::load(const string &manifestPath, const vector<AtlasSheet> &sheets, GLint filter)
+{
+    if (!cookAtlas(manifestPath, sheets, _layout))
+        return false;
+
+    clear();
+    int width = 0;
+    _texID = loadTexture(textureFilePath(manifestPath), filter, GL_CLAMP_TO_EDGE, &width);
+    return width != 0;
+}
+
+int TextureAtlas::sheet(const string &name) const
+{
+    for (size_t i = 0; i < _layout.sheets.size(); i++)
+    {
+        if (_layout.sheets[i].name == name)
+            return int(i);
+    }
+    return -1;
+}
+
+int TextureAtlas::frameCount(int sheet) const
+{
+    return int(_layout.sheets[sheet].frames.size());
+}
+
+const AtlasRect &TextureAtlas::frameRect(int sheet, int frame) const
+{
+    return _layout.sheets[sheet].frames[frame];
+}
+
+vec4 TextureAtlas::uvRect(int sheet, int frame) const
+{
+    const AtlasRect &rect = frameRect(sheet, frame);
+    float width = float(_layout.width);
+    float height = float(_layout.height);
+    return vec4(rect.x / width, rect.y / height, (rect.x + rect.width) / width, (rect.y + rect.height) / height);
+}
+
+void TextureAtlas::clear()
+{
+    if (_texID)
+        GLState::deleteTexture(_texID);
+    _texID = 0;
+}
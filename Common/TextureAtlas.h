@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "AtlasPacker.h"
+
+/*
+ * TextureAtlas
+ *
+ * Uma textura com os quadros de várias sprite sheets (ver AtlasPacker.h).
+ * load() usa o atlas em cache se as folhas não mudaram, ou empacota de novo e
+ * grava o cache, e envia o .ptex com loadTexture().
+ *
+ * Os quadros de uma folha são numerados linha a linha, como na imagem de
+ * origem. uvRect() devolve (s0, t0, s1, t1), o mesmo formato do uvRect do
+ * SpriteBatch; t cresce para baixo, como as linhas da imagem.
+ */
+class TextureAtlas
+{
+public:
+    TextureAtlas();
+
+    bool load(const std::string &manifestPath, const std::vector<AtlasSheet> &sheets, GLint filter = GL_NEAREST);
+
+    GLuint texture() const { return _texID; }
+
+    // Índice da folha pelo nome, ou -1
+    int sheet(const std::string &name) const;
+    int frameCount(int sheet) const;
+
+    glm::vec4 uvRect(int sheet, int frame) const;
+    const AtlasRect &frameRect(int sheet, int frame) const;
+
+    void clear();
+
+private:
+    GLuint _texID;
+    AtlasLayout _layout;
+};
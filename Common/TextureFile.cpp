@@ -0,0 +1,188 @@
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const uint64_t LEVEL_ALIGNMENT = 4096;
+
+MappedFile::MappedFile() : _data(nullptr), _size(0)
+{
+#ifdef _WIN32
+    _file = nullptr;
+    _mapping = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const string &path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    _data = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!_data)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    _file = file;
+    _mapping = mapping;
+    _size = size_t(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    // A leitura é sequencial: o kernel pode adiantar as páginas seguintes
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    _data = (const uint8_t *)data;
+    _size = size_t(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!_data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle((HANDLE)_mapping);
+    CloseHandle((HANDLE)_file);
+    _file = nullptr;
+    _mapping = nullptr;
+#else
+    munmap((void *)_data, _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+string textureFilePath(const string &imagePath)
+{
+    size_t dot = imagePath.find_last_of('.');
+    size_t slash = imagePath.find_last_of("/\\");
+    if (dot == string::npos || (slash != string::npos && dot < slash))
+        return imagePath + ".ptex";
+    return imagePath.substr(0, dot) + ".ptex";
+}
+
+const TextureFileHeader *textureFileHeader(const MappedFile &file)
+{
+    if (!file.data() || file.size() < sizeof(TextureFileHeader))
+        return nullptr;
+
+    const TextureFileHeader *header = (const TextureFileHeader *)file.data();
+    if (header->magic != TEXTURE_FILE_MAGIC || header->version != TEXTURE_FILE_VERSION)
+        return nullptr;
+    if (header->levelCount == 0 || header->levelCount > TEXTURE_FILE_MAX_LEVELS)
+        return nullptr;
+
+    for (uint32_t i = 0; i < header->levelCount; i++)
+    {
+        const TextureFileLevel &level = header->levels[i];
+        if (level.offset + level.size > file.size() || level.size != uint64_t(level.width) * level.height * 4)
+            return nullptr;
+    }
+    return header;
+}
+
+bool writeTextureFile(const string &path, const vector<vector<uint8_t>> &levels,
+                      int width, int height, TextureFileLayout layout, uint64_t sourceSize, uint32_t filter)
+{
+    if (levels.empty() || levels.size() > TEXTURE_FILE_MAX_LEVELS)
+        return false;
+
+    TextureFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TEXTURE_FILE_MAGIC;
+    header.version = TEXTURE_FILE_VERSION;
+    header.width = width;
+    header.height = height;
+    header.layout = layout;
+    header.levelCount = levels.size();
+    header.filter = filter;
+    header.sourceSize = sourceSize;
+
+    uint64_t offset = LEVEL_ALIGNMENT;
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        header.levels[i].offset = offset;
+        header.levels[i].size = levels[i].size();
+        header.levels[i].width = max(1, width >> int(i));
+        header.levels[i].height = max(1, height >> int(i));
+        offset += (levels[i].size() + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+    }
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file)
+        return false;
+
+    vector<uint8_t> padding(LEVEL_ALIGNMENT, 0);
+    file.write((const char *)&header, sizeof(header));
+    file.write((const char *)padding.data(), LEVEL_ALIGNMENT - sizeof(header));
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        vector<uint8_t> level = levels[i];
+        if (layout == LAYOUT_BGRA)
+        {
+            for (size_t p = 0; p < level.size(); p += 4)
+                swap(level[p], level[p + 2]);
+        }
+        file.write((const char *)level.data(), level.size());
+
+        uint64_t written = level.size() % LEVEL_ALIGNMENT;
+        if (written && i + 1 < levels.size())
+            file.write((const char *)padding.data(), LEVEL_ALIGNMENT - written);
+    }
+    return bool(file);
+}
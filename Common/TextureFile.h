@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Formato .ptex: textura já decodificada, com a cadeia de mipmaps completa,
+ * pronta para ser mapeada em memória e enviada direto para a GL.
+ *
+ * O arquivo começa com um TextureFileHeader de tamanho fixo; os níveis vêm
+ * depois, cada um alinhado em 4096 bytes, com linhas de 4 bytes por pixel
+ * (RGBA ou BGRA pré-trocado) sem padding. O cabeçalho é lido direto da
+ * memória mapeada, sem parse.
+ *
+ * Os arquivos são gerados offline pelo tools/TextureCook e ficam ao lado do
+ * PNG de origem (sky.png -> sky.ptex).
+ *
+ * Versão 2: o cabeçalho guarda o filtro usado nos mipmaps (MipFilter), para o
+ * cook saber quando precisa refazer o arquivo.
+ */
+
+const uint32_t TEXTURE_FILE_MAGIC = 0x58455450; // "PTEX"
+const uint32_t TEXTURE_FILE_VERSION = 2;
+const int TEXTURE_FILE_MAX_LEVELS = 16;
+
+enum TextureFileLayout : uint32_t
+{
+    LAYOUT_RGBA = 0,
+    LAYOUT_BGRA = 1
+};
+
+struct TextureFileLevel
+{
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct TextureFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t layout;
+    uint32_t levelCount;
+    uint32_t filter;
+    uint32_t reserved;
+    uint64_t sourceSize;
+    TextureFileLevel levels[TEXTURE_FILE_MAX_LEVELS];
+};
+
+// Arquivo somente leitura mapeado em memória (mmap / CreateFileMapping)
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    const uint8_t *data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    const uint8_t *_data;
+    size_t _size;
+#ifdef _WIN32
+    void *_file;
+    void *_mapping;
+#endif
+};
+
+// .ptex correspondente a uma imagem: "../assets/textures/sky.png" -> "../assets/textures/sky.ptex"
+std::string textureFilePath(const std::string &imagePath);
+
+// Valida e devolve o cabeçalho de um .ptex mapeado, ou nullptr se o arquivo for inválido
+const TextureFileHeader *textureFileHeader(const MappedFile &file);
+
+// Grava um .ptex a partir de níveis RGBA (levels[0] é a imagem original); filter é o MipFilter dos níveis
+bool writeTextureFile(const std::string &path, const std::vector<std::vector<uint8_t>> &levels,
+                      int width, int height, TextureFileLayout layout, uint64_t sourceSize, uint32_t filter = 0);
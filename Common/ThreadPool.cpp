@@ -0,0 +1,94 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threads)
+    : _job(nullptr), _generation(0), _running(0), _quit(false)
+{
+    if (threads <= 0)
+        threads = max(1, int(thread::hardware_concurrency()));
+    for (int i = 1; i < threads; i++)
+        _workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(_mutex);
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (thread &worker : _workers)
+        worker.join();
+}
+
+void ThreadPool::run(const function<void(int)> &job)
+{
+    if (_workers.empty())
+    {
+        job(0);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(_mutex);
+        _job = &job;
+        _running = int(_workers.size());
+        _generation++;
+    }
+    _wake.notify_all();
+
+    job(0);
+
+    unique_lock<mutex> lock(_mutex);
+    _done.wait(lock, [this]
+               { return _running == 0; });
+    _job = nullptr;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t chunk, const function<void(size_t, size_t, int)> &body)
+{
+    if (count == 0)
+        return;
+    chunk = max(chunk, size_t(1));
+
+    atomic<size_t> next(0);
+    auto work = [&](int worker)
+    {
+        while (true)
+        {
+            size_t begin = next.fetch_add(chunk);
+            if (begin >= count)
+                return;
+            body(begin, min(begin + chunk, count), worker);
+        }
+    };
+    run(work);
+}
+
+void ThreadPool::workerLoop(int worker)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        const function<void(int)> *job;
+        {
+            unique_lock<mutex> lock(_mutex);
+            _wake.wait(lock, [&]
+                       { return _quit || _generation != seen; });
+            if (_quit)
+                return;
+            seen = _generation;
+            job = _job;
+        }
+
+        (*job)(worker);
+
+        lock_guard<mutex> lock(_mutex);
+        if (--_running == 0)
+            _done.notify_one();
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * ThreadPool
+ *
+ * Pool fixo para trabalho de CPU em rajadas (solver, geração da grade,
+ * simulações). As threads ficam dormindo entre uma chamada e outra; run()
+ * acorda todas, executa o mesmo job em cada uma (a thread que chamou também
+ * trabalha, como worker 0) e só volta quando todas terminaram.
+ *
+ * Não é reentrante: run() e parallelFor() não podem ser chamados de dentro
+ * de um job.
+ */
+class ThreadPool
+{
+public:
+    // threads <= 0 usa todos os núcleos
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    // Número de threads que executam cada job, contando a que chama run()
+    int size() const { return int(_workers.size()) + 1; }
+
+    // Chama job(worker) com worker em [0, size()) e espera todos terminarem
+    void run(const std::function<void(int)> &job);
+
+    // Divide [0, count) em blocos de até chunk itens, entregues sob demanda: body(begin, end, worker)
+    void parallelFor(size_t count, size_t chunk, const std::function<void(size_t, size_t, int)> &body);
+
+private:
+    void workerLoop(int worker);
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    const std::function<void(int)> *_job;
+    uint64_t _generation;
+    int _running;
+    bool _quit;
+};
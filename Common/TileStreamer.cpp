@@ -0,0 +1,357 @@
+#include "TileStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "GLState.h"
+#include "Texture.h"
+
+using namespace std;
+
+TileStreamer::TileStreamer(size_t memoryCap, size_t bytesPerFrame, int workers)
+    : _memoryCap(memoryCap), _budget(bytesPerFrame), _frame(0), _quit(false)
+{
+    // A cópia de um tile é quase só leitura do disco: poucas threads bastam
+    if (workers <= 0)
+        workers = min(2, max(1, int(thread::hardware_concurrency()) - 1));
+    for (int i = 0; i < workers; i++)
+        _workers.emplace_back(&TileStreamer::workerLoop, this);
+}
+
+TileStreamer::~TileStreamer()
+{
+    {
+        lock_guard<mutex> lock(_mutex);
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (thread &worker : _workers)
+        worker.join();
+}
+
+uint64_t TileStreamer::tileKey(int image, int level, int col, int row)
+{
+    return (uint64_t(image) << 48) | (uint64_t(level) << 40) | (uint64_t(row) << 20) | uint64_t(col);
+}
+
+int TileStreamer::open(const string &imagePath)
+{
+    unique_ptr<Image> image(new Image());
+    string path = tiledImagePath(imagePath);
+    if (!image->file.open(path))
+        return -1;
+
+    image->header = tiledImageHeader(image->file);
+    if (!image->header)
+    {
+        cout << "Arquivo de tiles inválido: " << path << endl;
+        return -1;
+    }
+    _images.push_back(move(image));
+    int index = int(_images.size()) - 1;
+
+    // O nível mais alto é um tile só e nunca sai: é ele que aparece enquanto os outros não chegam
+    request(index, levelCount(index) - 1, 0, 0, true, true);
+    return index;
+}
+
+int TileStreamer::levelFor(int image, float viewWidth, float viewHeight, int screenWidth, int screenHeight) const
+{
+    int level = textureBaseLevel(max(1, int(viewWidth)), max(1, int(viewHeight)), screenWidth, screenHeight);
+    return min(level, levelCount(image) - 1);
+}
+
+size_t TileStreamer::viewBytes(int image, int level, float viewWidth, float viewHeight) const
+{
+    const TiledImageHeader &header = *_images[image]->header;
+    const TiledImageLevel &l = header.levels[level];
+
+    // Desalinhada com os tiles, a vista pega um a mais em cada eixo; mais que o nível inteiro ela não pega
+    float w = viewWidth * l.width / header.width, h = viewHeight * l.height / header.height;
+    size_t cols = min(size_t(l.cols), size_t(ceil(w / header.tileSize)) + 1);
+    size_t rows = min(size_t(l.rows), size_t(ceil(h / header.tileSize)) + 1);
+    return cols * rows * tiledImageTileBytes(header);
+}
+
+void TileStreamer::workerLoop()
+{
+    while (true)
+    {
+        unique_ptr<Job> job;
+        {
+            unique_lock<mutex> lock(_mutex);
+            _wake.wait(lock, [this]
+                       { return _quit || !_pending.empty(); });
+            if (_quit)
+                return;
+            job = move(_pending.front());
+            _pending.pop_front();
+        }
+
+        // As faltas de página do arquivo mapeado acontecem aqui, não na thread da GL
+        job->pixels.assign(job->src, job->src + size_t(job->tileSize) * job->tileSize * 4);
+
+        lock_guard<mutex> lock(_mutex);
+        _loaded.push_back(move(job));
+    }
+}
+
+void TileStreamer::forEachTile(int image, int level, float x0, float y0, float x1, float y1,
+                               const function<void(int, int, float)> &body) const
+{
+    const TiledImageHeader &header = *_images[image]->header;
+    const TiledImageLevel &l = header.levels[level];
+
+    // Lado de um tile do nível em pixels do nível 0
+    float tileW = float(header.tileSize) * header.width / l.width;
+    float tileH = float(header.tileSize) * header.height / l.height;
+
+    int row0 = max(0, int(floor(y0 / tileH)));
+    int row1 = min(int(l.rows) - 1, int(ceil(y1 / tileH)) - 1);
+
+    // Em x a imagem se repete: a volta k cobre [k * width, (k + 1) * width)
+    for (int k = int(floor(x0 / header.width)); k * float(header.width) < x1; k++)
+    {
+        float base = k * float(header.width);
+        int col0 = max(0, int(floor((x0 - base) / tileW)));
+        int col1 = min(int(l.cols) - 1, int(ceil((x1 - base) / tileW)) - 1);
+        for (int row = row0; row <= row1; row++)
+        {
+            for (int col = col0; col <= col1; col++)
+                body(col, row, base);
+        }
+    }
+}
+
+void TileStreamer::touch(Tile &tile, bool visible)
+{
+    // Residentes vistos ou pedidos pelo prefetch neste frame: o evict() não os apaga no próximo
+    if (tile.lastUsed != _frame && tile.texture && !tile.pinned)
+        _usedBytes += tile.bytes;
+    tile.lastUsed = _frame;
+    if (visible)
+        tile.shown = true;
+    if (tile.texture && !tile.pinned)
+        _lru.splice(_lru.begin(), _lru, tile.lru);
+}
+
+bool TileStreamer::request(int image, int level, int col, int row, bool visible, bool pinned)
+{
+    uint64_t key = tileKey(image, level, col, row);
+    auto it = _tiles.find(key);
+    if (it != _tiles.end())
+    {
+        touch(it->second, visible);
+        return it->second.texture != 0;
+    }
+
+    // O prefetch pode tirar da LRU os tiles que ninguém usou neste frame, mas não passa do limite com o resto:
+    // um tile pedido só para ser apagado em seguida é leitura jogada fora
+    const TiledImageHeader &header = *_images[image]->header;
+    size_t bytes = tiledImageTileBytes(header);
+    if (!visible && !pinned && _usedBytes + _pinnedBytes + _pendingBytes + bytes > _memoryCap)
+        return false;
+
+    Tile &tile = _tiles[key];
+    tile.bytes = bytes;
+    tile.pending = true;
+    tile.pinned = pinned;
+    touch(tile, visible);
+    _pendingBytes += bytes;
+
+    unique_ptr<Job> job(new Job());
+    job->key = key;
+    job->generation = _generation;
+    job->src = tiledImageTile(_images[image]->file, header, level, col, row);
+    job->tileSize = int(header.tileSize);
+    job->format = header.layout == LAYOUT_BGRA ? GL_BGRA : GL_RGBA;
+    {
+        lock_guard<mutex> lock(_mutex);
+        if (visible)
+            _pending.push_front(move(job));
+        else
+            _pending.push_back(move(job));
+    }
+    _wake.notify_one();
+
+    _stats.pendingTiles++;
+    return false;
+}
+
+void TileStreamer::view(int image, int level, float x0, float y0, float x1, float y1, vector<DrawTile> &out)
+{
+    const TiledImageHeader &header = *_images[image]->header;
+    const TiledImageLevel &l = header.levels[level];
+    float ts = float(header.tileSize);
+
+    auto addTile = [&](int col, int row, float base)
+    {
+        // Parte do tile dentro da imagem, em pixels do nível 0
+        DrawTile tile;
+        tile.x0 = base + col * ts * header.width / l.width;
+        tile.x1 = base + min((col + 1) * ts, float(l.width)) * header.width / l.width;
+        tile.y0 = row * ts * header.height / l.height;
+        tile.y1 = min((row + 1) * ts, float(l.height)) * header.height / l.height;
+
+        if (!request(image, level, col, row, true, false))
+            _stats.missing++;
+
+        // O próprio tile ou o pedaço do primeiro nível acima que já chegou
+        for (int up = level; up < int(header.levelCount); up++)
+        {
+            int shift = up - level;
+            auto it = _tiles.find(tileKey(image, up, col >> shift, row >> shift));
+            if (it == _tiles.end() || !it->second.texture)
+                continue;
+            touch(it->second, true);
+
+            const TiledImageLevel &p = header.levels[up];
+            float left = (col >> shift) * ts, top = (row >> shift) * ts;
+            tile.s0 = ((tile.x0 - base) * p.width / header.width - left) / ts;
+            tile.s1 = ((tile.x1 - base) * p.width / header.width - left) / ts;
+            tile.t0 = (tile.y0 * p.height / header.height - top) / ts;
+            tile.t1 = (tile.y1 * p.height / header.height - top) / ts;
+            tile.texture = it->second.texture;
+            out.push_back(tile);
+            return;
+        }
+    };
+    forEachTile(image, level, x0, y0, x1, y1, addTile);
+}
+
+void TileStreamer::prefetch(int image, int level, float x0, float y0, float x1, float y1)
+{
+    auto requestTile = [&](int col, int row, float)
+    {
+        request(image, level, col, row, false, false);
+    };
+    forEachTile(image, level, x0, y0, x1, y1, requestTile);
+}
+
+void TileStreamer::update()
+{
+    _frame++;
+    _stats.missing = 0;
+    _usedBytes = 0;
+
+    {
+        lock_guard<mutex> lock(_mutex);
+
+        // Pedidos que nenhuma thread pegou e que não foram vistos nem pedidos de novo no último frame
+        deque<unique_ptr<Job>> keep;
+        for (unique_ptr<Job> &job : _pending)
+        {
+            Tile &tile = _tiles[job->key];
+            if (tile.pinned || tile.lastUsed + 1 >= _frame)
+            {
+                keep.push_back(move(job));
+                continue;
+            }
+            _pendingBytes -= tile.bytes;
+            _tiles.erase(job->key);
+            _stats.pendingTiles--;
+            _stats.cancelled++;
+        }
+        _pending.swap(keep);
+
+        // Uma thread pode terminar uma cópia pedida antes do último clear(): o tile dela já não é o mesmo
+        while (!_loaded.empty())
+        {
+            if (_loaded.front()->generation == _generation)
+                _uploads.push_back(move(_loaded.front()));
+            _loaded.pop_front();
+        }
+    }
+
+    // Pelo menos um tile por frame, mesmo que passe do orçamento
+    size_t uploaded = 0;
+    while (!_uploads.empty() && (uploaded == 0 || uploaded + _uploads.front()->pixels.size() <= _budget))
+    {
+        uploaded += _uploads.front()->pixels.size();
+        upload(*_uploads.front());
+        _uploads.pop_front();
+    }
+    _stats.bytesLastFrame = uploaded;
+
+    evict();
+}
+
+void TileStreamer::upload(Job &job)
+{
+    auto it = _tiles.find(job.key);
+    if (it == _tiles.end() || !it->second.pending)
+        return;
+    Tile &tile = it->second;
+
+    glGenTextures(1, &tile.texture);
+    GLState::bindTexture(GL_TEXTURE_2D, tile.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, job.tileSize, job.tileSize, 0, job.format, GL_UNSIGNED_BYTE, job.pixels.data());
+
+    tile.pending = false;
+    _pendingBytes -= tile.bytes;
+    if (tile.pinned)
+    {
+        _pinnedBytes += tile.bytes;
+    }
+    else
+    {
+        _lru.push_front(job.key);
+        tile.lru = _lru.begin();
+    }
+
+    _stats.pendingTiles--;
+    _stats.residentTiles++;
+    _stats.residentBytes += tile.bytes;
+    _stats.loaded++;
+}
+
+void TileStreamer::evict()
+{
+    // Do usado há mais tempo para o mais recente, pulando os usados no último frame: se eles não couberem,
+    // o limite fica estourado até a vista mudar. Os do prefetch que ainda não apareceram só saem numa segunda passada
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (auto it = _lru.end(); _stats.residentBytes > _memoryCap && it != _lru.begin();)
+        {
+            --it;
+            Tile &tile = _tiles[*it];
+            if (tile.lastUsed + 1 >= _frame || (pass == 0 && !tile.shown))
+                continue;
+
+            GLState::deleteTexture(tile.texture);
+            _stats.residentBytes -= tile.bytes;
+            _stats.residentTiles--;
+            _stats.evicted++;
+            _tiles.erase(*it);
+            it = _lru.erase(it);
+        }
+    }
+}
+
+void TileStreamer::clear()
+{
+    {
+        lock_guard<mutex> lock(_mutex);
+        _pending.clear();
+        _loaded.clear();
+        _generation++;
+    }
+    _uploads.clear();
+
+    for (auto &entry : _tiles)
+    {
+        if (entry.second.texture)
+            GLState::deleteTexture(entry.second.texture);
+    }
+    _tiles.clear();
+    _lru.clear();
+    _stats = Stats();
+    _usedBytes = _pinnedBytes = _pendingBytes = 0;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+#include "TiledImage.h"
+
+/*
+ * TileStreamer
+ *
+ * Desenho de imagens maiores que uma textura a partir dos .ptiles (pirâmide
+ * de tiles do tools/TextureCook --tiles). Só ficam na GL os tiles que cobrem
+ * a área vista, mais a margem pedida em prefetch(). As threads de trabalho
+ * copiam os tiles do arquivo mapeado (é ali que o disco é lido) e a thread da
+ * GL envia os prontos em update(), dentro de um orçamento de bytes por frame.
+ *
+ * Os tiles residentes ficam numa LRU com limite de memória: passando do
+ * limite, os usados há mais tempo são apagados, nunca os usados (vistos ou
+ * pedidos pelo prefetch) no último frame, e os do prefetch que ainda não
+ * apareceram só depois dos outros. O prefetch só pede tiles enquanto os
+ * usados no frame, o nível fixo e os pedidos em andamento couberem no
+ * limite; por isso todos os view() do frame vêm antes de qualquer
+ * prefetch(). O nível mais alto da pirâmide (um tile) fica sempre residente,
+ * e um tile que ainda não chegou é desenhado com o pedaço de um nível acima.
+ * Pedidos que saíram da vista antes de uma thread pegá-los são cancelados.
+ *
+ *   int image = tiles.open("../assets/sprites/chao.png");   // lê chao.ptiles
+ *   tiles.update();                                          // uma vez por frame
+ *   tiles.view(image, level, x0, y0, x1, y1, drawTiles);     // o que desenhar, para todas as imagens
+ *   tiles.prefetch(image, level, x0, y0, x1, y1);            // depois, a margem
+ *
+ * As coordenadas são pixels do nível 0, com y para baixo; em x a imagem se
+ * repete, para fundos que dão a volta. Os tiles usam GL_NEAREST e
+ * GL_CLAMP_TO_EDGE.
+ */
+class TileStreamer
+{
+public:
+    struct Stats
+    {
+        int residentTiles = 0;
+        size_t residentBytes = 0;
+        int pendingTiles = 0;
+        // Tiles vistos no frame que ainda não estavam residentes (foram desenhados com um nível acima)
+        int missing = 0;
+        int loaded = 0;
+        int evicted = 0;
+        int cancelled = 0;
+        size_t bytesLastFrame = 0;
+    };
+
+    // Um tile a desenhar: retângulo em pixels do nível 0 (x passa da largura nas voltas) e o pedaço da textura
+    struct DrawTile
+    {
+        GLuint texture;
+        float x0, y0, x1, y1;
+        float s0, t0, s1, t1;
+    };
+
+    TileStreamer(size_t memoryCap = 32 * 1024 * 1024, size_t bytesPerFrame = 4 * 1024 * 1024, int workers = 0);
+    ~TileStreamer();
+
+    // -1 se não houver um .ptiles válido ao lado da imagem
+    int open(const std::string &imagePath);
+
+    int width(int image) const { return int(_images[image]->header->width); }
+    int height(int image) const { return int(_images[image]->header->height); }
+    int levelCount(int image) const { return int(_images[image]->header->levelCount); }
+
+    // Nível para mostrar viewWidth x viewHeight pixels da imagem em screenWidth x screenHeight (a regra do loadTexture())
+    int levelFor(int image, float viewWidth, float viewHeight, int screenWidth, int screenHeight) const;
+
+    // Maior soma dos tiles de um nível que uma vista viewWidth x viewHeight (pixels do nível 0) pode cobrir
+    size_t viewBytes(int image, int level, float viewWidth, float viewHeight) const;
+
+    // Chamado pela thread da GL uma vez por frame, antes de view()
+    void update();
+
+    // Tiles que cobrem [x0, x1) x [y0, y1); os que faltam são pedidos antes de qualquer prefetch
+    void view(int image, int level, float x0, float y0, float x1, float y1, std::vector<DrawTile> &out);
+    // Pede os tiles da área sem desenhá-los, enquanto couberem no limite de memória; depois dos view() do frame
+    void prefetch(int image, int level, float x0, float y0, float x1, float y1);
+
+    bool busy() const { return _stats.pendingTiles > 0; }
+
+    void setMemoryCap(size_t bytes) { _memoryCap = bytes; }
+    size_t memoryCap() const { return _memoryCap; }
+
+    const Stats &stats() const { return _stats; }
+
+    void clear();
+
+private:
+    struct Image
+    {
+        MappedFile file;
+        const TiledImageHeader *header = nullptr;
+    };
+
+    struct Tile
+    {
+        GLuint texture = 0;
+        size_t bytes = 0;
+        bool pending = false;
+        bool pinned = false;
+        // Já apareceu em um view(): até lá, um tile do prefetch é o último a ser apagado
+        bool shown = false;
+        uint64_t lastUsed = 0;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    struct Job
+    {
+        uint64_t key;
+        // Valor de _generation quando o pedido foi feito: o que chega de antes de um clear() é descartado
+        uint64_t generation;
+        const uint8_t *src;
+        int tileSize;
+        GLenum format;
+        std::vector<uint8_t> pixels;
+    };
+
+    static uint64_t tileKey(int image, int level, int col, int row);
+
+    void workerLoop();
+    void forEachTile(int image, int level, float x0, float y0, float x1, float y1,
+                     const std::function<void(int, int, float)> &body) const;
+    bool request(int image, int level, int col, int row, bool visible, bool pinned);
+    void touch(Tile &tile, bool visible);
+    void upload(Job &job);
+    void evict();
+
+    std::vector<std::unique_ptr<Image>> _images;
+    std::unordered_map<uint64_t, Tile> _tiles;
+    // Residentes fora do nível fixo, do usado há menos tempo para o usado há mais
+    std::list<uint64_t> _lru;
+    size_t _memoryCap;
+    size_t _budget;
+    uint64_t _frame;
+    // O que não pode ser apagado agora: tiles usados neste frame, o nível fixo e os pedidos em andamento
+    size_t _usedBytes = 0;
+    size_t _pinnedBytes = 0;
+    size_t _pendingBytes = 0;
+    uint64_t _generation = 0;
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::deque<std::unique_ptr<Job>> _pending;
+    std::deque<std::unique_ptr<Job>> _loaded;
+    bool _quit;
+
+    std::deque<std::unique_ptr<Job>> _uploads;
+    Stats _stats;
+};
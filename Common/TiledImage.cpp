@@ -0,0 +1,117 @@
+#include "TiledImage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+static const uint64_t DATA_ALIGNMENT = 4096;
+
+string tiledImagePath(const string &imagePath)
+{
+    size_t dot = imagePath.find_last_of('.');
+    size_t slash = imagePath.find_last_of("/\\");
+    if (dot == string::npos || (slash != string::npos && dot < slash))
+        return imagePath + ".ptiles";
+    return imagePath.substr(0, dot) + ".ptiles";
+}
+
+const TiledImageHeader *tiledImageHeader(const MappedFile &file)
+{
+    if (!file.data() || file.size() < sizeof(TiledImageHeader))
+        return nullptr;
+
+    const TiledImageHeader *header = (const TiledImageHeader *)file.data();
+    if (header->magic != TILED_IMAGE_MAGIC || header->version != TILED_IMAGE_VERSION)
+        return nullptr;
+    if (header->levelCount == 0 || header->levelCount > TILED_IMAGE_MAX_LEVELS || header->tileSize == 0)
+        return nullptr;
+
+    const TiledImageLevel &last = header->levels[header->levelCount - 1];
+    uint64_t tiles = last.firstTile + uint64_t(last.cols) * last.rows;
+    if (header->dataOffset + tiles * tiledImageTileBytes(*header) > file.size())
+        return nullptr;
+    return header;
+}
+
+const uint8_t *tiledImageTile(const MappedFile &file, const TiledImageHeader &header, int level, int col, int row)
+{
+    const TiledImageLevel &l = header.levels[level];
+    uint64_t index = l.firstTile + uint64_t(row) * l.cols + col;
+    return file.data() + header.dataOffset + index * tiledImageTileBytes(header);
+}
+
+bool writeTiledImage(const string &path, const vector<vector<uint8_t>> &levels, int width, int height, int tileSize,
+                     TextureFileLayout layout, uint64_t sourceSize, uint32_t filter)
+{
+    if (levels.empty() || tileSize <= 0)
+        return false;
+
+    TiledImageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TILED_IMAGE_MAGIC;
+    header.version = TILED_IMAGE_VERSION;
+    header.width = width;
+    header.height = height;
+    header.tileSize = tileSize;
+    header.layout = layout;
+    header.filter = filter;
+    header.sourceSize = sourceSize;
+    header.dataOffset = (sizeof(header) + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+
+    // Até o primeiro nível que cabe num tile
+    uint64_t firstTile = 0;
+    for (size_t i = 0; i < levels.size() && int(i) < TILED_IMAGE_MAX_LEVELS; i++)
+    {
+        TiledImageLevel &level = header.levels[i];
+        level.width = max(1, width >> int(i));
+        level.height = max(1, height >> int(i));
+        level.cols = (level.width + tileSize - 1) / tileSize;
+        level.rows = (level.height + tileSize - 1) / tileSize;
+        level.firstTile = firstTile;
+        firstTile += uint64_t(level.cols) * level.rows;
+        header.levelCount++;
+        if (level.cols == 1 && level.rows == 1)
+            break;
+    }
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file)
+        return false;
+
+    vector<uint8_t> padding(header.dataOffset - sizeof(header), 0);
+    file.write((const char *)&header, sizeof(header));
+    file.write((const char *)padding.data(), padding.size());
+
+    vector<uint8_t> tile(tiledImageTileBytes(header));
+    for (uint32_t l = 0; l < header.levelCount; l++)
+    {
+        const TiledImageLevel &level = header.levels[l];
+        const uint8_t *pixels = levels[l].data();
+        for (uint32_t row = 0; row < level.rows; row++)
+        {
+            for (uint32_t col = 0; col < level.cols; col++)
+            {
+                // Fora da imagem repete o último pixel da linha e a última linha
+                for (int y = 0; y < tileSize; y++)
+                {
+                    uint32_t sy = min(level.height - 1, row * tileSize + y);
+                    uint8_t *dst = tile.data() + size_t(y) * tileSize * 4;
+                    for (int x = 0; x < tileSize; x++)
+                    {
+                        uint32_t sx = min(level.width - 1, col * tileSize + x);
+                        memcpy(dst + x * 4, pixels + (size_t(sy) * level.width + sx) * 4, 4);
+                    }
+                }
+                if (layout == LAYOUT_BGRA)
+                {
+                    for (size_t p = 0; p < tile.size(); p += 4)
+                        swap(tile[p], tile[p + 2]);
+                }
+                file.write((const char *)tile.data(), tile.size());
+            }
+        }
+    }
+    return bool(file);
+}
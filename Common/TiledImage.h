@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TextureFile.h"
+
+/*
+ * Formato .ptiles: pirâmide de tiles de uma imagem grande demais para uma
+ * textura só (ou para ficar inteira na memória), para ser lida tile a tile
+ * pelo TileStreamer.
+ *
+ * Cada nível da cadeia de mipmaps é cortado em tiles de tileSize x tileSize
+ * pixels (4 bytes por pixel, RGBA ou BGRA como no .ptex), gravados linha a
+ * linha de tiles. Os tiles da borda direita e de baixo são completados
+ * repetindo o último pixel, então todos têm o mesmo tamanho e o tile (c, r)
+ * do nível l está em dataOffset + (levels[l].firstTile + r * cols + c) * bytes.
+ * A pirâmide para no primeiro nível que cabe num tile só.
+ *
+ * Os arquivos são gerados pelo tools/TextureCook --tiles e ficam ao lado do
+ * PNG de origem (chao.png -> chao.ptiles).
+ */
+
+const uint32_t TILED_IMAGE_MAGIC = 0x4C495450; // "PTIL"
+const uint32_t TILED_IMAGE_VERSION = 2;
+const int TILED_IMAGE_MAX_LEVELS = 16;
+
+struct TiledImageLevel
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t cols;
+    uint32_t rows;
+    uint64_t firstTile;
+};
+
+struct TiledImageHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileSize;
+    uint32_t layout;
+    uint32_t levelCount;
+    uint32_t filter; // MipFilter dos níveis, como no .ptex
+    uint64_t sourceSize;
+    uint64_t dataOffset;
+    TiledImageLevel levels[TILED_IMAGE_MAX_LEVELS];
+};
+
+// .ptiles correspondente a uma imagem: "../assets/sprites/chao.png" -> "../assets/sprites/chao.ptiles"
+std::string tiledImagePath(const std::string &imagePath);
+
+// Valida e devolve o cabeçalho de um .ptiles mapeado, ou nullptr se o arquivo for inválido
+const TiledImageHeader *tiledImageHeader(const MappedFile &file);
+
+inline size_t tiledImageTileBytes(const TiledImageHeader &header)
+{
+    return size_t(header.tileSize) * header.tileSize * 4;
+}
+
+// Pixels do tile (col, row) do nível level, dentro do arquivo mapeado
+const uint8_t *tiledImageTile(const MappedFile &file, const TiledImageHeader &header, int level, int col, int row);
+
+// Grava um .ptiles a partir da cadeia de níveis RGBA do buildMipChain() (levels[0] é a imagem original);
+// filter é o MipFilter dos níveis
+bool writeTiledImage(const std::string &path, const std::vector<std::vector<uint8_t>> &levels, int width, int height,
+                     int tileSize, TextureFileLayout layout, uint64_t sourceSize, uint32_t filter = 0);
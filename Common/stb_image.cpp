@@ -0,0 +1,3 @@
+// Implementação única da stb_image para todos os executáveis
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
@@ -34,14 +34,14 @@ using namespace std;
 
 #include <GLFW/glfw3.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
+#include "Shader.h"
+#include "Texture.h"
+#include "Profiler.h"
+#include "MainLoop.h"
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
-int setupShader();
 int setupGeometry();
-int loadTexture(string filePath);
 
 const GLuint WIDTH = 800, HEIGHT = 800;
 
@@ -110,11 +110,14 @@ int main()
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
-    GLuint shaderID = setupShader();
+    Profiler::init("HelloTexture");
+
+    GLuint shaderID = createShaderProgram(vertexShaderSource, fragmentShaderSource);
 
     GLuint VAO = setupGeometry();
 
-    GLuint texID = loadTexture("../assets/textures/pixelWall.png");
+    // O quad vai de -0.5 a 0.5: ocupa metade da janela em cada eixo
+    GLuint texID = loadTexture("../assets/textures/pixelWall.png", GL_LINEAR, GL_REPEAT, nullptr, nullptr, WIDTH / 2, HEIGHT / 2);
 
     glUseProgram(shaderID);
 
@@ -127,7 +130,9 @@ int main()
 
     glUniform1i(glGetUniformLocation(shaderID, "tex_buff"), 0);
 
-    while (!glfwWindowShouldClose(window))
+    // A cena é estática: só desenha com eventos, e o título espera o próximo frame
+    MainLoop loop(window);
+    auto renderFrame = [&]()
     {
         {
             double curr_s = glfwGetTime();
@@ -137,83 +142,45 @@ int main()
             title_countdown_s -= elapsed_s;
             if (title_countdown_s <= 0.0 && elapsed_s > 0.0)
             {
-                double fps = 1.0 / elapsed_s;
-
                 char tmp[256];
-                sprintf(tmp, "Ola Triangulo! -- Rossana\tFPS %.2lf", fps);
+                snprintf(tmp, sizeof(tmp), "Ola Triangulo! -- Rossana\t%s", Profiler::frameSummary());
                 glfwSetWindowTitle(window, tmp);
 
                 title_countdown_s = 0.1;
             }
         }
 
-        glfwPollEvents();
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        {
+            ProfileScope cpu("draw");
+            GpuProfileScope gpu("draw");
 
-        glLineWidth(10);
-        glPointSize(20);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
 
-        glBindVertexArray(VAO);
-        glBindTexture(GL_TEXTURE_2D, texID);
+            glLineWidth(10);
+            glPointSize(20);
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+            glBindVertexArray(VAO);
+            glBindTexture(GL_TEXTURE_2D, texID);
 
-        glfwSwapBuffers(window);
-    }
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+    };
+    loop.run(renderFrame);
     glDeleteVertexArrays(1, &VAO);
+    Profiler::shutdown();
     glfwTerminate();
     return 0;
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+    Profiler::handleKey(key, action);
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
 }
 
-int setupShader()
-{
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return shaderProgram;
-}
-
 int setupGeometry()
 {
     GLfloat vertices[] = {
@@ -253,44 +220,3 @@ int setupGeometry()
 
     return VAO;
 }
-
-int loadTexture(string filePath)
-{
-    GLuint texID;
-
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-
-    unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data)
-    {
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        }
-        else
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        }
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-
-    stbi_image_free(data);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    return texID;
-}
\ No newline at end of file
@@ -24,6 +24,10 @@ using namespace std;
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "Shader.h"
+#include "ShaderProgram.h"
+#include "Profiler.h"
+
 using namespace glm;
 
 #include <cmath>
@@ -32,7 +36,6 @@ using namespace glm;
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
 // Protótipos das funções
-int setupShader();
 int setupGeometry();
 
 // Dimensões da janela (pode ser alterado em tempo de execução)
@@ -98,23 +101,24 @@ int main()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
+	Profiler::init("HelloTransform");
+
 	// Compilando e buildando o programa de shader
-	GLuint shaderID = setupShader();
+	ShaderProgram shader(createShaderProgram(vertexShaderSource, fragmentShaderSource));
 
 	// Gerando um buffer simples, com a geometria de um triângulo
 	GLuint VAO = setupGeometry();
 
-	glUseProgram(shaderID);
+	shader.use();
 
 	// Enviando a cor desejada (vec4) para o fragment shader
 	// Utilizamos a variáveis do tipo uniform em GLSL para armazenar esse tipo de info
-	// que não está nos buffers
-	GLint colorLoc = glGetUniformLocation(shaderID, "inputColor");
+	// que não está nos buffers. As locations são lidas uma vez pelo ShaderProgram
 
 	// Matriz de projeção paralela ortográfica
 	// mat4 projection = ortho(-10.0, 10.0, -10.0, 10.0, -1.0, 1.0);
 	mat4 projection = ortho(0.0, 800.0, 0.0, 600.0, -1.0, 1.0);
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+	shader.setMat4("projection"_u, projection);
 
 	// Matriz de modelo: transformações na geometria (objeto)
 	mat4 model = mat4(1); // matriz identidade
@@ -124,53 +128,67 @@ int main()
 	model = rotate(model, radians(45.0f), vec3(0.0, 0.0, 1.0));
 	// Escala
 	model = scale(model, vec3(300.0, 300.0, 1.0));
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+	shader.setMat4("model"_u, model);
 
 	// Loop da aplicação - "game loop"
 	while (!glfwWindowShouldClose(window))
 	{
+		Profiler::beginFrame();
+
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
 		glfwPollEvents();
 
-		// Matriz de modelo: transformações na geometria (objeto)
-		model = mat4(1); // matriz identidade
-		// Translação
-		model = translate(model, vec3(400.0, 300.0, 0.0));
-		model = rotate(model, (float)glfwGetTime(), vec3(0.0, 0.0, 1.0));
-		// Escala
-		model = scale(model, vec3(abs(cos(glfwGetTime())) * 300.0, abs(cos(glfwGetTime())) * 300.0, 1.0));
-		glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+		{
+			ProfileScope cpu("update");
+
+			ShaderProgram::resetFrameStats();
+
+			// Matriz de modelo: transformações na geometria (objeto)
+			model = mat4(1); // matriz identidade
+			// Translação
+			model = translate(model, vec3(400.0, 300.0, 0.0));
+			model = rotate(model, (float)glfwGetTime(), vec3(0.0, 0.0, 1.0));
+			// Escala
+			model = scale(model, vec3(abs(cos(glfwGetTime())) * 300.0, abs(cos(glfwGetTime())) * 300.0, 1.0));
+			shader.setMat4("model"_u, model);
+		}
 
-		// Limpa o buffer de cor
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
-		glClear(GL_COLOR_BUFFER_BIT);
+		{
+			ProfileScope cpu("draw");
+			GpuProfileScope gpu("draw");
 
-		glLineWidth(10);
-		glPointSize(20);
+			// Limpa o buffer de cor
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
+			glClear(GL_COLOR_BUFFER_BIT);
 
-		glBindVertexArray(VAO); // Conectando ao buffer de geometria
+			glLineWidth(10);
+			glPointSize(20);
 
-		glUniform4f(colorLoc, 0.0f, 0.0f, abs(cos(glfwGetTime())), 1.0f); // enviando cor para variável uniform inputColor
-		// Chamada de desenho - drawcall
-		// Poligono Preenchido - GL_TRIANGLES
-		glDrawArrays(GL_TRIANGLES, 0, 3);
+			glBindVertexArray(VAO); // Conectando ao buffer de geometria
 
-		// Desenho com contorno (linhas)
-		// glUniform4f(colorLoc, 1.0f, 0.0f, 1.0f, 1.0f); //enviando cor para variável uniform inputColor
-		// glDrawArrays(GL_LINE_LOOP, 0, 3); //Desenha T0
-		// glDrawArrays(GL_LINE_LOOP, 3, 3); //Desenha T1
+			shader.setVec4("inputColor"_u, 0.0f, 0.0f, abs(cos(glfwGetTime())), 1.0f); // enviando cor para variável uniform inputColor
+			// Chamada de desenho - drawcall
+			// Poligono Preenchido - GL_TRIANGLES
+			glDrawArrays(GL_TRIANGLES, 0, 3);
 
-		// Desenho só dos pontos (vértices)
-		// glUniform4f(colorLoc, 1.0f, 1.0f, 0.0f, 1.0f); //enviando cor para variável uniform inputColor
-		// glDrawArrays(GL_POINTS, 0, 6);
+			// Desenho com contorno (linhas)
+			// shader.setVec4("inputColor"_u, 1.0f, 0.0f, 1.0f, 1.0f); //enviando cor para variável uniform inputColor
+			// glDrawArrays(GL_LINE_LOOP, 0, 3); //Desenha T0
+			// glDrawArrays(GL_LINE_LOOP, 3, 3); //Desenha T1
 
-		glBindVertexArray(0); // Desconectando o buffer de geometria
+			// Desenho só dos pontos (vértices)
+			// shader.setVec4("inputColor"_u, 1.0f, 1.0f, 0.0f, 1.0f); //enviando cor para variável uniform inputColor
+			// glDrawArrays(GL_POINTS, 0, 6);
+
+			glBindVertexArray(0); // Desconectando o buffer de geometria
+		}
 
 		// Troca os buffers da tela
 		glfwSwapBuffers(window);
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
+	Profiler::shutdown();
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
 	return 0;
@@ -181,62 +199,12 @@ int main()
 // ou solta via GLFW
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+	Profiler::handleKey(key, action);
+
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
 }
 
-// Esta função está basntante hardcoded - objetivo é compilar e "buildar" um programa de
-//  shader simples e único neste exemplo de código
-//  O código fonte do vertex e fragment shader está nos arrays vertexShaderSource e
-//  fragmentShader source no iniçio deste arquivo
-//  A função retorna o identificador do programa de shader
-int setupShader()
-{
-	// Vertex shader
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	// Fragment shader
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	// Checando erros de compilação (exibição via log no terminal)
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	// Linkando os shaders e criando o identificador do programa de shader
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	// Checando por erros de linkagem
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
-
 // Esta função está bastante harcoded - objetivo é criar os buffers que armazenam a
 // geometria de um triângulo
 // Apenas atributo coordenada nos vértices
@@ -8,12 +8,14 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "Shader.h"
+#include "Profiler.h"
+#include "MainLoop.h"
 
 using namespace std;
 using namespace glm;
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
-int setupShader();
 GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2);
 
 const GLuint WIDTH = 800, HEIGHT = 600;
@@ -63,7 +65,9 @@ int main()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
-	GLuint shaderID = setupShader();
+	Profiler::init("M2Parte1");
+
+	GLuint shaderID = createShaderProgram(vertexShaderSource, fragmentShaderSource);
 
 	vector<GLuint> VAOs;
 	VAOs.push_back(createTriangle(-1, 0.9, -0.9, 1, -0.8, 0.9));
@@ -81,89 +85,51 @@ int main()
 
 	glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(mat4(1)));
 
-	while (!glfwWindowShouldClose(window))
+	// A cor pisca com o tempo: um timer de 30 Hz basta, em vez de um frame por volta do laço
+	MainLoop loop(window);
+	loop.setAnimationInterval(1.0 / 30.0);
+	auto renderFrame = [&]()
 	{
-		glfwPollEvents();
-
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+		{
+			ProfileScope cpu("draw");
+			GpuProfileScope gpu("draw");
 
-		glLineWidth(10);
-		glPointSize(20);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
 
-		for (int i = 0; i < VAOs.size(); i++)
-		{
-			glBindVertexArray(VAOs[i]);
-			glDrawArrays(GL_TRIANGLES, 0, 3);
-			glUniform4f(colorLoc, 0.0f, 0.0f, abs(cos(glfwGetTime())), 1.0f);
-		}
+			glLineWidth(10);
+			glPointSize(20);
 
-		glBindVertexArray(0);
+			for (int i = 0; i < VAOs.size(); i++)
+			{
+				glBindVertexArray(VAOs[i]);
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+				glUniform4f(colorLoc, 0.0f, 0.0f, abs(cos(glfwGetTime())), 1.0f);
+			}
 
-		glfwSwapBuffers(window);
-	}
+			glBindVertexArray(0);
+		}
+	};
+	loop.run(renderFrame);
 
 	for (int i = 0; i < VAOs.size(); i++)
 	{
 		glDeleteVertexArrays(1, &VAOs[i]);
 	}
 
+	Profiler::shutdown();
 	glfwTerminate();
 	return 0;
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+	Profiler::handleKey(key, action);
+
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
 }
 
-int setupShader()
-{
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
-
 GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2)
 {
 	GLuint VBO, VAO;
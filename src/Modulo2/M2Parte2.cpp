@@ -8,13 +8,15 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "Shader.h"
+#include "ShaderProgram.h"
+#include "Profiler.h"
 
 using namespace std;
 using namespace glm;
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
-int setupShader();
 GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2);
 
 const GLuint WIDTH = 800, HEIGHT = 600;
@@ -87,48 +89,58 @@ int main()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
-	GLuint shaderID = setupShader();
+	Profiler::init("M2Parte2");
+
+	ShaderProgram shader(createShaderProgram(vertexShaderSource, fragmentShaderSource));
 
 	GLuint VAO = createTriangle(-0.5, -0.5, 0.5, -0.5, 0.0, 0.5);
 	triangles.push_back({vec3(double(WIDTH) / 2, double(HEIGHT) / 2, 1.0), vec3(100.0, 100.0, 1.0), vec3(1.0, 0.0, 0.0)});
 
-	glUseProgram(shaderID);
-
-	GLint colorLoc = glGetUniformLocation(shaderID, "inputColor");
+	shader.use();
 
 	mat4 projection = ortho(0.0, (double)WIDTH, 0.0, (double)HEIGHT, -1.0, 1.0);
-	glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+	shader.setMat4("projection"_u, projection);
 
 	while (!glfwWindowShouldClose(window))
 	{
+		Profiler::beginFrame();
+
 		glfwPollEvents();
 
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+		ShaderProgram::resetFrameStats();
 
-		glLineWidth(10);
-		glPointSize(20);
+		{
+			ProfileScope cpu("draw");
+			GpuProfileScope gpu("draw");
 
-		glBindVertexArray(VAO);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
 
-		for (int i = 0; i < triangles.size(); i++)
-		{
-			Triangle triangle = triangles[i];
-			mat4 model = mat4(1);
-			model = translate(model, triangle.position);
-			model = scale(model, triangle.dimensions);
-			glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
-			glUniform4f(colorLoc, triangle.color.r, triangle.color.g, triangle.color.b, 1.0f);
-			glDrawArrays(GL_TRIANGLES, 0, 3);
-		}
+			glLineWidth(10);
+			glPointSize(20);
 
-		glBindVertexArray(0);
+			glBindVertexArray(VAO);
+
+			for (int i = 0; i < triangles.size(); i++)
+			{
+				Triangle triangle = triangles[i];
+				mat4 model = mat4(1);
+				model = translate(model, triangle.position);
+				model = scale(model, triangle.dimensions);
+				shader.setMat4("model"_u, model);
+				shader.setVec4("inputColor"_u, triangle.color.r, triangle.color.g, triangle.color.b, 1.0f);
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+			}
+
+			glBindVertexArray(0);
+		}
 
 		glfwSwapBuffers(window);
 	}
 
 	glDeleteVertexArrays(1, &VAO);
 
+	Profiler::shutdown();
 	glfwTerminate();
 	return 0;
 }
@@ -145,56 +157,12 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+	Profiler::handleKey(key, action);
+
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
 }
 
-int setupShader()
-{
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
-}
-
 GLuint createTriangle(float x0, float y0, float x1, float y1, float x2, float y2)
 {
 	GLuint VBO, VAO;
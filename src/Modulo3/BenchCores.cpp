@@ -0,0 +1,485 @@
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <glm/glm.hpp>
+#include "ColorMatch.h"
+#include "ColorIndex.h"
+#include "ColorGrid.h"
+#include "ColorLab.h"
+#include "ColorGame.h"
+#include "ColorRegions.h"
+#include "CpuFeatures.h"
+#include "CounterRng.h"
+#include "ThreadPool.h"
+using namespace std;
+using namespace glm;
+
+/*
+ * Benchmark da eliminação do Jogo das Cores, sem janela.
+ *
+ * Para cada tamanho de grade, sorteia as cores e mede um clique com
+ * tolerância 0.2 (a do jogo): o laço antigo do eliminarSimilares (structs Quad de 40
+ * bytes, sqrt/pow em double) contra matchColors() com as cores em planos
+ * separados, em cada kernel, e a consulta ao ColorIndex, que só visita os
+ * baldes de cor ao alcance da tolerância. Os tempos incluem marcar (ou tirar
+ * do índice) as células eliminadas; "montagem" é o tempo de indexar a grade e
+ * "testadas" a fração das células que a consulta comparou uma a uma.
+ *
+ * Depois compara as métricas RGB e L*a*b* (ColorLab.h): o tempo de converter
+ * a grade para Lab (uma thread e todas), o clique pelo ColorIndex em cada
+ * métrica e, para referência, o clique em Lab convertendo cada célula na hora
+ * (pow e raiz cúbica por célula, só 2 cliques). "elim" é a fração média da
+ * grade eliminada por clique.
+ *
+ * A regra por região (ColorRegions.h) é medida em seguida: o tempo de rotular
+ * as regiões 4 e 8-conexas da grade (uma thread e todas) e um clique
+ * percorrendo a região contra um clique pelos rótulos, em microssegundos,
+ * com REGION_CLICKS cliques em células vivas sorteadas. "iguais" confere que
+ * os dois caminhos eliminaram as mesmas células.
+ *
+ * Por fim, mede o sorteio das cores da grade: três rand() por célula, como o
+ * inicializaJogo fazia, contra o gerador por contador (CounterRng.h) em cada
+ * kernel e dividido entre as threads.
+ *
+ * Uso:
+ *   BenchCores [--seed N] [cliques] [tolerância]    (padrão: semente 1, 16 cliques por grade, tolerância 0.2)
+ *
+ * A coluna "iguais" confere se todos os caminhos eliminaram as mesmas células.
+ * A única diferença aceita é a de células exatamente na borda da tolerância
+ * (d² == limite): o laço antigo, em float, às vezes as descarta por
+ * arredondamento; a coluna "borda" conta quantas foram.
+ */
+
+float tolerance = 0.2f;
+const float dMax = sqrt(3.0);
+
+struct GridSize
+{
+    int cols, rows;
+};
+
+const int REGION_CLICKS = 2000;
+
+const GridSize GRIDS[] = {{160, 120}, {320, 240}, {640, 480}, {1280, 960}, {1920, 1080}, {4096, 4096}};
+
+// Layout e laço do JogoCores antes dos planos de cor
+struct LegacyQuad
+{
+    vec3 position;
+    vec3 dimensions;
+    vec3 color;
+    bool eliminated;
+};
+
+int eliminateLegacy(vector<LegacyQuad> &grid, int rows, int cols, int selected, float tolerancia)
+{
+    int eliminatedCount = 0;
+    vec3 C = grid[selected].color;
+    grid[selected].eliminated = true;
+    for (int i = 0; i < rows; i++)
+    {
+        for (int j = 0; j < cols; j++)
+        {
+            vec3 O = grid[i * cols + j].color;
+            float d = sqrt(pow(C.r - O.r, 2) + pow(C.g - O.g, 2) + pow(C.b - O.b, 2));
+            float dd = d / dMax;
+            if (dd <= tolerancia)
+            {
+                if (grid[i * cols + j].eliminated)
+                    continue;
+                grid[i * cols + j].eliminated = true;
+                eliminatedCount++;
+            }
+        }
+    }
+    return eliminatedCount;
+}
+
+struct ColorPlanes
+{
+    vector<uint8_t> r, g, b;
+    vector<uint8_t> eliminated;
+    vector<uint64_t> mask;
+};
+
+int eliminateIndexed(ColorIndex &index, const ColorPlanes &planes, int selected, float tolerancia,
+                     vector<uint32_t> &similar)
+{
+    const uint8_t C[3] = {planes.r[selected], planes.g[selected], planes.b[selected]};
+    index.remove(selected, C);
+
+    similar.clear();
+    return int(index.removeSimilar(C, colorToleranceLimit(tolerancia), similar));
+}
+
+int eliminatePlanes(ColorPlanes &planes, int selected, float tolerancia, ColorKernel kernel)
+{
+    int eliminatedCount = 0;
+    const uint8_t C[3] = {planes.r[selected], planes.g[selected], planes.b[selected]};
+    planes.eliminated[selected] = 1;
+
+    matchColors(planes.r.data(), planes.g.data(), planes.b.data(), planes.r.size(), C, colorToleranceLimit(tolerancia),
+                planes.mask.data(), kernel);
+    for (size_t w = 0; w < planes.mask.size(); w++)
+    {
+        for (uint64_t bits = planes.mask[w]; bits; bits &= bits - 1)
+        {
+            size_t idx = w * 64 + countTrailingZeros64(bits);
+            if (planes.eliminated[idx])
+                continue;
+            planes.eliminated[idx] = 1;
+            eliminatedCount++;
+        }
+    }
+    return eliminatedCount;
+}
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Melhor tempo de um clique pelo ColorIndex nos planos da métrica da grade; soma em eliminated a fração eliminada
+double indexClickMs(const ColorGrid &colors, const vector<int> &selected, double &eliminated)
+{
+    ColorIndex index;
+    vector<uint32_t> similar;
+    int limit = colorMetricLimit(tolerance, colors.metric());
+    double ms = 1e30;
+    eliminated = 0.0;
+    for (int cell : selected)
+    {
+        index.build(colors.matchPlane(0), colors.matchPlane(1), colors.matchPlane(2), colors.size());
+
+        auto start = chrono::steady_clock::now();
+        uint8_t C[3];
+        colors.matchColor(cell, C);
+        index.remove(cell, C);
+        similar.clear();
+        index.removeSimilar(C, limit, similar);
+        ms = min(ms, elapsedMs(start));
+        eliminated += double(similar.size() + 1) / colors.size() / selected.size();
+    }
+    return ms;
+}
+
+// Clique em Lab sem os planos convertidos: converte cada célula na hora, em float
+double directLabClickMs(const ColorGrid &colors, const vector<int> &selected)
+{
+    float limit = LAB_MAX_DISTANCE * tolerance;
+    limit *= limit;
+    double ms = 1e30;
+    for (int cell : selected)
+    {
+        auto start = chrono::steady_clock::now();
+        float C[3], O[3];
+        srgbToLab(colors.red()[cell], colors.green()[cell], colors.blue()[cell], C);
+        size_t eliminatedCount = 0;
+        for (size_t i = 0; i < colors.size(); i++)
+        {
+            srgbToLab(colors.red()[i], colors.green()[i], colors.blue()[i], O);
+            float dL = C[0] - O[0], da = C[1] - O[1], db = C[2] - O[2];
+            eliminatedCount += dL * dL + da * da + db * db <= limit;
+        }
+        ms = min(ms, elapsedMs(start));
+        // Mantém o laço vivo no -O2
+        if (eliminatedCount > colors.size())
+            cout << eliminatedCount << endl;
+    }
+    return ms;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seed = takeSeedOption(argc, argv, 1);
+    int clicks = argc > 1 ? max(1, atoi(argv[1])) : 16;
+    if (argc > 2)
+        tolerance = float(atof(argv[2]));
+
+    cout << "Kernel automático: " << colorKernelName(resolveColorKernel(COLOR_KERNEL_AUTO)) << endl;
+    cout << "Tolerância " << tolerance << ", " << clicks << " cliques por grade (ms por clique, melhor caso), semente "
+         << seed << endl;
+
+    const ColorKernel kernels[] = {COLOR_KERNEL_SCALAR, COLOR_KERNEL_SSE2, COLOR_KERNEL_AVX2, COLOR_KERNEL_AVX512};
+
+    printf("%-11s %10s %10s %10s %10s %10s %10s %10s %8s %10s %9s %8s %6s\n", "grade", "células", "atual", "escalar",
+           "sse2", "avx2", "avx512", "índice", "ganho", "montagem", "testadas", "iguais", "borda");
+
+    for (const GridSize &size : GRIDS)
+    {
+        size_t count = size_t(size.cols) * size.rows;
+
+        vector<LegacyQuad> grid(count);
+        ColorPlanes planes;
+        planes.r.resize(count);
+        planes.g.resize(count);
+        planes.b.resize(count);
+        planes.eliminated.resize(count);
+        planes.mask.resize(colorMaskWords(count));
+        fillRandomColors(rngKey(seed), 0, count, planes.r.data(), planes.g.data(), planes.b.data());
+        for (size_t i = 0; i < count; i++)
+            grid[i].color = vec3(planes.r[i] / 255.0, planes.g[i] / 255.0, planes.b[i] / 255.0);
+
+        RngKey clickKey = rngKey(seed + 1);
+        vector<int> selected(clicks);
+        for (int c = 0; c < clicks; c++)
+            selected[c] = int(counterRandom(clickKey, c) % count);
+
+        // Cada clique parte da grade inteira, então os caminhos comparam o mesmo trabalho
+        double legacyMs = 1e30;
+        vector<vector<uint8_t>> reference(clicks);
+        for (int c = 0; c < clicks; c++)
+        {
+            for (LegacyQuad &quad : grid)
+                quad.eliminated = false;
+            auto start = chrono::steady_clock::now();
+            eliminateLegacy(grid, size.rows, size.cols, selected[c], tolerance);
+            legacyMs = min(legacyMs, elapsedMs(start));
+
+            reference[c].resize(count);
+            for (size_t i = 0; i < count; i++)
+                reference[c][i] = grid[i].eliminated;
+        }
+
+        int limit = colorToleranceLimit(tolerance);
+        auto onBorder = [&](size_t i, int selectedCell)
+        {
+            int dr = planes.r[i] - planes.r[selectedCell];
+            int dg = planes.g[i] - planes.g[selectedCell];
+            int db = planes.b[i] - planes.b[selectedCell];
+            return dr * dr + dg * dg + db * db == limit;
+        };
+
+        double ms[4] = {0.0, 0.0, 0.0, 0.0};
+        double best = legacyMs;
+        bool same = true;
+        size_t border = 0;
+        for (int k = 0; k < 4; k++)
+        {
+            // Kernel sem suporte nesta CPU aparece com 0.000 na tabela
+            if (resolveColorKernel(kernels[k]) != kernels[k])
+                continue;
+            ms[k] = 1e30;
+            for (int c = 0; c < clicks; c++)
+            {
+                fill(planes.eliminated.begin(), planes.eliminated.end(), 0);
+                auto start = chrono::steady_clock::now();
+                eliminatePlanes(planes, selected[c], tolerance, kernels[k]);
+                ms[k] = min(ms[k], elapsedMs(start));
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (planes.eliminated[i] == reference[c][i])
+                        continue;
+                    same = same && onBorder(i, selected[c]);
+                    border += k == 0;
+                }
+            }
+            best = min(best, ms[k]);
+        }
+
+        // O índice é remontado (fora do tempo) antes de cada clique
+        ColorIndex index;
+        vector<uint32_t> similar;
+        double indexMs = 1e30, buildMs = 1e30, tested = 0.0;
+        for (int c = 0; c < clicks; c++)
+        {
+            auto start = chrono::steady_clock::now();
+            index.build(planes.r.data(), planes.g.data(), planes.b.data(), count);
+            buildMs = min(buildMs, elapsedMs(start));
+
+            start = chrono::steady_clock::now();
+            eliminateIndexed(index, planes, selected[c], tolerance, similar);
+            indexMs = min(indexMs, elapsedMs(start));
+            tested += double(index.lastQuery().tested) / count / clicks;
+
+            fill(planes.eliminated.begin(), planes.eliminated.end(), 0);
+            planes.eliminated[selected[c]] = 1;
+            for (uint32_t idx : similar)
+                planes.eliminated[idx] = 1;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (planes.eliminated[i] != reference[c][i])
+                    same = same && onBorder(i, selected[c]);
+            }
+        }
+        best = min(best, indexMs);
+
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", size.cols, size.rows);
+        printf("%-11s %10zu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %7.1fx %10.3f %8.1f%% %8s %6zu\n", name, count,
+               legacyMs, ms[0], ms[1], ms[2], ms[3], indexMs, legacyMs / max(best, 0.0001), buildMs, tested * 100.0,
+               same ? "sim" : "NÃO", border);
+    }
+
+    ThreadPool pool;
+
+    // Métricas: conversão para Lab (melhor de 3) e cliques pelo índice em cada métrica
+    printf("\nMétricas (ms), %d threads\n", pool.size());
+    printf("%-11s %10s %10s %10s %10s %12s %9s %9s\n", "grade", "conversão", "threads", "rgb", "lab", "lab direto",
+           "elim rgb", "elim lab");
+    for (const GridSize &size : GRIDS)
+    {
+        ColorGrid colors;
+        colors.reset(size.cols, size.rows);
+        colors.randomize(seed, &pool);
+        vector<uint8_t> L(colors.size()), A(colors.size()), B(colors.size());
+
+        double convertMs = 1e30, poolMs = 1e30;
+        for (int rep = 0; rep < 3; rep++)
+        {
+            auto start = chrono::steady_clock::now();
+            convertToLab(colors.red(), colors.green(), colors.blue(), colors.size(), L.data(), A.data(), B.data());
+            convertMs = min(convertMs, elapsedMs(start));
+
+            start = chrono::steady_clock::now();
+            colors.setMetric(COLOR_METRIC_LAB, &pool);
+            poolMs = min(poolMs, elapsedMs(start));
+        }
+
+        RngKey clickKey = rngKey(seed + 1);
+        vector<int> selected(clicks);
+        for (int c = 0; c < clicks; c++)
+            selected[c] = int(counterRandom(clickKey, c) % colors.size());
+
+        double rgbElim, labElim;
+        colors.setMetric(COLOR_METRIC_RGB);
+        double rgbMs = indexClickMs(colors, selected, rgbElim);
+        colors.setMetric(COLOR_METRIC_LAB, &pool);
+        double labMs = indexClickMs(colors, selected, labElim);
+        double directMs = directLabClickMs(colors, vector<int>(selected.begin(), selected.begin() + min(clicks, 2)));
+
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", size.cols, size.rows);
+        printf("%-11s %10.3f %10.3f %10.3f %10.3f %12.3f %8.1f%% %8.1f%%\n", name, convertMs, poolMs, rgbMs, labMs,
+               directMs, rgbElim * 100.0, labElim * 100.0);
+    }
+
+    // Regiões: rótulos (melhor de 3) e cliques pelos dois caminhos na mesma sequência de células
+    printf("\nRegiões (ms, cliques em µs), %d threads\n", pool.size());
+    printf("%-11s %-9s %10s %10s %10s %8s %10s %10s %8s\n", "grade", "vizinhos", "rótulos", "threads", "regiões", "maior",
+           "percorre", "rótulo", "iguais");
+    for (const GridSize &size : GRIDS)
+    {
+        for (ColorConnectivity connectivity : {COLOR_CONNECT_4, COLOR_CONNECT_8})
+        {
+            ColorGrid colors;
+            colors.reset(size.cols, size.rows);
+            colors.randomize(seed, &pool);
+            int limit = colorMetricLimit(tolerance, COLOR_METRIC_RGB);
+
+            ColorRegions regions;
+            double buildMs = 1e30, poolMs = 1e30;
+            for (int rep = 0; rep < 3; rep++)
+            {
+                auto start = chrono::steady_clock::now();
+                regions.build(colors, connectivity, limit);
+                buildMs = min(buildMs, elapsedMs(start));
+
+                start = chrono::steady_clock::now();
+                regions.build(colors, connectivity, limit, &pool);
+                poolMs = min(poolMs, elapsedMs(start));
+            }
+            vector<ColorMove> top;
+            regions.largest(colors, 1, top);
+
+            ColorGame labeled, traversed;
+            labeled.setRegionRule(connectivity, tolerance);
+            traversed.setRegionRule(connectivity);
+            labeled.start(size.cols, size.rows, seed, &pool);
+            traversed.start(size.cols, size.rows, seed, &pool);
+
+            RngKey clickKey = rngKey(seed + 1);
+            double floodMs = 0.0, labelMs = 0.0;
+            bool same = true;
+            int played = 0;
+            for (; played < REGION_CLICKS && !labeled.over(); played++)
+            {
+                size_t cell = labeled.grid().nextAlive(counterRandom(clickKey, played) % colors.size());
+                auto start = chrono::steady_clock::now();
+                traversed.click(cell, tolerance);
+                floodMs += elapsedMs(start);
+
+                start = chrono::steady_clock::now();
+                labeled.click(cell, tolerance);
+                labelMs += elapsedMs(start);
+
+                vector<uint32_t> a = labeled.lastEliminated(), b = traversed.lastEliminated();
+                sort(a.begin(), a.end());
+                sort(b.begin(), b.end());
+                same = same && a == b;
+            }
+            played = max(played, 1);
+
+            char name[32];
+            snprintf(name, sizeof(name), "%dx%d", size.cols, size.rows);
+            printf("%-11s %-9s %10.3f %10.3f %10zu %8u %10.3f %10.3f %8s\n", name, colorConnectivityName(connectivity),
+                   buildMs, poolMs, regions.count(), top.empty() ? 0u : top[0].eliminated, floodMs * 1000.0 / played,
+                   labelMs * 1000.0 / played, same ? "sim" : "NÃO");
+        }
+    }
+
+    // Sorteio das cores: melhor de 5 repetições
+    const RngKernel rngKernels[] = {RNG_KERNEL_SCALAR, RNG_KERNEL_SSE2, RNG_KERNEL_AVX2, RNG_KERNEL_AVX512};
+    printf("\nSorteio das cores (ms), %d threads\n", pool.size());
+    printf("%-11s %10s %10s %10s %10s %10s %10s %8s\n", "grade", "rand()", "escalar", "sse2", "avx2", "avx512", "threads",
+           "ganho");
+    for (const GridSize &size : GRIDS)
+    {
+        ColorGrid colors;
+        colors.reset(size.cols, size.rows);
+        vector<uint8_t> r(colors.size()), g(colors.size()), b(colors.size());
+        const int REPEAT = 5;
+
+        double randMs = 1e30;
+        for (int rep = 0; rep < REPEAT; rep++)
+        {
+            srand(unsigned(seed));
+            auto start = chrono::steady_clock::now();
+            for (size_t i = 0; i < colors.size(); i++)
+            {
+                r[i] = rand() % 256;
+                g[i] = rand() % 256;
+                b[i] = rand() % 256;
+            }
+            randMs = min(randMs, elapsedMs(start));
+        }
+
+        double ms[4] = {0.0, 0.0, 0.0, 0.0};
+        for (int k = 0; k < 4; k++)
+        {
+            if (resolveRngKernel(rngKernels[k]) != rngKernels[k])
+                continue;
+            ms[k] = 1e30;
+            for (int rep = 0; rep < REPEAT; rep++)
+            {
+                auto start = chrono::steady_clock::now();
+                fillRandomColors(rngKey(seed), 0, colors.size(), r.data(), g.data(), b.data(), rngKernels[k]);
+                ms[k] = min(ms[k], elapsedMs(start));
+            }
+        }
+
+        double poolMs = 1e30;
+        for (int rep = 0; rep < REPEAT; rep++)
+        {
+            auto start = chrono::steady_clock::now();
+            colors.randomize(seed, &pool);
+            poolMs = min(poolMs, elapsedMs(start));
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", size.cols, size.rows);
+        printf("%-11s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %7.1fx\n", name, randMs, ms[0], ms[1], ms[2], ms[3], poolMs,
+               randMs / max(poolMs, 0.0001));
+    }
+
+    ColorGrid compact;
+    compact.reset(GRIDS[0].cols, GRIDS[0].rows);
+    printf("\nMemória por célula: Quad antigo %zu bytes, ColorGrid %.2f bytes\n", sizeof(LegacyQuad),
+           compact.bytesPerCell());
+
+    return 0;
+}
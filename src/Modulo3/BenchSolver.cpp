@@ -0,0 +1,172 @@
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "ColorMatch.h"
+#include "ColorIndex.h"
+#include "ColorGrid.h"
+#include "ColorSolver.h"
+#include "CounterRng.h"
+#include "ThreadPool.h"
+using namespace std;
+
+/*
+ * Benchmark do solver do Jogo das Cores, sem janela.
+ *
+ * Para cada tamanho de grade, sorteia as cores, joga alguns cliques
+ * aleatórios (para a grade ter células eliminadas, como no meio de um jogo) e
+ * procura os k melhores cliques com o ColorSolver, com 1 thread e com todas.
+ * "jogadas/s" são as cores candidatas resolvidas por segundo (contadas ou
+ * podadas), "exatas" a fração delas que precisou de contagem exata e "bits"
+ * os bits por canal dos baldes escolhidos para o número de células vivas.
+ *
+ * Nas grades pequenas o resultado é conferido com a força bruta: a lógica do
+ * eliminarSimilares repetida para cada cor viva, O(N²).
+ *
+ * Uso:
+ *   BenchSolver [--seed N] [k] [tolerância] [threads]    (padrão: semente 1, k = 5, tolerância 0.2, todos os núcleos)
+ *
+ * Com a mesma semente as grades e os cliques são os mesmos em qualquer máquina.
+ */
+
+struct GridSize
+{
+    int cols, rows;
+};
+
+const GridSize GRIDS[] = {{160, 120}, {320, 240}, {640, 480}, {1280, 960}, {1920, 1080}, {3200, 2400}};
+
+// Força bruta só até este número de células vivas
+const size_t BRUTE_FORCE_MAX = 80000;
+
+const int CLICKS_BEFORE = 4;
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Conta, para cada cor viva distinta, as células vivas a até limit dela e guarda os k melhores
+vector<ColorMove> bruteForce(const ColorGrid &grid, int limit, size_t k)
+{
+    vector<uint8_t> r, g, b;
+    vector<uint32_t> cells;
+    for (size_t i = 0; i < grid.size(); i++)
+    {
+        if (grid.eliminated(i))
+            continue;
+        r.push_back(grid.red()[i]);
+        g.push_back(grid.green()[i]);
+        b.push_back(grid.blue()[i]);
+        cells.push_back(uint32_t(i));
+    }
+
+    vector<uint64_t> mask(colorMaskWords(cells.size()));
+    vector<bool> seen(1 << 24, false);
+    vector<ColorMove> moves;
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+        uint32_t packed = (uint32_t(r[i]) << 16) | (g[i] << 8) | b[i];
+        if (seen[packed])
+            continue;
+        seen[packed] = true;
+
+        const uint8_t C[3] = {r[i], g[i], b[i]};
+        uint32_t count = uint32_t(matchColors(r.data(), g.data(), b.data(), cells.size(), C, limit, mask.data()));
+        moves.push_back({cells[i], count});
+    }
+
+    auto better = [](const ColorMove &x, const ColorMove &y)
+    {
+        return x.eliminated > y.eliminated || (x.eliminated == y.eliminated && x.cell < y.cell);
+    };
+    size_t top = min(k, moves.size());
+    partial_sort(moves.begin(), moves.begin() + top, moves.end(), better);
+    moves.resize(top);
+    return moves;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seed = takeSeedOption(argc, argv, 1);
+    size_t k = argc > 1 ? size_t(max(1, atoi(argv[1]))) : 5;
+    float tolerance = argc > 2 ? float(atof(argv[2])) : 0.2f;
+    int threads = argc > 3 ? atoi(argv[3]) : 0;
+
+    ThreadPool one(1), all(threads);
+    ColorSolver serial(one);
+    ColorSolver parallel(all);
+    int limit = colorToleranceLimit(tolerance);
+
+    cout << "Kernel automático: " << colorKernelName(resolveColorKernel(COLOR_KERNEL_AUTO)) << endl;
+    cout << "Tolerância " << tolerance << ", " << k << " melhores cliques, " << parallel.threads() << " threads, semente "
+         << seed << endl;
+
+    printf("%-11s %10s %10s %5s %10s %10s %10s %12s %8s %16s %10s %8s\n", "grade", "vivas", "cores", "bits", "montagem",
+           "1 thread", "threads", "jogadas/s", "exatas", "melhor", "bruta", "iguais");
+
+    for (const GridSize &size : GRIDS)
+    {
+        size_t count = size_t(size.cols) * size.rows;
+        ColorGrid grid;
+        grid.reset(size.cols, size.rows);
+        grid.randomize(seed, &all);
+        RngKey clicks = rngKey(seed + 1);
+
+        ColorIndex index;
+        index.build(grid.red(), grid.green(), grid.blue(), count);
+        vector<uint32_t> similar;
+        for (int c = 0; c < CLICKS_BEFORE; c++)
+        {
+            size_t selected = counterRandom(clicks, c) % count;
+            if (!grid.eliminate(selected))
+                continue;
+            uint8_t C[3];
+            grid.color(selected, C);
+            index.remove(uint32_t(selected), C);
+            similar.clear();
+            index.removeSimilar(C, limit, similar);
+            for (uint32_t idx : similar)
+                grid.eliminate(idx);
+        }
+
+        vector<ColorMove> serialMoves, moves;
+        serial.build(grid);
+        serial.bestMoves(limit, k, serialMoves);
+        parallel.build(grid);
+        parallel.bestMoves(limit, k, moves);
+        const ColorSolver::Stats &stats = parallel.stats();
+
+        bool same = moves.size() == serialMoves.size();
+        for (size_t i = 0; same && i < moves.size(); i++)
+            same = moves[i].cell == serialMoves[i].cell && moves[i].eliminated == serialMoves[i].eliminated;
+
+        double bruteMs = 0.0;
+        if (grid.alive() <= BRUTE_FORCE_MAX)
+        {
+            auto start = chrono::steady_clock::now();
+            vector<ColorMove> reference = bruteForce(grid, limit, k);
+            bruteMs = elapsedMs(start);
+            same = same && reference.size() == moves.size();
+            for (size_t i = 0; same && i < moves.size(); i++)
+                same = moves[i].cell == reference[i].cell && moves[i].eliminated == reference[i].eliminated;
+        }
+
+        char name[32], bestMove[32];
+        snprintf(name, sizeof(name), "%dx%d", size.cols, size.rows);
+        if (moves.empty())
+            snprintf(bestMove, sizeof(bestMove), "-");
+        else
+            snprintf(bestMove, sizeof(bestMove), "(%d,%d) %u", grid.colOf(moves[0].cell), grid.rowOf(moves[0].cell),
+                     moves[0].eliminated);
+        printf("%-11s %10zu %10zu %5d %10.3f %10.3f %10.3f %12.0f %7.1f%% %16s %10.1f %8s\n", name, stats.alive,
+               stats.candidates, parallel.bucketBits(), stats.buildMs, serial.stats().solveMs, stats.solveMs,
+               stats.candidates / max(stats.solveMs, 0.0001) * 1000.0,
+               100.0 * stats.exact / max(stats.candidates, size_t(1)), bestMove, bruteMs, same ? "sim" : "NÃO");
+    }
+
+    cout << "\n\"bruta\" fica em 0 nas grades com mais de " << BRUTE_FORCE_MAX << " células vivas" << endl;
+    return 0;
+}
@@ -9,6 +9,17 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
 #include <ctime>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "Shader.h"
+#include "ShaderProgram.h"
+#include "Profiler.h"
+#include "MainLoop.h"
+#include "ColorGame.h"
+#include "ColorSolver.h"
+#include "CounterRng.h"
+#include "ThreadPool.h"
 
 using namespace std;
 using namespace glm;
@@ -17,56 +28,161 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
 
 GLuint createQuad();
-int setupShader();
+GLuint createInstanceBuffer(GLuint VAO);
+GLuint createGridTexture();
+void uploadGrid(GLuint instanceVBO, GLuint gridTexture);
+void uploadInstances(GLuint instanceVBO);
+void uploadTexture(GLuint gridTexture);
+void drawGrid(ShaderProgram &shader, GLuint instanceVBO);
+void alternaModo();
+void alternaMetrica();
+void alternaRegra();
 int setupGeometry();
 int eliminarSimilares(float tolerancia);
+size_t melhoresCliques(size_t k);
+void mostraDicas();
+void marcaDica(int cell);
 void inicializaJogo();
+void redimensionaGrid(float quadWidth, float quadHeight);
 
 const GLuint WIDTH = 800, HEIGHT = 600;
-const GLuint QUAD_WIDTH = 5, QUAD_HEIGHT = 5;
-const GLuint ROWS = HEIGHT / QUAD_HEIGHT, COLS = WIDTH / QUAD_WIDTH;
 
-const float dMax = sqrt(3.0);
+// Tamanho inicial das células; '-' e '=' dividem ou dobram em tempo de execução
+const float QUAD_WIDTH = 5, QUAD_HEIGHT = 5;
+const float MIN_QUAD_SIZE = 0.25f, MAX_QUAD_SIZE = 50.0f;
 
+const float TOLERANCIA = 0.2f;
+// Quantos cliques a tecla H lista
+const int NUM_DICAS = 5;
+
+float quadWidth = QUAD_WIDTH, quadHeight = QUAD_HEIGHT;
+int ROWS = HEIGHT / QUAD_HEIGHT, COLS = WIDTH / QUAD_WIDTH;
+
+// Cada célula é uma instância do mesmo quad; cor e "viva" vêm do buffer de instâncias e a
+// posição sai do índice da célula (firstCell + gl_InstanceID)
 const GLchar *vertexShaderSource = R"(
 #version 400
 layout (location = 0) in vec3 position;
+layout (location = 1) in vec4 cellColor;
 uniform mat4 projection;
-uniform mat4 model;
+uniform vec2 cellSize;
+uniform int cols;
+uniform int firstCell;
+out vec3 vColor;
 void main()
 {
-	gl_Position = projection * model * vec4(position.x, position.y, position.z, 1.0);
+	int index = firstCell + gl_InstanceID;
+	vec2 cell = vec2(index % cols, index / cols);
+	// Células eliminadas (alpha 0) viram triângulos degenerados e não geram fragmentos
+	vec2 pos = (cell + vec2(0.5) + position.xy * cellColor.a) * cellSize;
+	vColor = cellColor.rgb;
+	gl_Position = projection * vec4(pos, 0.0, 1.0);
 }
 )";
 
 const GLchar *fragmentShaderSource = R"(
 #version 400
-uniform vec4 inputColor;
+in vec3 vColor;
+out vec4 color;
+void main()
+{
+	color = vec4(vColor, 1.0);
+}
+)";
+
+// Modo textura: a grade inteira é uma textura COLSxROWS (um texel por célula, alpha = viva)
+// desenhada num único quad; GL_NEAREST mantém as bordas das células
+const GLchar *textureVertexShaderSource = R"(
+#version 400
+layout (location = 0) in vec3 position;
+uniform mat4 projection;
+uniform vec2 gridSize;
+out vec2 texCoord;
+void main()
+{
+	texCoord = position.xy + vec2(0.5);
+	gl_Position = projection * vec4(texCoord * gridSize, 0.0, 1.0);
+}
+)";
+
+const GLchar *textureFragmentShaderSource = R"(
+#version 400
+in vec2 texCoord;
+uniform sampler2D cells;
 out vec4 color;
 void main()
 {
-	color = inputColor;
+	// Células eliminadas (alpha 0) ficam pretas, a mesma cor do fundo
+	vec4 cell = texture(cells, texCoord);
+	color = vec4(cell.rgb * cell.a, 1.0);
 }
 )";
 
-struct Quad
+// Atributos por instância (e texels do modo textura): 4 bytes por célula para caber milhões de células no buffer
+struct CellInstance
 {
-    vec3 position;
-    vec3 dimensions;
-    vec3 color;
-    bool eliminated;
+    GLubyte r, g, b, alive;
 };
 
 int iSelected = -1;
 
-int points = 0;
-int turn = 1;
+// Cada jogo usa a semente seguinte: "--seed N" repete a mesma sequência de grades
+uint64_t seed = 0;
+uint64_t jogo = 0;
+
+// Sorteio das cores, montagem do buffer de instâncias e solver, em todos os núcleos
+ThreadPool pool;
 
-Quad grid[ROWS][COLS];
+// Grade, índice de cores, pontos e turno (common/ColorGame.h); aqui só ficam a janela e o desenho
+ColorGame game;
+const ColorGrid &grid = game.grid();
 
-int main()
+// Melhores cliques para as dicas (H) e o jogo automático (P); a célula da melhor dica fica branca
+ColorSolver solver(pool);
+vector<ColorMove> dicas;
+int dicaCell = -1;
+bool autoPlay = false;
+
+vector<CellInstance> instances;
+
+// Células alteradas desde o último upload; rebuildInstances pede o buffer (ou a textura) inteiro
+vector<int> dirtyCells;
+bool rebuildInstances = true;
+
+// T alterna entre um quad instanciado por célula e a grade como uma textura só
+enum RenderMode
 {
-    srand(time(0));
+    RENDER_INSTANCES,
+    RENDER_TEXTURE
+};
+RenderMode renderMode = RENDER_INSTANCES;
+
+// Retângulos e texels enviados no último upload do modo textura e tempo de CPU do último upload
+int uploadRects = 0;
+size_t uploadTexels = 0;
+double uploadMs = 0.0;
+
+// L alterna a comparação das cores entre RGB e L*a*b* (--lab começa em Lab)
+ColorMetric metrica = COLOR_METRIC_RGB;
+
+// R alterna a regra do clique: grade toda, região 4-conexa e região 8-conexa (--regiao 4|8 na linha de comando)
+ColorConnectivity regra = COLOR_CONNECT_NONE;
+
+// --sweep mede os dois modos em vários tamanhos de grade e sai
+bool sweep = false;
+
+int main(int argc, char **argv)
+{
+    seed = takeSeedOption(argc, argv, uint64_t(time(0)));
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--sweep") == 0)
+            sweep = true;
+        if (strcmp(argv[i], "--lab") == 0)
+            metrica = COLOR_METRIC_LAB;
+        if (strcmp(argv[i], "--regiao") == 0 && i + 1 < argc)
+            regra = atoi(argv[++i]) == 8 ? COLOR_CONNECT_8 : COLOR_CONNECT_4;
+    }
 
     glfwInit();
 
@@ -95,77 +211,181 @@ int main()
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
-    GLuint shaderID = setupShader();
+    Profiler::init("JogoCores");
+
+    ShaderProgram shader(createShaderProgram(vertexShaderSource, fragmentShaderSource));
+    ShaderProgram textureShader(createShaderProgram(textureVertexShaderSource, textureFragmentShaderSource));
     GLuint VAO = createQuad();
+    GLuint instanceVBO = createInstanceBuffer(VAO);
+    GLuint gridTexture = createGridTexture();
 
     inicializaJogo();
 
-    glUseProgram(shaderID);
-
-    GLint colorLoc = glGetUniformLocation(shaderID, "inputColor");
-
     mat4 projection = ortho(0.0, double(WIDTH), double(HEIGHT), 0.0, -1.0, 1.0);
-    glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
-
-    while (!glfwWindowShouldClose(window))
+    shader.use();
+    shader.setMat4("projection"_u, projection);
+    textureShader.use();
+    textureShader.setMat4("projection"_u, projection);
+    textureShader.setInt("cells"_u, 0);
+
+    // Cliques e teclas já pedem frame pelos callbacks; o jogo automático anima até a grade acabar
+    MainLoop loop(window);
+    auto renderFrame = [&]()
     {
-        glfwPollEvents();
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        ShaderProgram::resetFrameStats();
 
-        glLineWidth(10);
-        glPointSize(20);
+        {
+            ProfileScope cpu("update");
 
-        glBindVertexArray(VAO);
+            if (autoPlay && iSelected < 0 && grid.alive() > 0)
+            {
+                if (melhoresCliques(1) > 0)
+                {
+                    iSelected = dicas[0].cell;
+                }
+            }
 
-        if (iSelected > -1)
-        {
-            int eliminatedCount = eliminarSimilares(0.2);
-            points += (eliminatedCount * 10) / turn;
-            turn++;
+            if (iSelected > -1)
+            {
+                eliminarSimilares(TOLERANCIA);
+            }
         }
+        bool allEliminated = grid.alive() == 0;
 
-        bool allEliminated = true;
-        for (int i = 0; i < ROWS; i++)
         {
-            for (int j = 0; j < COLS; j++)
+            ProfileScope cpu("draw");
+            GpuProfileScope gpu("draw");
+
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            glLineWidth(10);
+            glPointSize(20);
+
+            glBindVertexArray(VAO);
+
             {
-                allEliminated = allEliminated && grid[i][j].eliminated;
-                if (!grid[i][j].eliminated)
-                {
-                    mat4 model = mat4(1);
-                    model = translate(model, grid[i][j].position);
-                    model = scale(model, grid[i][j].dimensions);
-                    glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
-                    glUniform4f(colorLoc, grid[i][j].color.r, grid[i][j].color.g, grid[i][j].color.b, 1.0f);
-                    glDrawArrays(GL_TRIANGLE_STRIP, 0, 6);
-                }
+                ProfileScope cpuUpload("upload");
+                double uploadStart_s = glfwGetTime();
+                uploadGrid(instanceVBO, gridTexture);
+                uploadMs = (glfwGetTime() - uploadStart_s) * 1000.0;
+            }
+
+            if (renderMode == RENDER_TEXTURE)
+            {
+                textureShader.use();
+                textureShader.setVec2("gridSize"_u, COLS * quadWidth, ROWS * quadHeight);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, gridTexture);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+            else
+            {
+                shader.use();
+                shader.setVec2("cellSize"_u, quadWidth, quadHeight);
+                drawGrid(shader, instanceVBO);
             }
+
+            glBindVertexArray(0);
         }
 
         if (allEliminated)
         {
 
-            string titulo = "Fim de jogo! | Pontos: " + to_string(points) + " | Para reiniciar aperte enter!";
+            string titulo = "Fim de jogo! | Pontos: " + to_string(game.points()) + " | Para reiniciar aperte enter!";
             glfwSetWindowTitle(window, titulo.c_str());
         }
         else
         {
-            string titulo = "Jogo das cores! ❤️🩷🧡💛💚 | Turno: " + to_string(turn) + " | Pontos: " + to_string(points);
+            string titulo = "Jogo das cores! ❤️🩷🧡💛💚 | Turno: " + to_string(game.turn()) + " | Pontos: " + to_string(game.points()) +
+                            " | Grade: " + to_string(COLS) + "x" + to_string(ROWS) +
+                            (renderMode == RENDER_TEXTURE ? " | Textura" : " | Instâncias") +
+                            (metrica == COLOR_METRIC_LAB ? " | Lab" : " | RGB") +
+                            (regra != COLOR_CONNECT_NONE ? string(" | Região ") + colorConnectivityName(regra) : "") + (autoPlay ? " | Automático" : "") +
+                            " | " + Profiler::frameSummary();
             glfwSetWindowTitle(window, titulo.c_str());
         }
 
-        glBindVertexArray(0);
+        loop.setAnimating(autoPlay && grid.alive() > 0);
+    };
 
-        glfwSwapBuffers(window);
+    if (sweep)
+    {
+        // Laço contínuo e sem vsync, para medir o custo real do frame
+        glfwSwapInterval(0);
+        auto sweepFrame = [&]()
+        {
+            Profiler::beginFrame();
+            glfwPollEvents();
+            renderFrame();
+            glfwSwapBuffers(window);
+        };
+
+        // Cada tamanho de célula nos dois modos: frames parados, depois frames com um clique aleatório
+        const int warmupFrames = 10, measuredFrames = 100, clickFrames = 20;
+        const float sizes[] = {50, 20, 10, 5, 2, 1, 0.5f, 0.25f};
+
+        printf("%-10s %-11s %-12s %-12s %-12s %-11s %-10s\n", "grade", "modo", "frame (ms)", "clique (ms)", "upload (ms)",
+               "retângulos", "texels");
+        for (float size : sizes)
+        {
+            for (int mode = 0; mode < 2; mode++)
+            {
+                renderMode = RenderMode(mode);
+                jogo = 0;
+                redimensionaGrid(size, size);
+                for (int f = 0; f < warmupFrames; f++)
+                    sweepFrame();
+
+                glFinish();
+                double start_s = glfwGetTime();
+                for (int f = 0; f < measuredFrames; f++)
+                    sweepFrame();
+                glFinish();
+                double frame_ms = (glfwGetTime() - start_s) * 1000.0 / measuredFrames;
+
+                // Mesma semente nos dois modos: os mesmos cliques e as mesmas células eliminadas
+                RngKey key = rngKey(seed);
+                int clicks = 0, rects = 0;
+                size_t texels = 0;
+                double click_ms = 0.0, upload_ms = 0.0;
+                for (; clicks < clickFrames && !game.over(); clicks++)
+                {
+                    iSelected = int(grid.nextAlive(counterRandom(key, uint32_t(grid.size() + clicks)) % grid.size()));
+                    double frameStart_s = glfwGetTime();
+                    sweepFrame();
+                    glFinish();
+                    click_ms += (glfwGetTime() - frameStart_s) * 1000.0;
+                    upload_ms += uploadMs;
+                    rects += uploadRects;
+                    texels += uploadTexels;
+                }
+                clicks = max(clicks, 1);
+
+                string gridName = to_string(COLS) + "x" + to_string(ROWS);
+                bool texture = renderMode == RENDER_TEXTURE;
+                string rectsText = texture ? to_string(rects / clicks) : "-";
+                string texelsText = texture ? to_string(texels / clicks) : "-";
+                printf("%-10s %-11s %-12.3f %-12.3f %-12.3f %-11s %-10s\n", gridName.c_str(),
+                       texture ? "textura" : "instâncias", frame_ms, click_ms / clicks, upload_ms / clicks,
+                       rectsText.c_str(), texelsText.c_str());
+            }
+        }
+    }
+    else
+    {
+        loop.run(renderFrame);
     }
+    Profiler::shutdown();
     glfwTerminate();
     return 0;
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+    Profiler::handleKey(key, action);
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     {
         glfwSetWindowShouldClose(window, GL_TRUE);
@@ -174,50 +394,86 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
     {
         inicializaJogo();
     }
+    if (key == GLFW_KEY_MINUS && action == GLFW_PRESS)
+    {
+        redimensionaGrid(quadWidth / 2, quadHeight / 2);
+    }
+    if (key == GLFW_KEY_EQUAL && action == GLFW_PRESS)
+    {
+        redimensionaGrid(quadWidth * 2, quadHeight * 2);
+    }
+    if (key == GLFW_KEY_H && action == GLFW_PRESS)
+    {
+        mostraDicas();
+    }
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        autoPlay = !autoPlay;
+    }
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        alternaModo();
+    }
+    if (key == GLFW_KEY_L && action == GLFW_PRESS)
+    {
+        alternaMetrica();
+    }
+    if (key == GLFW_KEY_R && action == GLFW_PRESS)
+    {
+        alternaRegra();
+    }
 }
 
-int setupShader()
+void redimensionaGrid(float newWidth, float newHeight)
 {
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-                  << infoLog << std::endl;
-    }
+    if (newWidth < MIN_QUAD_SIZE || newHeight < MIN_QUAD_SIZE || newWidth > MAX_QUAD_SIZE || newHeight > MAX_QUAD_SIZE)
+        return;
 
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
+    quadWidth = newWidth;
+    quadHeight = newHeight;
+    ROWS = HEIGHT / quadHeight;
+    COLS = WIDTH / quadWidth;
+    inicializaJogo();
 
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
+    if (!sweep)
+        cout << "Grade " << COLS << "x" << ROWS << " (" << ROWS * COLS << " células)" << endl;
+}
+
+// O modo novo recebe a grade inteira no próximo upload; o anterior fica desatualizado até voltar a ele
+void alternaModo()
+{
+    if (renderMode == RENDER_INSTANCES)
     {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-                  << infoLog << std::endl;
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        if (COLS > maxSize || ROWS > maxSize)
+        {
+            cout << "Grade " << COLS << "x" << ROWS << " maior que a textura máxima (" << maxSize << ")" << endl;
+            return;
+        }
     }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
 
-    return shaderProgram;
+    renderMode = renderMode == RENDER_TEXTURE ? RENDER_INSTANCES : RENDER_TEXTURE;
+    rebuildInstances = true;
+    cout << "Modo " << (renderMode == RENDER_TEXTURE ? "textura" : "instâncias") << endl;
+}
+
+// Recomeça a mesma grade (mesma semente) comparando as cores na outra métrica
+void alternaMetrica()
+{
+    metrica = metrica == COLOR_METRIC_LAB ? COLOR_METRIC_RGB : COLOR_METRIC_LAB;
+    cout << "Métrica " << colorMetricName(metrica) << endl;
+    jogo--;
+    inicializaJogo();
+}
+
+// Recomeça a mesma grade com a próxima regra do clique
+void alternaRegra()
+{
+    regra = regra == COLOR_CONNECT_NONE ? COLOR_CONNECT_4 : regra == COLOR_CONNECT_4 ? COLOR_CONNECT_8 : COLOR_CONNECT_NONE;
+    cout << "Regra: " << colorConnectivityName(regra) << endl;
+    jogo--;
+    inicializaJogo();
 }
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
@@ -227,10 +483,11 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
         double xpos, ypos;
         glfwGetCursorPos(window, &xpos, &ypos);
 
-        int x = xpos / QUAD_WIDTH;
-        int y = ypos / QUAD_HEIGHT;
-        grid[y][x].eliminated = true;
-        iSelected = x + y * COLS;
+        int x = xpos / quadWidth;
+        int y = ypos / quadHeight;
+        if (x < 0 || y < 0 || x >= COLS || y >= ROWS)
+            return;
+        iSelected = grid.index(x, y);
     }
 }
 
@@ -262,57 +519,270 @@ GLuint createQuad()
     return VAO;
 }
 
-int eliminarSimilares(float tolerancia)
+GLuint createInstanceBuffer(GLuint VAO)
+{
+    GLuint instanceVBO;
+    glGenBuffers(1, &instanceVBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    // Atributo 1 - cor (rgb) e viva (a), normalizados para [0, 1]; o ponteiro é refeito em drawGrid()
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CellInstance), (GLvoid *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    return instanceVBO;
+}
+
+GLuint createGridTexture()
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    // Um texel por célula, sem mipmaps: a grade nunca é amostrada fora do nível 0
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+// Atualiza "viva" das células alteradas e envia só elas para o buffer ou a textura do modo atual
+void uploadGrid(GLuint instanceVBO, GLuint gridTexture)
 {
-    int eliminatedCount = 0;
-    int x = iSelected % COLS;
-    int y = iSelected / COLS;
-    vec3 C = grid[y][x].color;
-    grid[y][x].eliminated = true;
-    for (int i = 0; i < ROWS; i++)
+    if (!rebuildInstances && dirtyCells.empty())
+        return;
+
+    for (int idx : dirtyCells)
+    {
+        instances[idx].alive = grid.eliminated(idx) ? 0 : 255;
+    }
+
+    if (renderMode == RENDER_TEXTURE)
+        uploadTexture(gridTexture);
+    else
+        uploadInstances(instanceVBO);
+
+    rebuildInstances = false;
+    dirtyCells.clear();
+}
+
+void uploadInstances(GLuint instanceVBO)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    if (rebuildInstances)
+    {
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(CellInstance), instances.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return;
+    }
+
+    // Junta índices próximos em faixas contíguas: poucas chamadas sem reenviar o buffer todo
+    const int MAX_GAP = 64;
+    sort(dirtyCells.begin(), dirtyCells.end());
+    size_t k = 0;
+    while (k < dirtyCells.size())
+    {
+        int first = dirtyCells[k];
+        int last = first;
+        while (k + 1 < dirtyCells.size() && dirtyCells[k + 1] - last <= MAX_GAP)
+        {
+            last = dirtyCells[++k];
+        }
+        k++;
+
+        glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(CellInstance), (last - first + 1) * sizeof(CellInstance), &instances[first]);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void uploadTexture(GLuint gridTexture)
+{
+    glBindTexture(GL_TEXTURE_2D, gridTexture);
+    // O retângulo sai direto de instances: cada linha dele começa COLS texels depois da anterior
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, COLS);
+
+    if (rebuildInstances)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, COLS, ROWS, 0, GL_RGBA, GL_UNSIGNED_BYTE, instances.data());
+        uploadRects = 1;
+        uploadTexels = instances.size();
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return;
+    }
+
+    // Faixas de cada linha (como no buffer de instâncias), depois as faixas de linhas vizinhas que se
+    // tocam viram um retângulo: cliques em regiões juntas mandam poucos retângulos, e cliques
+    // espalhados pela grade acabam num retângulo só, do tamanho da área alterada
+    struct DirtyRect
+    {
+        int x0, y0, x1, y1; // [x0, x1) x [y0, y1)
+    };
+    const int MAX_GAP = 64;
+    vector<DirtyRect> rects;
+
+    sort(dirtyCells.begin(), dirtyCells.end());
+    size_t k = 0;
+    while (k < dirtyCells.size())
     {
-        for (int j = 0; j < COLS; j++)
+        int row = int(grid.rowOf(dirtyCells[k]));
+        int first = int(grid.colOf(dirtyCells[k]));
+        int last = first;
+        while (k + 1 < dirtyCells.size() && int(grid.rowOf(dirtyCells[k + 1])) == row &&
+               int(grid.colOf(dirtyCells[k + 1])) - last <= MAX_GAP)
+        {
+            last = int(grid.colOf(dirtyCells[++k]));
+        }
+        k++;
+
+        // Junta com um retângulo que termina na linha de cima e cobre (ou quase) as mesmas colunas
+        bool merged = false;
+        for (size_t r = rects.size(); r-- > 0 && rects[r].y1 >= row;)
         {
-            vec3 O = grid[i][j].color;
-            float d = sqrt(pow(C.r - O.r, 2) + pow(C.g - O.g, 2) + pow(C.b - O.b, 2));
-            float dd = d / dMax;
-            if (dd <= tolerancia)
+            DirtyRect &rect = rects[r];
+            if (first <= rect.x1 + MAX_GAP && last + 1 >= rect.x0 - MAX_GAP)
             {
-                Quad quad = grid[i][j];
-                if (quad.eliminated)
-                {
-                    continue;
-                }
-                grid[i][j].eliminated = true;
-                eliminatedCount++;
+                rect.x0 = min(rect.x0, first);
+                rect.x1 = max(rect.x1, last + 1);
+                rect.y1 = row + 1;
+                merged = true;
+                break;
             }
         }
+        if (!merged)
+            rects.push_back({first, row, last + 1, row + 1});
+    }
+
+    uploadRects = int(rects.size());
+    uploadTexels = 0;
+    for (const DirtyRect &rect : rects)
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x0, rect.y0, rect.x1 - rect.x0, rect.y1 - rect.y0, GL_RGBA,
+                        GL_UNSIGNED_BYTE, &instances[grid.index(rect.x0, rect.y0)]);
+        uploadTexels += size_t(rect.x1 - rect.x0) * (rect.y1 - rect.y0);
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Um draw por faixa de linhas com células vivas: as linhas já esvaziadas não geram instâncias
+void drawGrid(ShaderProgram &shader, GLuint instanceVBO)
+{
+    shader.setInt("cols"_u, COLS);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    int first, last;
+    for (int row = 0; grid.nextRowRun(row, first, last); row = last)
+    {
+        size_t firstCell = grid.index(0, first);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CellInstance), (GLvoid *)(firstCell * sizeof(CellInstance)));
+        shader.setInt("firstCell"_u, int(firstCell));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (last - first) * COLS);
     }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Na regra por região os melhores cliques são as maiores regiões rotuladas; na da grade toda, os do solver
+size_t melhoresCliques(size_t k)
+{
+    if (game.connectivity() != COLOR_CONNECT_NONE)
+        return game.regions().largest(grid, k, dicas);
+
+    solver.build(grid);
+    return solver.bestMoves(colorMetricLimit(TOLERANCIA, grid.metric()), k, dicas);
+}
+
+void mostraDicas()
+{
+    melhoresCliques(NUM_DICAS);
+    if (game.connectivity() != COLOR_CONNECT_NONE)
+    {
+        cout << "Dicas (" << game.regions().count() << " regiões " << colorConnectivityName(game.connectivity())
+             << "):" << endl;
+    }
+    else
+    {
+        const ColorSolver::Stats &stats = solver.stats();
+        cout << "Dicas (" << stats.candidates << " cores, " << stats.exact << " contadas, " << stats.buildMs + stats.solveMs
+             << " ms em " << solver.threads() << " threads):" << endl;
+    }
+    for (const ColorMove &dica : dicas)
+    {
+        cout << "  (" << grid.colOf(dica.cell) << ", " << grid.rowOf(dica.cell) << ") elimina " << dica.eliminated
+             << " células" << endl;
+    }
+    marcaDica(dicas.empty() ? -1 : int(dicas[0].cell));
+}
+
+// Pinta a célula da dica de branco no buffer de instâncias; a anterior volta à sua cor
+void marcaDica(int cell)
+{
+    if (dicaCell >= 0)
+    {
+        uint8_t C[3];
+        grid.color(dicaCell, C);
+        instances[dicaCell].r = C[0];
+        instances[dicaCell].g = C[1];
+        instances[dicaCell].b = C[2];
+        dirtyCells.push_back(dicaCell);
+    }
+    dicaCell = cell;
+    if (dicaCell >= 0)
+    {
+        instances[dicaCell].r = instances[dicaCell].g = instances[dicaCell].b = 255;
+        dirtyCells.push_back(dicaCell);
+    }
+}
+
+int eliminarSimilares(float tolerancia)
+{
+    int eliminatedCount = game.click(iSelected, tolerancia);
+    dirtyCells.insert(dirtyCells.end(), game.lastEliminated().begin(), game.lastEliminated().end());
     iSelected = -1;
+    marcaDica(-1);
     return eliminatedCount;
 }
 
 void inicializaJogo()
 {
     iSelected = -1;
-    points = 0;
-    turn = 1;
+    dicaCell = -1;
 
-    for (int i = 0; i < ROWS; i++)
+    uint64_t gameSeed = seed + jogo++;
+    if (!sweep)
+        cout << "Semente " << gameSeed << endl;
+
+    // Na regra por região as regiões são rotuladas para TOLERANCIA: cada clique vira uma consulta
+    game.setRegionRule(regra, TOLERANCIA);
+    game.start(COLS, ROWS, gameSeed, &pool, metrica);
+    instances.resize(ROWS * COLS);
+
+    auto copyColors = [&](size_t begin, size_t end, int worker)
     {
-        for (int j = 0; j < COLS; j++)
+        for (size_t i = begin; i < end; i++)
         {
-            Quad quad;
-            vec2 ini_pos = vec2(QUAD_WIDTH / 2, QUAD_HEIGHT / 2);
-            quad.position = vec3(ini_pos.x + j * QUAD_WIDTH, ini_pos.y + i * QUAD_HEIGHT, 0.0);
-            quad.dimensions = vec3(QUAD_WIDTH, QUAD_HEIGHT, 1.0);
-            float r, g, b;
-            r = rand() % 256 / 255.0;
-            g = rand() % 256 / 255.0;
-            b = rand() % 256 / 255.0;
-            quad.color = vec3(r, g, b);
-            quad.eliminated = false;
-            grid[i][j] = quad;
+            CellInstance &cell = instances[i];
+            cell.r = grid.red()[i];
+            cell.g = grid.green()[i];
+            cell.b = grid.blue()[i];
+            cell.alive = 255;
         }
-    }
+    };
+    pool.parallelFor(grid.size(), 1 << 16, copyColors);
+
+    dirtyCells.clear();
+    rebuildInstances = true;
 }
@@ -0,0 +1,240 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "ColorGame.h"
+#include "ColorSolver.h"
+#include "CounterRng.h"
+#include "ThreadPool.h"
+using namespace std;
+
+/*
+ * Simulação do Jogo das Cores sem janela.
+ *
+ * Joga muitas partidas com as regras de common/ColorGame.h (as mesmas do
+ * JogoCores), uma semente por partida (semente, semente + 1, ...), divididas
+ * entre todos os núcleos. Cada partida segue uma política de cliques:
+ *
+ *   aleatorio   clica numa célula viva sorteada a cada turno
+ *   guloso      clica no melhor clique do ColorSolver a cada turno
+ *   <arquivo>   repete os cliques "coluna linha" do arquivo (uma por linha, # comenta)
+ *
+ * A partida acaba quando não sobra célula viva (ou quando o roteiro acaba).
+ * No fim imprime partidas por segundo, turnos por partida e a distribuição
+ * dos pontos. Os resultados só dependem da semente, não do número de threads.
+ *
+ * Uso:
+ *   SimCores [--seed N] [--lab] [--regiao 4|8] [partidas] [aleatorio|guloso|arquivo] [COLSxROWS] [tolerância] [threads]
+ *   (padrão: semente 1, 1000 partidas, aleatorio, 160x120, tolerância 0.2, todos os núcleos)
+ *
+ * --lab compara as cores em L*a*b* (ColorLab.h) em vez de RGB. --regiao usa a
+ * regra por região (ColorRegions.h), com as regiões rotuladas no início de
+ * cada partida; a política gulosa clica então na maior região viva.
+ */
+
+struct GameResult
+{
+    int turns;
+    int points;
+};
+
+// Estado de cada thread: a política gulosa usa um solver sem threads próprias
+struct Player
+{
+    ThreadPool pool{1};
+    ColorSolver solver{pool};
+    ColorGame game;
+    vector<ColorMove> moves;
+};
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+bool loadScript(const string &path, vector<pair<int, int>> &clicks)
+{
+    ifstream file(path);
+    if (!file)
+        return false;
+
+    string line;
+    while (getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        istringstream in(line);
+        int col, row;
+        if (in >> col >> row)
+            clicks.push_back({col, row});
+    }
+    return true;
+}
+
+template <typename T>
+T percentile(vector<T> sorted, double p)
+{
+    sort(sorted.begin(), sorted.end());
+    size_t i = min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + 0.5));
+    return sorted[i];
+}
+
+template <typename T>
+double mean(const vector<T> &values)
+{
+    double sum = 0.0;
+    for (T v : values)
+        sum += v;
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seed = takeSeedOption(argc, argv, 1);
+    ColorMetric metric = COLOR_METRIC_RGB;
+    ColorConnectivity connectivity = COLOR_CONNECT_NONE;
+    for (int i = 1; i < argc;)
+    {
+        int taken = 0;
+        if (strcmp(argv[i], "--lab") == 0)
+        {
+            metric = COLOR_METRIC_LAB;
+            taken = 1;
+        }
+        else if (strcmp(argv[i], "--regiao") == 0 && i + 1 < argc)
+        {
+            connectivity = atoi(argv[i + 1]) == 8 ? COLOR_CONNECT_8 : COLOR_CONNECT_4;
+            taken = 2;
+        }
+        if (taken == 0)
+        {
+            i++;
+            continue;
+        }
+        for (int j = i; j + taken < argc; j++)
+            argv[j] = argv[j + taken];
+        argc -= taken;
+    }
+    int games = argc > 1 ? max(1, atoi(argv[1])) : 1000;
+    string policy = argc > 2 ? argv[2] : "aleatorio";
+    int cols = 160, rows = 120;
+    if (argc > 3 && sscanf(argv[3], "%dx%d", &cols, &rows) != 2)
+    {
+        cerr << "Grade inválida: " << argv[3] << " (use COLSxROWS)" << endl;
+        return 1;
+    }
+    float tolerance = argc > 4 ? float(atof(argv[4])) : 0.2f;
+    int threads = argc > 5 ? atoi(argv[5]) : 0;
+
+    vector<pair<int, int>> script;
+    bool greedy = policy == "guloso";
+    bool scripted = !greedy && policy != "aleatorio";
+    if (scripted && !loadScript(policy, script))
+    {
+        cerr << "Política desconhecida ou roteiro não encontrado: " << policy << endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    vector<unique_ptr<Player>> players;
+    for (int i = 0; i < pool.size(); i++)
+        players.emplace_back(new Player());
+
+    cout << games << " partidas " << cols << "x" << rows << ", política " << policy << ", tolerância " << tolerance
+         << " (" << colorMetricName(metric) << ", " << colorConnectivityName(connectivity) << "), semente " << seed << ", " << pool.size() << " threads" << endl;
+
+    vector<GameResult> results(games);
+    int limit = colorMetricLimit(tolerance, metric);
+    auto play = [&](size_t begin, size_t end, int worker)
+    {
+        Player &player = *players[worker];
+        ColorGame &game = player.game;
+        for (size_t g = begin; g < end; g++)
+        {
+            uint64_t gameSeed = seed + g;
+            game.setRegionRule(connectivity, tolerance);
+            game.start(cols, rows, gameSeed, nullptr, metric);
+            const ColorGrid &grid = game.grid();
+
+            // Os cliques aleatórios usam os contadores depois dos das cores da grade
+            RngKey key = rngKey(gameSeed);
+            size_t step = 0;
+            while (!game.over())
+            {
+                size_t cell;
+                if (scripted)
+                {
+                    if (step >= script.size())
+                        break;
+                    int col = script[step].first, row = script[step].second;
+                    step++;
+                    if (col < 0 || row < 0 || col >= cols || row >= rows)
+                        continue;
+                    cell = grid.index(col, row);
+                }
+                else if (greedy && connectivity != COLOR_CONNECT_NONE)
+                {
+                    game.regions().largest(grid, 1, player.moves);
+                    cell = player.moves[0].cell;
+                }
+                else if (greedy)
+                {
+                    player.solver.build(grid);
+                    player.solver.bestMoves(limit, 1, player.moves);
+                    cell = player.moves[0].cell;
+                }
+                else
+                {
+                    cell = grid.nextAlive(counterRandom(key, uint32_t(grid.size() + step)) % grid.size());
+                    step++;
+                }
+                game.click(cell, tolerance);
+            }
+            results[g] = {game.turn() - 1, game.points()};
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    pool.parallelFor(games, 1, play);
+    double ms = elapsedMs(start);
+
+    vector<int> turns, points;
+    long long checksum = 0;
+    for (const GameResult &result : results)
+    {
+        turns.push_back(result.turns);
+        points.push_back(result.points);
+        checksum += result.points;
+    }
+
+    printf("\n%.1f ms, %.1f partidas/s, %.0f turnos/s\n", ms, games / ms * 1000.0,
+           mean(turns) * games / ms * 1000.0);
+    printf("%-10s %10s %10s %10s %10s %10s %10s\n", "", "média", "mín", "p5", "p50", "p95", "máx");
+    printf("%-10s %10.1f %10d %10d %10d %10d %10d\n", "turnos", mean(turns), percentile(turns, 0.0),
+           percentile(turns, 0.05), percentile(turns, 0.5), percentile(turns, 0.95), percentile(turns, 1.0));
+    printf("%-10s %10.1f %10d %10d %10d %10d %10d\n", "pontos", mean(points), percentile(points, 0.0),
+           percentile(points, 0.05), percentile(points, 0.5), percentile(points, 0.95), percentile(points, 1.0));
+
+    // Histograma dos pontos em 10 faixas
+    const int BINS = 10, BAR = 50;
+    int lo = percentile(points, 0.0), hi = percentile(points, 1.0);
+    int width = max(1, (hi - lo + BINS) / BINS);
+    vector<int> histogram(BINS, 0);
+    for (int p : points)
+        histogram[min(BINS - 1, (p - lo) / width)]++;
+    int tallest = *max_element(histogram.begin(), histogram.end());
+    cout << "\nPontos:" << endl;
+    for (int b = 0; b < BINS; b++)
+    {
+        printf("%8d - %-8d %6d %s\n", lo + b * width, lo + (b + 1) * width - 1, histogram[b],
+               string(size_t(histogram[b]) * BAR / max(tallest, 1), '#').c_str());
+    }
+
+    cout << "\nSoma dos pontos (confere a reprodução com a mesma semente): " << checksum << endl;
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include "MipChain.h"
+using namespace std;
+namespace fs = std::filesystem;
+
+/*
+ * Benchmark da geração de mipmaps: para cada PNG dos assets, mede a cadeia
+ * completa feita na CPU (filtros box e tent, kernels escalar, SSE2 e AVX2) e
+ * o glGenerateMipmap do driver, numa janela GLFW escondida.
+ *
+ * Uso:
+ *   BenchMipmaps [imagem.png | pasta]...    (padrão: ../assets)
+ *
+ * Os tempos são o melhor de RUNS execuções e não incluem a decodificação do
+ * PNG nem o envio do nível 0. A coluna "iguais" confere se os kernels SIMD
+ * geraram os mesmos bytes que o escalar.
+ */
+
+const int RUNS = 3;
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+vector<string> collectImages(const vector<string> &inputs)
+{
+    vector<string> images;
+    for (const string &input : inputs)
+    {
+        if (fs::is_directory(input))
+        {
+            for (const auto &entry : fs::recursive_directory_iterator(input))
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".png")
+                    images.push_back(entry.path().string());
+            }
+        }
+        else
+        {
+            images.push_back(input);
+        }
+    }
+    sort(images.begin(), images.end());
+    return images;
+}
+
+double benchCpu(const uint8_t *rgba, int width, int height, MipFilter filter, MipKernel kernel,
+                vector<vector<uint8_t>> &levels)
+{
+    double best = 1e30;
+    for (int i = 0; i < RUNS; i++)
+    {
+        auto start = chrono::steady_clock::now();
+        levels = buildMipChain(rgba, width, height, filter, kernel);
+        best = min(best, elapsedMs(start));
+    }
+    return best;
+}
+
+double benchGl(const uint8_t *rgba, int width, int height)
+{
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+
+    double best = 1e30;
+    for (int i = 0; i < RUNS; i++)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+        glFinish();
+
+        auto start = chrono::steady_clock::now();
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glFinish();
+        best = min(best, elapsedMs(start));
+    }
+
+    glDeleteTextures(1, &texID);
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    vector<string> inputs(argv + 1, argv + argc);
+    if (inputs.empty())
+        inputs.push_back("../assets");
+
+    glfwInit();
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    // Só precisamos do contexto
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Benchmark de mipmaps", nullptr, nullptr);
+    if (!window)
+    {
+        std::cerr << "Falha ao criar a janela GLFW" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Falha ao inicializar GLAD" << std::endl;
+        return -1;
+    }
+
+    cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
+    cout << "Kernel automático: " << mipKernelName(resolveMipKernel(MIP_KERNEL_AUTO)) << endl;
+
+    const MipFilter filters[] = {MIP_FILTER_BOX, MIP_FILTER_TENT};
+    const MipKernel kernels[] = {MIP_KERNEL_SCALAR, MIP_KERNEL_SSE2, MIP_KERNEL_AVX2};
+
+    printf("%-36s %11s %-6s %10s %10s %10s %7s %8s\n", "asset", "tamanho", "filtro", "escalar", "sse2", "avx2", "ganho",
+           "iguais");
+
+    double totalScalar = 0.0, totalBest = 0.0, totalGl = 0.0;
+    for (const string &path : collectImages(inputs))
+    {
+        int width, height, nrChannels;
+        unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
+        if (!data)
+        {
+            cerr << "Falha ao carregar " << path << endl;
+            continue;
+        }
+
+        string name = fs::path(path).filename().string();
+        for (MipFilter filter : filters)
+        {
+            vector<vector<uint8_t>> reference, levels;
+            double ms[3] = {0.0, 0.0, 0.0};
+            bool same = true;
+
+            ms[0] = benchCpu(data, width, height, filter, MIP_KERNEL_SCALAR, reference);
+            double best = ms[0];
+            for (int k = 1; k < 3; k++)
+            {
+                // Kernel sem suporte nesta CPU aparece com 0.00 na tabela
+                if (resolveMipKernel(kernels[k]) != kernels[k])
+                    continue;
+                ms[k] = benchCpu(data, width, height, filter, kernels[k], levels);
+                same = same && levels == reference;
+                best = min(best, ms[k]);
+            }
+
+            if (filter == MIP_FILTER_BOX)
+            {
+                totalScalar += ms[0];
+                totalBest += best;
+            }
+
+            printf("%-36s %5dx%-5d %-6s %10.2f %10.2f %10.2f %6.1fx %8s\n", name.c_str(), width, height,
+                   mipFilterName(filter), ms[0], ms[1], ms[2], ms[0] / max(best, 0.001), same ? "sim" : "NÃO");
+        }
+
+        double glMs = benchGl(data, width, height);
+        totalGl += glMs;
+        printf("%-36s %11s %-6s %10.2f\n", "", "", "gl", glMs);
+
+        stbi_image_free(data);
+    }
+
+    printf("\nTotal box: escalar %.2f ms, melhor kernel %.2f ms, glGenerateMipmap %.2f ms\n", totalScalar, totalBest,
+           totalGl);
+
+    glfwTerminate();
+    return 0;
+}
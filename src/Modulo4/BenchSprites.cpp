@@ -0,0 +1,329 @@
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "Shader.h"
+#include "Texture.h"
+#include "SpriteBatch.h"
+#include "GLState.h"
+using namespace glm;
+using namespace std;
+
+/*
+ * Benchmark do SpriteBatch: desenha de 10k a 100k sprites com as texturas
+ * pequenas do DesafioTexturas e compara o caminho antigo (um draw por sprite,
+ * igual ao Sprite::draw original) com o caminho em batch.
+ *
+ * Uso:
+ *   BenchSprites [quantidade]   modo interativo
+ *   BenchSprites --sweep        mede todas as quantidades nos dois modos e sai
+ *
+ * Teclas: B alterna o modo, CIMA/BAIXO somam ou tiram 10k sprites.
+ */
+
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
+
+int setupSprite();
+
+const GLuint WIDTH = 1280, HEIGHT = 720;
+const int MIN_SPRITES = 10000, MAX_SPRITES = 100000, STEP_SPRITES = 10000;
+
+const GLchar *vertexShaderSource = R"(
+ #version 400
+ layout (location = 0) in vec3 position;
+ layout (location = 1) in vec2 texc;
+ out vec2 tex_coord;
+
+ uniform mat4 model;
+ uniform mat4 projection;
+
+ void main()
+ {
+    tex_coord = vec2(texc.s, 1.0 - texc.t);
+    gl_Position = projection * model * vec4(position, 1.0);
+ }
+ )";
+
+const GLchar *fragmentShaderSource = R"(
+ #version 400
+ in vec2 tex_coord;
+ out vec4 color;
+ uniform sampler2D tex_buff;
+ void main()
+ {
+	 color = texture(tex_buff,tex_coord);
+ }
+ )";
+
+struct Prop
+{
+    GLuint texID;
+    mat4 model;
+};
+
+bool batched = true;
+int spriteCount = MIN_SPRITES;
+
+vector<Prop> makeProps(int count, const vector<GLuint> &textures)
+{
+    vector<Prop> props(count);
+    srand(1234);
+    for (int i = 0; i < count; i++)
+    {
+        float size = 8.0f + rand() % 40;
+        float x = rand() % WIDTH;
+        float y = rand() % HEIGHT;
+
+        props[i].texID = textures[rand() % textures.size()];
+        props[i].model = scale(translate(mat4(1.0f), vec3(x, y, 0.0f)), vec3(size, size, 1.0f));
+    }
+    return props;
+}
+
+// Caminho antigo: o mesmo conjunto de chamadas que Sprite::draw() fazia para cada sprite
+int drawPerSprite(const vector<Prop> &props, GLuint shaderID, GLuint VAO, const mat4 &projection)
+{
+    for (const Prop &prop : props)
+    {
+        glUseProgram(shaderID);
+
+        glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(prop.model));
+        glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+
+        glBindVertexArray(VAO);
+        glBindTexture(GL_TEXTURE_2D, prop.texID);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+    // As chamadas acima não passam pelo GLState, que o SpriteBatch usa
+    GLState::invalidate();
+    return props.size();
+}
+
+int drawBatched(const vector<Prop> &props, GLuint shaderID, SpriteBatch &batch, const mat4 &projection)
+{
+    glUseProgram(shaderID);
+    glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(mat4(1.0f)));
+    glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+
+    batch.begin();
+    for (const Prop &prop : props)
+    {
+        batch.draw(prop.texID, shaderID, prop.model);
+    }
+    batch.end();
+    return batch.stats().drawCalls;
+}
+
+int main(int argc, char **argv)
+{
+    bool sweep = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--sweep") == 0)
+            sweep = true;
+        else
+            spriteCount = std::min(std::max(atoi(argv[i]), MIN_SPRITES), MAX_SPRITES);
+    }
+
+    glfwInit();
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+
+    GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "Benchmark de sprites", nullptr, nullptr);
+    if (!window)
+    {
+        std::cerr << "Falha ao criar a janela GLFW" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    // Sem vsync para medir o custo real do frame
+    glfwSwapInterval(0);
+
+    glfwSetKeyCallback(window, key_callback);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Falha ao inicializar GLAD" << std::endl;
+        return -1;
+    }
+
+    const GLubyte *renderer = glGetString(GL_RENDERER);
+    const GLubyte *version = glGetString(GL_VERSION);
+    cout << "Renderer: " << renderer << endl;
+    cout << "OpenGL version supported " << version << endl;
+
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    glViewport(0, 0, width, height);
+
+    GLuint shaderID = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    GLuint VAO = setupSprite();
+
+    vector<GLuint> textures = {
+        GLuint(loadTexture("../assets/textures/eye.png")),
+        GLuint(loadTexture("../assets/textures/skulls.png")),
+        GLuint(loadTexture("../assets/textures/dragon.png")),
+        GLuint(loadTexture("../assets/textures/flower.png")),
+    };
+
+    glUseProgram(shaderID);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(glGetUniformLocation(shaderID, "tex_buff"), 0);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    mat4 projection = ortho(0.0f, float(WIDTH), 0.0f, float(HEIGHT), -1.0f, 1.0f);
+
+    SpriteBatch batch(MAX_SPRITES);
+
+    auto renderFrame = [&](const vector<Prop> &props)
+    {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        int drawCalls = batched ? drawBatched(props, shaderID, batch, projection)
+                                : drawPerSprite(props, shaderID, VAO, projection);
+        glfwSwapBuffers(window);
+        return drawCalls;
+    };
+
+    if (sweep)
+    {
+        const int warmupFrames = 10, measuredFrames = 100;
+
+        printf("%-10s %-10s %-12s %-14s\n", "sprites", "modo", "draw calls", "frame (ms)");
+        for (int count = MIN_SPRITES; count <= MAX_SPRITES; count += STEP_SPRITES)
+        {
+            vector<Prop> props = makeProps(count, textures);
+            for (int mode = 0; mode < 2; mode++)
+            {
+                batched = mode == 1;
+                int drawCalls = 0;
+                for (int f = 0; f < warmupFrames; f++)
+                    renderFrame(props);
+
+                glFinish();
+                double start_s = glfwGetTime();
+                for (int f = 0; f < measuredFrames; f++)
+                {
+                    drawCalls = renderFrame(props);
+                    glfwPollEvents();
+                }
+                glFinish();
+                double frame_ms = (glfwGetTime() - start_s) * 1000.0 / measuredFrames;
+
+                printf("%-10d %-10s %-12d %-14.3f\n", count, batched ? "batch" : "sprite", drawCalls, frame_ms);
+            }
+        }
+
+        glDeleteVertexArrays(1, &VAO);
+        batch.clear();
+        glfwTerminate();
+        return 0;
+    }
+
+    vector<Prop> props = makeProps(spriteCount, textures);
+    int propsCount = spriteCount;
+
+    double report_s = glfwGetTime();
+    double prev_s = report_s;
+    double accum_s = 0.0;
+    int frames = 0;
+    int drawCalls = 0;
+
+    while (!glfwWindowShouldClose(window))
+    {
+        glfwPollEvents();
+
+        if (propsCount != spriteCount)
+        {
+            props = makeProps(spriteCount, textures);
+            propsCount = spriteCount;
+        }
+
+        drawCalls = renderFrame(props);
+
+        double curr_s = glfwGetTime();
+        accum_s += curr_s - prev_s;
+        prev_s = curr_s;
+        frames++;
+
+        if (curr_s - report_s >= 1.0)
+        {
+            double frame_ms = accum_s * 1000.0 / frames;
+            char tmp[256];
+            snprintf(tmp, sizeof(tmp), "%s | %d sprites | %d draw calls | %.3f ms/frame",
+                     batched ? "batch" : "sprite", spriteCount, drawCalls, frame_ms);
+            glfwSetWindowTitle(window, tmp);
+            cout << tmp << endl;
+
+            report_s = curr_s;
+            accum_s = 0.0;
+            frames = 0;
+        }
+    }
+
+    glDeleteVertexArrays(1, &VAO);
+    batch.clear();
+    glfwTerminate();
+    return 0;
+}
+
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
+{
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, GL_TRUE);
+
+    if (action != GLFW_PRESS)
+        return;
+
+    if (key == GLFW_KEY_B)
+        batched = !batched;
+    if (key == GLFW_KEY_UP)
+        spriteCount = std::min(spriteCount + STEP_SPRITES, MAX_SPRITES);
+    if (key == GLFW_KEY_DOWN)
+        spriteCount = std::max(spriteCount - STEP_SPRITES, MIN_SPRITES);
+}
+
+int setupSprite()
+{
+    GLfloat vertices[] = {
+        // x   y    z    s     t
+        -0.5, 0.5, 0.0, 0.0, 1.0,  // V0
+        -0.5, -0.5, 0.0, 0.0, 0.0, // V1
+        0.5, 0.5, 0.0, 1.0, 1.0,   // V2
+        0.5, -0.5, 0.0, 1.0, 0.0   // V3
+    };
+
+    GLuint VBO, VAO;
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (GLvoid *)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (GLvoid *)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindVertexArray(0);
+
+    return VAO;
+}
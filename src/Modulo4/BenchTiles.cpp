@@ -0,0 +1,146 @@
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "TileStreamer.h"
+using namespace std;
+namespace fs = std::filesystem;
+
+/*
+ * Teste do TileStreamer com a vista parada: cinco camadas do tamanho das do
+ * Parallax (2048x1546, tiles de 256) numa janela de 800x800, em alguns
+ * zooms, com um limite de memória menor que a vista no zoom 1 (o pior caso
+ * para o prefetch). Cada frame pede as vistas de todas as camadas e depois a
+ * margem do prefetch, como o Parallax.
+ *
+ * Uso:
+ *   BenchTiles [limite em MB]    (padrão: 32)
+ *
+ * Com a vista parada o streaming tem que assentar: nos últimos FRAMES_QUIET
+ * frames nenhum tile carregado nem apagado, e busy() falso no fim, senão o
+ * laço ocioso do Parallax nunca dormiria. A coluna "assentou" mostra isso, e o
+ * programa sai com 1 se algum zoom falhar.
+ */
+
+const int LAYER_COUNT = 5;
+const int LAYER_WIDTH = 2048, LAYER_HEIGHT = 1546;
+const int TILE_SIZE = 256;
+const int SCREEN = 800;
+const int FRAMES = 300;
+const int FRAMES_QUIET = 100;
+
+int main(int argc, char **argv)
+{
+    int capMb = argc > 1 ? max(1, atoi(argv[1])) : 32;
+
+    glfwInit();
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    // Só precisamos do contexto
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "Teste de tiles", nullptr, nullptr);
+    if (!window)
+    {
+        std::cerr << "Falha ao criar a janela GLFW" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Falha ao inicializar GLAD" << std::endl;
+        return -1;
+    }
+
+    // Camadas opacas geradas aqui: o conteúdo não muda o que é pedido
+    fs::path dir = fs::temp_directory_path() / "BenchTiles";
+    fs::create_directories(dir);
+    vector<vector<uint8_t>> levels;
+    for (int w = LAYER_WIDTH, h = LAYER_HEIGHT;; w = max(1, w / 2), h = max(1, h / 2))
+    {
+        levels.emplace_back(size_t(w) * h * 4, uint8_t(255));
+        if (w == 1 && h == 1)
+            break;
+    }
+    vector<string> layerPaths;
+    for (int i = 0; i < LAYER_COUNT; i++)
+    {
+        string path = (dir / ("camada" + to_string(i) + ".png")).string();
+        if (!writeTiledImage(tiledImagePath(path), levels, LAYER_WIDTH, LAYER_HEIGHT, TILE_SIZE, LAYOUT_RGBA, 0))
+        {
+            cerr << "Falha ao gravar " << tiledImagePath(path) << endl;
+            return -1;
+        }
+        layerPaths.push_back(path);
+    }
+
+    printf("%-6s %6s %10s %10s %14s %12s %6s %9s\n", "zoom", "nível", "carregados", "apagados", "últimos frames",
+           "residentes", "busy", "assentou");
+
+    const float zooms[] = {1.0f, 1.5f, 2.0f, 4.0f};
+    bool ok = true;
+    for (float zoom : zooms)
+    {
+        TileStreamer tiles(size_t(capMb) * 1024 * 1024);
+        int images[LAYER_COUNT];
+        for (int i = 0; i < LAYER_COUNT; i++)
+            images[i] = tiles.open(layerPaths[i]);
+
+        // A vista do Parallax com o deslocamento zerado
+        float viewW = LAYER_WIDTH / zoom, viewH = LAYER_HEIGHT / zoom;
+        float x0 = (LAYER_WIDTH - viewW) * 0.5f, y0 = (LAYER_HEIGHT - viewH) * 0.5f;
+        float margin = viewW * 0.25f;
+        int level = tiles.levelFor(images[0], viewW, viewH, SCREEN, SCREEN);
+
+        vector<TileStreamer::DrawTile> drawTiles;
+        int loadedBefore = 0, evictedBefore = 0;
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            if (frame == FRAMES - FRAMES_QUIET)
+            {
+                loadedBefore = tiles.stats().loaded;
+                evictedBefore = tiles.stats().evicted;
+            }
+
+            tiles.update();
+            for (int i = 0; i < LAYER_COUNT; i++)
+            {
+                drawTiles.clear();
+                tiles.view(images[i], level, x0, y0, x0 + viewW, y0 + viewH, drawTiles);
+            }
+            for (int i = 0; i < LAYER_COUNT; i++)
+                tiles.prefetch(images[i], level, x0 - margin, y0, x0 + viewW + margin, y0 + viewH);
+
+            // As threads de trabalho no tempo de um frame
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+
+        const TileStreamer::Stats &stats = tiles.stats();
+        int loadedQuiet = stats.loaded - loadedBefore, evictedQuiet = stats.evicted - evictedBefore;
+        bool settled = loadedQuiet == 0 && evictedQuiet == 0 && !tiles.busy();
+        ok = ok && settled;
+
+        char quiet[32];
+        snprintf(quiet, sizeof(quiet), "+%d / +%d", loadedQuiet, evictedQuiet);
+        printf("%-6.1f %6d %10d %10d %14s %9.1f MB %6s %9s\n", zoom, level, stats.loaded, stats.evicted, quiet,
+               stats.residentBytes / (1024.0 * 1024.0), tiles.busy() ? "sim" : "não", settled ? "sim" : "NÃO");
+        tiles.clear();
+    }
+
+    error_code ec;
+    fs::remove_all(dir, ec);
+
+    glfwTerminate();
+    return ok ? 0 : 1;
+}
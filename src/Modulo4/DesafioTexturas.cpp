@@ -8,19 +8,24 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
+#include <vector>
+#include "Shader.h"
+#include "AssetLoader.h"
+#include "SpriteBatch.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "MainLoop.h"
 using namespace glm;
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
 using namespace std;
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
-int setupShader();
-int setupSprite();
-int loadTexture(string filePath);
 
 const GLuint WIDTH = 1920, HEIGHT = 1080;
 
+// Bytes enviados para a GL por frame enquanto as texturas chegam
+const size_t UPLOAD_BUDGET = 8 * 1024 * 1024;
+
 const GLchar *vertexShaderSource = R"(
  #version 400
  layout (location = 0) in vec3 position;
@@ -51,11 +56,11 @@ const GLchar *fragmentShaderSource = R"(
 class Sprite
 {
 public:
-    Sprite(string path, int shaderID, float relWidth, float relHeight, float xpos = 0.0f, float ypos = 0.0f)
+    Sprite(AssetLoader &loader, string path, int shaderID, float relWidth, float relHeight, float xpos = 0.0f, float ypos = 0.0f)
     {
-        _sprite = loadTexture(path);
-        _vao = setupSprite();
-        _projMat = ortho(0.0f, float(WIDTH), 0.0f, float(HEIGHT), -1.0f, 1.0f);
+        _loader = &loader;
+        // relWidth x relHeight já estão em pixels da janela
+        _sprite = loader.request(path, GL_NEAREST, GL_REPEAT, int(relWidth), int(relHeight));
         _shaderID = shaderID;
 
         mat4 model = mat4(1.0f);
@@ -64,27 +69,15 @@ public:
         _modelMat = model;
     }
 
-    void draw()
+    // Enquanto a textura não está residente o loader devolve a substituta
+    void draw(SpriteBatch &batch, int layer)
     {
-        glUseProgram(_shaderID);
-
-        glUniformMatrix4fv(glGetUniformLocation(_shaderID, "model"), 1, GL_FALSE, value_ptr(_modelMat));
-        glUniformMatrix4fv(glGetUniformLocation(_shaderID, "projection"), 1, GL_FALSE, value_ptr(_projMat));
-
-        glBindVertexArray(_vao);
-        glBindTexture(GL_TEXTURE_2D, _sprite);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    }
-
-    void clear()
-    {
-        glDeleteVertexArrays(1, &_vao);
+        batch.draw(_loader->texture(_sprite), _shaderID, _modelMat, layer);
     }
 
 private:
-    GLuint _vao;
-    GLuint _sprite;
-    mat4 _projMat;
+    AssetLoader *_loader;
+    int _sprite;
     mat4 _modelMat;
     int _shaderID;
 };
@@ -126,38 +119,53 @@ int main()
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
-    GLuint shaderID = setupShader();
+    Profiler::init("DesafioTexturas");
+
+    GLuint shaderID = createShaderProgram(vertexShaderSource, fragmentShaderSource);
 
-    glUseProgram(shaderID);
+    GLState::useProgram(shaderID);
 
     double prev_s = glfwGetTime();
     double title_countdown_s = 0.1;
 
     float colorValue = 0.0;
 
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
 
     glUniform1i(glGetUniformLocation(shaderID, "tex_buff"), 0);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_ALWAYS);
+    // O batch entrega os vértices já transformados, então model fica fixa na identidade
+    mat4 projection = ortho(0.0f, float(WIDTH), 0.0f, float(HEIGHT), -1.0f, 1.0f);
+    glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+    glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(mat4(1.0f)));
+
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_ALWAYS);
+
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    AssetLoader loader(UPLOAD_BUDGET);
 
     vector<Sprite> sprites = {
-        Sprite("../assets/textures/sky.png", shaderID, WIDTH, HEIGHT, WIDTH / 2, HEIGHT / 2),
-        Sprite("../assets/textures/floor.png", shaderID, WIDTH, HEIGHT / 2, WIDTH / 2, HEIGHT / 4),
-        Sprite("../assets/textures/palace.png", shaderID, WIDTH, HEIGHT / 2 + 30, WIDTH / 2, HEIGHT - HEIGHT / 4),
-        Sprite("../assets/textures/gates.png", shaderID, WIDTH, HEIGHT, WIDTH / 2, HEIGHT - HEIGHT / 2),
-        Sprite("../assets/textures/woods.png", shaderID, WIDTH, HEIGHT / 2, WIDTH / 2, HEIGHT / 4),
-        Sprite("../assets/textures/eye.png", shaderID, 400, 400, 500.0, 380.0),
-        Sprite("../assets/textures/skulls.png", shaderID, 100, 100, 1300.0, 200.0),
-        Sprite("../assets/textures/dragon.png", shaderID, 350, 350, 1200.0, 400.0),
-        Sprite("../assets/textures/flower.png", shaderID, 200, 200, 750.0, 150.0),
+        Sprite(loader, "../assets/textures/sky.png", shaderID, WIDTH, HEIGHT, WIDTH / 2, HEIGHT / 2),
+        Sprite(loader, "../assets/textures/floor.png", shaderID, WIDTH, HEIGHT / 2, WIDTH / 2, HEIGHT / 4),
+        Sprite(loader, "../assets/textures/palace.png", shaderID, WIDTH, HEIGHT / 2 + 30, WIDTH / 2, HEIGHT - HEIGHT / 4),
+        Sprite(loader, "../assets/textures/gates.png", shaderID, WIDTH, HEIGHT, WIDTH / 2, HEIGHT - HEIGHT / 2),
+        Sprite(loader, "../assets/textures/woods.png", shaderID, WIDTH, HEIGHT / 2, WIDTH / 2, HEIGHT / 4),
+        Sprite(loader, "../assets/textures/eye.png", shaderID, 400, 400, 500.0, 380.0),
+        Sprite(loader, "../assets/textures/skulls.png", shaderID, 100, 100, 1300.0, 200.0),
+        Sprite(loader, "../assets/textures/dragon.png", shaderID, 350, 350, 1200.0, 400.0),
+        Sprite(loader, "../assets/textures/flower.png", shaderID, 200, 200, 750.0, 150.0),
     };
 
-    while (!glfwWindowShouldClose(window))
+    SpriteBatch batch(sprites.size());
+    bool streaming = true;
+
+    // Enquanto há texturas chegando o laço anima; depois só desenha com eventos
+    MainLoop loop(window);
+    loop.setAnimating(true);
+    auto renderFrame = [&]()
     {
         {
             double curr_s = glfwGetTime();
@@ -167,157 +175,68 @@ int main()
             title_countdown_s -= elapsed_s;
             if (title_countdown_s <= 0.0 && elapsed_s > 0.0)
             {
-                double fps = 1.0 / elapsed_s;
+                const AssetLoader::Stats &assets = loader.stats();
+                const GLState::Stats &state = GLState::frameStats();
                 char tmp[256];
-                snprintf(tmp, sizeof(tmp), "Ola Triangulo! -- Rossana\tFPS %.2lf", fps);
+                snprintf(tmp, sizeof(tmp), "Ola Triangulo! -- Rossana\t%s\tTexturas %d/%d\tEstado GL %d emitidas / %d evitadas",
+                         Profiler::frameSummary(), assets.resident, assets.requested, state.issued, state.skipped);
                 glfwSetWindowTitle(window, tmp);
 
                 title_countdown_s = 0.1;
             }
         }
 
-        glfwPollEvents();
+        GLState::resetFrameStats();
 
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        {
+            ProfileScope cpu("update");
 
-        glLineWidth(10);
-        glPointSize(20);
+            loader.update();
+            if (streaming && !loader.busy())
+            {
+                const AssetLoader::Stats &assets = loader.stats();
+                printf("Streaming: primeiro frame em %.1f ms, texturas residentes em %.1f ms, pior frame %.1f ms (%.1f MB, %.1f MB "
+                       "de níveis não usados evitados)\n",
+                       assets.timeToFirstFrameMs, assets.timeToResidentMs, assets.worstFrameMs, assets.bytesUploaded / (1024.0 * 1024.0),
+                       assets.bytesSkipped / (1024.0 * 1024.0));
+                streaming = false;
+            }
+            loop.setAnimating(loader.busy());
+        }
 
-        for (auto &sprite : sprites)
         {
-            sprite.draw();
-        }
+            ProfileScope cpu("draw");
+            GpuProfileScope gpu("draw");
 
-        glUseProgram(shaderID);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glfwSwapBuffers(window);
-    }
+            glLineWidth(10);
+            glPointSize(20);
 
-    for (auto &sprite : sprites)
-    {
-        sprite.clear();
-    }
+            // A ordem do vetor é a ordem de pintura, então cada sprite vai na sua própria camada
+            batch.begin();
+            for (size_t i = 0; i < sprites.size(); i++)
+            {
+                sprites[i].draw(batch, int(i));
+            }
+            batch.end();
+        }
+    };
+    loop.run(renderFrame);
+
+    loader.clear();
+    batch.clear();
 
+    Profiler::shutdown();
     glfwTerminate();
     return 0;
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+    Profiler::handleKey(key, action);
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
 }
-
-int setupShader()
-{
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return shaderProgram;
-}
-
-int setupSprite()
-{
-    GLfloat vertices[] = {
-        // x   y    z    s     t
-        -0.5, 0.5, 0.0, 0.0, 1.0,  // V0
-        -0.5, -0.5, 0.0, 0.0, 0.0, // V1
-        0.5, 0.5, 0.0, 1.0, 1.0,   // V2
-        0.5, -0.5, 0.0, 1.0, 0.0   // V3
-    };
-
-    GLuint VBO, VAO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (GLvoid *)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (GLvoid *)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glBindVertexArray(0);
-
-    return VAO;
-}
-
-int loadTexture(string filePath)
-{
-    GLuint texID;
-
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    int width, height, nrChannels;
-
-    unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
-    if (data)
-    {
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        }
-        else
-
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        }
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-
-    stbi_image_free(data);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    return texID;
-}
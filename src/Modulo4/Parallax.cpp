@@ -8,16 +8,35 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "Shader.h"
+#include "Texture.h"
+#include "AlphaCoverage.h"
+#include "TileStreamer.h"
+#include "ShaderProgram.h"
+#include "GLState.h"
+#include "MainLoop.h"
+#include "Profiler.h"
 using namespace glm;
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
 using namespace std;
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
+void scroll_callback(GLFWwindow *window, double dx, double dy);
 
-int setupShader();
 int setupSprite();
-int loadTexture(string filePath);
+
+// Malha de uma camada feita dos blocos não vazios: os opacos primeiro, depois os mistos, no mesmo VBO
+struct CoverageMesh
+{
+	GLuint VAO = 0;
+	GLint opaqueCount = 0;
+	GLint mixedCount = 0;
+	double fill = 0.0; // fração da tela que a camada preenche
+};
+
+CoverageMesh setupCoverageMesh(const AlphaCoverage &coverage, float depth);
 
 const GLuint WIDTH = 800, HEIGHT = 800;
 
@@ -45,15 +64,93 @@ const GLchar *fragmentShaderSource = R"(
  }
  )";
 
-float offset_nuvens = 0.0f;
-float offset_montanha = 0.0f;
-float offset_arvore = 0.0f;
-float offset_chao = 0.0f;
+// Um tile do TileStreamer: o quad do setupSprite() esticado no retângulo do tile, em NDC, e no pedaço da textura
+const GLchar *tileVertexShaderSource = R"(
+ #version 400
+ layout (location = 0) in vec3 position;
+ layout (location = 1) in vec2 texc;
+ uniform vec4 rect;
+ uniform vec4 uvRect;
+ out vec2 tex_coord;
+ void main()
+ {
+	tex_coord = mix(uvRect.xy, uvRect.zw, texc);
+	gl_Position = vec4(mix(rect.xy, rect.zw, texc), position.z, 1.0);
+ }
+ )";
+
+// Todas as camadas numa passada: uma amostra de cada camada do array por pixel, misturadas no shader
+// como o glBlendFunc(SRC_ALPHA, ONE_MINUS_SRC_ALPHA) faria, sobre o preto do clear
+const GLchar *compositorFragmentShaderSource = R"(
+ #version 400
+ in vec2 tex_coord;
+ out vec4 color;
+ uniform sampler2DArray layers;
+ uniform int layerCount;
+ uniform float offsets[MAX_LAYERS];
+ void main()
+ {
+	 vec3 rgb = vec3(0.0);
+	 for (int i = 0; i < layerCount; i++)
+	 {
+		 vec4 layer = texture(layers, vec3(tex_coord.s + offsets[i], tex_coord.t, float(i)));
+		 rgb = mix(rgb, layer.rgb, layer.a);
+	 }
+	 color = vec4(rgb, 1.0);
+ }
+ )";
+
+const int MAX_LAYERS = 8;
+
+const char *layerPaths[] = {
+	"../assets/sprites/background.png",
+	"../assets/sprites/nuvens.png",
+	"../assets/sprites/montanha.png",
+	"../assets/sprites/arvores.png",
+	"../assets/sprites/chao.png",
+};
+const int LAYER_COUNT = 5;
+
+// Nomes literais, como o Profiler pede
+const char *fillCounters[] = {
+	"preenchimento background",
+	"preenchimento nuvens",
+	"preenchimento montanha",
+	"preenchimento arvores",
+	"preenchimento chao",
+};
+
+// Lado dos blocos da análise de cobertura, em pixels da imagem
+const int COVERAGE_TILE = 32;
+
+// C alterna entre o compositor (uma passada), as malhas de cobertura, o desenho antigo, camada por camada,
+// e os tiles dos .ptiles, que só ficam na memória enquanto estão em vista
+enum DrawMode
+{
+	DRAW_COMPOSITOR,
+	DRAW_COVERAGE,
+	DRAW_LAYERS,
+	DRAW_TILES
+};
+DrawMode drawMode = DRAW_COMPOSITOR;
+
+// Aproximação da rolagem do mouse, só no modo dos tiles: a vista mostra 1/zoom da camada
+float zoom = 1.0f;
+const float MAX_ZOOM = 4.0f;
+const float ZOOM_STEP = 1.25f;
+
+// Margem do prefetch dos dois lados, em vistas
+const float PREFETCH_MARGIN = 0.25f;
+
+// A simulação anda em tiques fixos; o desenho interpola entre o tique anterior e o atual
+const double TICK_S = 1.0 / 60.0;
+
+// Deslocamento em NDC de cada camada no tique atual e no anterior
+float layerOffset[LAYER_COUNT] = {};
+float prevLayerOffset[LAYER_COUNT] = {};
 
-const float speed_nuvens = 0.002f;
-const float speed_montanha = 0.005f;
-const float speed_arvore = 0.01f;
-const float speed_chao = 0.02f;
+// Em NDC por segundo: os 0.002, 0.005, 0.01 e 0.02 por frame de antes, a 60 Hz. O fundo não anda
+const float layerSpeed[LAYER_COUNT] = {0.0f, 0.12f, 0.3f, 0.6f, 1.2f};
 
 float move_dir = 0.0f;
 
@@ -78,6 +175,7 @@ int main()
 	glfwMakeContextCurrent(window);
 
 	glfwSetKeyCallback(window, key_callback);
+	glfwSetScrollCallback(window, scroll_callback);
 
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 	{
@@ -94,34 +192,155 @@ int main()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 
-	GLuint shaderID = setupShader();
+	Profiler::init("Parallax");
+
+	ShaderProgram shader(createShaderProgram(vertexShaderSource, fragmentShaderSource));
+	string layerDefines = "#define MAX_LAYERS " + to_string(MAX_LAYERS) + "\n";
+	ShaderProgram compositorShader(createShaderProgram(vertexShaderSource, compositorFragmentShaderSource, layerDefines.c_str()));
+	ShaderProgram tileShader(createShaderProgram(tileVertexShaderSource, fragmentShaderSource));
 
 	GLuint VAO = setupSprite();
 
-	GLuint background = loadTexture("../assets/sprites/background.png");
-	GLuint nuvens = loadTexture("../assets/sprites/nuvens.png");
-	GLuint montanha = loadTexture("../assets/sprites/montanha.png");
-	GLuint arvore = loadTexture("../assets/sprites/arvores.png");
-	GLuint chao = loadTexture("../assets/sprites/chao.png");
+	// As camadas têm todas o mesmo tamanho, então cabem num array; se não couberem, fica o desenho por camada
+	// As camadas cobrem a janela inteira: só os níveis amostrados nesse tamanho vão para a GL
+	GLuint layerArray = loadTextureArray(vector<string>(layerPaths, layerPaths + LAYER_COUNT), GL_NEAREST, GL_REPEAT, nullptr,
+										 nullptr, WIDTH, HEIGHT);
+	drawMode = layerArray ? DRAW_COMPOSITOR : DRAW_COVERAGE;
 
-	glUseProgram(shaderID);
+	// Texturas separadas só se as malhas ou o desenho por camada forem usados
+	GLuint layerTextures[LAYER_COUNT] = {};
+	auto loadLayerTextures = [&]()
+	{
+		if (layerTextures[0])
+			return;
+		for (int i = 0; i < LAYER_COUNT; i++)
+			layerTextures[i] = loadTexture(layerPaths[i], GL_NEAREST, GL_REPEAT, nullptr, nullptr, WIDTH, HEIGHT);
+	};
+	// Os .ptiles são abertos na primeira vez que o modo aparece; sem eles o modo é pulado.
+	// O limite de memória vem de PGCCHIB_TILE_CACHE_MB (em MB) ou é calculado quando os tiles são abertos
+	const char *cacheEnv = getenv("PGCCHIB_TILE_CACHE_MB");
+	int cacheMb = cacheEnv ? atoi(cacheEnv) : 0;
+	if (cacheEnv && cacheMb <= 0)
+		cout << "PGCCHIB_TILE_CACHE_MB inválido (" << cacheEnv << "): o limite será calculado" << endl;
+	TileStreamer tiles(size_t(std::max(0, cacheMb)) * 1024 * 1024);
+	int tileImages[LAYER_COUNT];
+	int tilesOpened = 0; // 0: ainda não tentou, 1: abertos, -1: faltam
+	vector<TileStreamer::DrawTile> drawTiles;
+	auto openTiles = [&]()
+	{
+		if (tilesOpened == 0)
+		{
+			tilesOpened = 1;
+			for (int i = 0; i < LAYER_COUNT && tilesOpened == 1; i++)
+			{
+				tileImages[i] = tiles.open(layerPaths[i]);
+				if (tileImages[i] < 0)
+				{
+					cout << "Sem os tiles de " << layerPaths[i] << ": rode TextureCook --tiles ../assets" << endl;
+					tilesOpened = -1;
+				}
+			}
+
+			// Sem limite dado, cabem as vistas de todas as camadas com a margem do prefetch e o tile fixo,
+			// no zoom (e no nível) em que elas ocupam mais
+			if (tilesOpened == 1 && cacheMb <= 0)
+			{
+				size_t cap = 0;
+				for (float z = 1.0f;; z = std::min(MAX_ZOOM, z * ZOOM_STEP))
+				{
+					size_t bytes = 0;
+					for (int i = 0; i < LAYER_COUNT; i++)
+					{
+						int image = tileImages[i];
+						float viewW = tiles.width(image) / z, viewH = tiles.height(image) / z;
+						int level = tiles.levelFor(image, viewW, viewH, WIDTH, HEIGHT);
+						bytes += tiles.viewBytes(image, level, viewW * (1.0f + 2.0f * PREFETCH_MARGIN), viewH);
+						bytes += tiles.viewBytes(image, tiles.levelCount(image) - 1, viewW, viewH);
+					}
+					cap = std::max(cap, bytes);
+					if (z >= MAX_ZOOM)
+						break;
+				}
+				tiles.setMemoryCap(cap);
+				printf("Limite dos tiles: %.1f MB\n", cap / (1024.0 * 1024.0));
+			}
+		}
+		return tilesOpened == 1;
+	};
+
+	// Cobertura do alfa de cada camada: blocos vazios ficam fora da malha, os opacos vão sem blend.
+	// Cada camada fica num z, da frente (chão) para o fundo. A análise lê as cinco imagens inteiras,
+	// então só é feita na primeira vez que o modo aparece
+	CoverageMesh meshes[LAYER_COUNT];
+	bool coverageLoaded = false;
+	auto loadCoverage = [&]()
+	{
+		if (coverageLoaded)
+			return;
+		coverageLoaded = true;
+		printf("%-12s %8s %8s %8s %12s %14s\n", "camada", "vazio", "opaco", "misto", "retângulos", "preenchimento");
+		for (int i = 0; i < LAYER_COUNT; i++)
+		{
+			AlphaCoverage coverage;
+			if (!coverage.load(layerPaths[i], COVERAGE_TILE))
+			{
+				cout << "Failed to load texture: " << layerPaths[i] << endl;
+				continue;
+			}
+			meshes[i] = setupCoverageMesh(coverage, 0.5f - 0.1f * i);
+			printf("%-12s %7.1f%% %7.1f%% %7.1f%% %12d %13.1f%%\n", fillCounters[i] + strlen("preenchimento "),
+				   coverage.fraction(COVERAGE_EMPTY) * 100.0, coverage.fraction(COVERAGE_OPAQUE) * 100.0,
+				   coverage.fraction(COVERAGE_MIXED) * 100.0, (meshes[i].opaqueCount + meshes[i].mixedCount) / 6,
+				   meshes[i].fill * 100.0);
+		}
+	};
+
+	compositorShader.use();
+	compositorShader.setInt("layers"_u, 0);
+	compositorShader.setInt("layerCount"_u, LAYER_COUNT);
+
+	shader.use();
 
 	double prev_s = glfwGetTime();
 	double title_countdown_s = 0.1;
 
-	float colorValue = 0.0;
+	GLState::activeTexture(GL_TEXTURE0);
+
+	shader.setInt("tex_buff"_u, 0);
 
-	glActiveTexture(GL_TEXTURE0);
+	GLState::enable(GL_DEPTH_TEST);
+	GLState::depthFunc(GL_ALWAYS);
 
-	glUniform1i(glGetUniformLocation(shaderID, "tex_buff"), 0);
+	GLState::enable(GL_BLEND);
+	GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_ALWAYS);
+	MainLoop loop(window);
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// Cada camada é desenhada em offset e offset + 2: o deslocamento fica em [-2, 0)
+	auto wrapOffset = [](float offset)
+	{
+		while (offset < -2.0f)
+			offset += 2.0f;
+		while (offset >= 0.0f)
+			offset -= 2.0f;
+		return offset;
+	};
 
-	while (!glfwWindowShouldClose(window))
+	// O fundo fica em 0, desenhado uma vez só
+	auto tick = [&](double dt)
+	{
+		for (int i = 1; i < LAYER_COUNT; i++)
+		{
+			float offset = layerOffset[i] + layerSpeed[i] * move_dir * float(dt);
+
+			// A mesma volta vale para o tique anterior, para a interpolação não saltar
+			float wrapped = wrapOffset(offset);
+			prevLayerOffset[i] = layerOffset[i] + (wrapped - offset);
+			layerOffset[i] = wrapped;
+		}
+	};
+
+	auto renderFrame = [&](double alpha)
 	{
 		{
 			double curr_s = glfwGetTime();
@@ -131,82 +350,216 @@ int main()
 			title_countdown_s -= elapsed_s;
 			if (title_countdown_s <= 0.0 && elapsed_s > 0.0)
 			{
-				double fps = 1.0 / elapsed_s;
-				char tmp[256];
-				sprintf(tmp, "Ola Triangulo! -- Rossana\tFPS %.2lf", fps);
+				const ShaderProgram::Stats &uniforms = ShaderProgram::frameStats();
+				const GLState::Stats &state = GLState::frameStats();
+				const char *modes[] = {"Compositor", "Malhas", "Por camada", "Tiles"};
+				char tileInfo[160] = "";
+				if (drawMode == DRAW_TILES)
+				{
+					const TileStreamer::Stats &streamed = tiles.stats();
+					snprintf(tileInfo, sizeof(tileInfo), " %d residentes (%.1f de %.0f MB), %d faltando, zoom %.1fx", streamed.residentTiles,
+							 streamed.residentBytes / (1024.0 * 1024.0), tiles.memoryCap() / (1024.0 * 1024.0), streamed.missing, zoom);
+				}
+				char tmp[480];
+				snprintf(tmp, sizeof(tmp), "Ola Triangulo! -- Rossana\t%s\t%s%s (%.2f telas preenchidas)\tUniforms %d enviadas / %d evitadas\tEstado GL %d emitidas / %d evitadas",
+						 Profiler::frameSummary(), modes[drawMode], tileInfo, Profiler::counterValue("preenchimento"), uniforms.uploads,
+						 uniforms.skipped, state.issued, state.skipped);
 				glfwSetWindowTitle(window, tmp);
 
 				title_countdown_s = 0.1;
 			}
 		}
 
-		glfwPollEvents();
+		// A tecla só troca o modo; sem o array não há compositor, e as texturas separadas e as malhas são carregadas aqui
+		if (drawMode == DRAW_TILES && !openTiles())
+			drawMode = DRAW_COMPOSITOR;
+		if (drawMode == DRAW_COMPOSITOR && !layerArray)
+			drawMode = DRAW_COVERAGE;
+		if (drawMode == DRAW_COVERAGE || drawMode == DRAW_LAYERS)
+			loadLayerTextures();
+		if (drawMode == DRAW_COVERAGE)
+			loadCoverage();
 
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		ShaderProgram::resetFrameStats();
+		GLState::resetFrameStats();
 
-		glLineWidth(10);
-		glPointSize(20);
+		{
+			ProfileScope cpu("draw");
+			GpuProfileScope gpu("draw");
 
-		glBindVertexArray(VAO);
+			// O compositor cobre a tela com pixels opacos: só o depth precisa ser limpo
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(drawMode == DRAW_COMPOSITOR ? GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glBindTexture(GL_TEXTURE_2D, background);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			glLineWidth(10);
+			glPointSize(20);
 
-		offset_nuvens += speed_nuvens * move_dir;
-		offset_montanha += speed_montanha * move_dir;
-		offset_arvore += speed_arvore * move_dir;
-		offset_chao += speed_chao * move_dir;
+			GLState::bindVertexArray(VAO);
 
-		auto wrapOffset = [](float offset)
-		{
-			while (offset < -2.0f)
-				offset += 2.0f;
-			while (offset >= 0.0f)
-				offset -= 2.0f;
-			return offset;
-		};
+			float layerOffsets[LAYER_COUNT] = {};
+			for (int i = 1; i < LAYER_COUNT; i++)
+				layerOffsets[i] = wrapOffset(prevLayerOffset[i] + (layerOffset[i] - prevLayerOffset[i]) * float(alpha));
 
-		offset_nuvens = wrapOffset(offset_nuvens);
-		offset_montanha = wrapOffset(offset_montanha);
-		offset_arvore = wrapOffset(offset_arvore);
-		offset_chao = wrapOffset(offset_chao);
+			// Pixels escritos, em telas: cada camada do desenho antigo cobre a tela toda
+			double fill = drawMode == DRAW_COMPOSITOR ? 1.0 : LAYER_COUNT;
 
-		glUseProgram(shaderID);
+			if (drawMode == DRAW_COMPOSITOR)
+			{
+				// O deslocamento em NDC vira deslocamento em UV: a tela inteira é uma volta da textura (GL_REPEAT)
+				float offsets[LAYER_COUNT];
+				for (int i = 0; i < LAYER_COUNT; i++)
+				{
+					offsets[i] = -layerOffsets[i] * 0.5f;
+					offsets[i] -= floor(offsets[i]);
+				}
+
+				GLState::disable(GL_BLEND);
+				compositorShader.use();
+				compositorShader.setFloatArray("offsets"_u, offsets, LAYER_COUNT);
+				GLState::bindTexture(GL_TEXTURE_2D_ARRAY, layerArray);
+				glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			}
+			else if (drawMode == DRAW_COVERAGE)
+			{
+				shader.use();
+
+				// Cada camada duas vezes, lado a lado, como no desenho antigo; o fundo não anda
+				auto drawRange = [&](int layer, GLint first, GLint count)
+				{
+					if (count == 0)
+						return;
+					GLState::bindVertexArray(meshes[layer].VAO);
+					GLState::bindTexture(GL_TEXTURE_2D, layerTextures[layer]);
+					shader.setFloat("offset_x"_u, layerOffsets[layer]);
+					glDrawArrays(GL_TRIANGLES, first, count);
+					if (layer > 0)
+					{
+						shader.setFloat("offset_x"_u, layerOffsets[layer] + 2.0f);
+						glDrawArrays(GL_TRIANGLES, first, count);
+					}
+				};
+
+				// Opacos sem blend, da frente para trás: o depth descarta o que fica atrás deles
+				GLState::disable(GL_BLEND);
+				GLState::depthFunc(GL_LESS);
+				for (int i = LAYER_COUNT - 1; i >= 0; i--)
+					drawRange(i, 0, meshes[i].opaqueCount);
+
+				// Mistos com blend, de trás para frente, testando o depth dos opacos sem escrever nele
+				GLState::enable(GL_BLEND);
+				GLState::depthMask(GL_FALSE);
+				for (int i = 0; i < LAYER_COUNT; i++)
+					drawRange(i, meshes[i].opaqueCount, meshes[i].mixedCount);
+
+				// O glClear do depth respeita a máscara
+				GLState::depthMask(GL_TRUE);
+				GLState::depthFunc(GL_ALWAYS);
+
+				fill = 0.0;
+				for (int i = 0; i < LAYER_COUNT; i++)
+				{
+					Profiler::counter(fillCounters[i], meshes[i].fill * 100.0);
+					fill += meshes[i].fill;
+				}
+			}
+			else if (drawMode == DRAW_TILES)
+			{
+				GLState::enable(GL_BLEND);
+				tileShader.use();
+				tiles.update();
+
+				// Com zoom 1 a camada ocupa a janela, como nos outros modos: o deslocamento anda meia imagem por unidade de NDC
+				float viewX0[LAYER_COUNT], viewY0[LAYER_COUNT], viewW[LAYER_COUNT], viewH[LAYER_COUNT];
+				int viewLevel[LAYER_COUNT];
+				for (int i = 0; i < LAYER_COUNT; i++)
+				{
+					float w = float(tiles.width(tileImages[i])), h = float(tiles.height(tileImages[i]));
+					viewW[i] = w / zoom;
+					viewH[i] = h / zoom;
+					viewX0[i] = (0.5f - layerOffsets[i] * 0.5f) * w - viewW[i] * 0.5f;
+					viewY0[i] = (h - viewH[i]) * 0.5f;
+					viewLevel[i] = tiles.levelFor(tileImages[i], viewW[i], viewH[i], WIDTH, HEIGHT);
+				}
+
+				fill = 0.0;
+				for (int i = 0; i < LAYER_COUNT; i++)
+				{
+					float x0 = viewX0[i], y0 = viewY0[i];
+					drawTiles.clear();
+					tiles.view(tileImages[i], viewLevel[i], x0, y0, x0 + viewW[i], y0 + viewH[i], drawTiles);
+
+					for (const TileStreamer::DrawTile &tile : drawTiles)
+					{
+						// y da imagem cresce para baixo e o das NDC para cima
+						float left = (tile.x0 - x0) / viewW[i] * 2.0f - 1.0f, right = (tile.x1 - x0) / viewW[i] * 2.0f - 1.0f;
+						float bottom = 1.0f - (tile.y1 - y0) / viewH[i] * 2.0f, top = 1.0f - (tile.y0 - y0) / viewH[i] * 2.0f;
+						GLState::bindTexture(GL_TEXTURE_2D, tile.texture);
+						tileShader.setVec4("rect"_u, left, bottom, right, top);
+						tileShader.setVec4("uvRect"_u, tile.s0, tile.t1, tile.s1, tile.t0);
+						glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+						fill += (std::min(right, 1.0f) - std::max(left, -1.0f)) * (std::min(top, 1.0f) - std::max(bottom, -1.0f)) / 4.0;
+					}
+				}
+
+				// Só com todas as vistas pedidas o limite sabe o que sobra. Com a margem dos dois lados,
+				// o que entra com a rolagem já está lá
+				for (int i = 0; i < LAYER_COUNT; i++)
+				{
+					float margin = viewW[i] * PREFETCH_MARGIN;
+					tiles.prefetch(tileImages[i], viewLevel[i], viewX0[i] - margin, viewY0[i], viewX0[i] + viewW[i] + margin,
+								   viewY0[i] + viewH[i]);
+				}
+			}
+			else
+			{
+				GLState::enable(GL_BLEND);
+				shader.use();
 
-		auto drawLayer = [&](GLuint texture, float offset)
-		{
-			glBindTexture(GL_TEXTURE_2D, texture);
+				auto drawLayer = [&](GLuint texture, float offset)
+				{
+					GLState::bindTexture(GL_TEXTURE_2D, texture);
 
-			glUniform1f(glGetUniformLocation(shaderID, "offset_x"), offset);
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+					shader.setFloat("offset_x"_u, offset);
+					glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-			glUniform1f(glGetUniformLocation(shaderID, "offset_x"), offset + 2.0f);
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-		};
+					shader.setFloat("offset_x"_u, offset + 2.0f);
+					glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+				};
 
-		glUniform1f(glGetUniformLocation(shaderID, "offset_x"), 0.0f);
-		glBindTexture(GL_TEXTURE_2D, background);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+				// O fundo é desenhado uma vez só, já com o shader e o deslocamento zerado
+				shader.setFloat("offset_x"_u, 0.0f);
+				GLState::bindTexture(GL_TEXTURE_2D, layerTextures[0]);
+				glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-		drawLayer(nuvens, offset_nuvens);
-		drawLayer(montanha, offset_montanha);
-		drawLayer(arvore, offset_arvore);
-		drawLayer(chao, offset_chao);
+				for (int i = 1; i < LAYER_COUNT; i++)
+					drawLayer(layerTextures[i], layerOffsets[i]);
+			}
+			Profiler::counter("preenchimento", fill);
+		}
 
-		glfwSwapBuffers(window);
-	}
+		// Parado, o laço só desenha com eventos; tiles a caminho também pedem frames
+		loop.setAnimating(move_dir != 0.0f || (drawMode == DRAW_TILES && tiles.busy()));
+	};
+	loop.runFixed(TICK_S, tick, renderFrame);
 
-	glDeleteVertexArrays(1, &VAO);
+	tiles.clear();
+	GLState::deleteVertexArray(VAO);
+	Profiler::shutdown();
 	glfwTerminate();
 	return 0;
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+	Profiler::handleKey(key, action);
+
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GL_TRUE);
 
+	if (key == GLFW_KEY_C && action == GLFW_PRESS)
+		drawMode = DrawMode((drawMode + 1) % 4);
+
 	if (key == GLFW_KEY_LEFT)
 	{
 		if (action == GLFW_PRESS || action == GLFW_REPEAT)
@@ -223,45 +576,9 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 	}
 }
 
-int setupShader()
+void scroll_callback(GLFWwindow *window, double dx, double dy)
 {
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-	GLint success;
-	GLchar infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-	glCompileShader(fragmentShader);
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	GLuint shaderProgram = glCreateProgram();
-	glAttachShader(shaderProgram, vertexShader);
-	glAttachShader(shaderProgram, fragmentShader);
-	glLinkProgram(shaderProgram);
-	glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-				  << infoLog << std::endl;
-	}
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
-
-	return shaderProgram;
+	zoom = std::min(MAX_ZOOM, std::max(1.0f, zoom * powf(ZOOM_STEP, float(dy))));
 }
 
 int setupSprite()
@@ -294,44 +611,56 @@ int setupSprite()
 	return VAO;
 }
 
-int loadTexture(string filePath)
+CoverageMesh setupCoverageMesh(const AlphaCoverage &coverage, float depth)
 {
-	GLuint texID;
-
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-	int width, height, nrChannels;
-
-	unsigned char *data = stbi_load(filePath.c_str(), &width, &height, &nrChannels, 0);
-
-	if (data)
+	vector<CoverageRect> opaque, mixed;
+	coverage.rects(COVERAGE_OPAQUE, opaque);
+	coverage.rects(COVERAGE_MIXED, mixed);
+
+	// Mesmo layout do setupSprite() (x y z s t), com o quad da imagem ocupando a tela toda
+	float w = float(coverage.width()), h = float(coverage.height());
+	vector<GLfloat> vertices;
+	auto addRects = [&](const vector<CoverageRect> &rects)
 	{
-		if (nrChannels == 3)
+		for (const CoverageRect &r : rects)
 		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+			float s0 = r.x / w, s1 = (r.x + r.width) / w;
+			float t0 = 1.0f - r.y / h, t1 = 1.0f - (r.y + r.height) / h;
+			float x0 = s0 * 2.0f - 1.0f, x1 = s1 * 2.0f - 1.0f;
+			float y0 = t0 * 2.0f - 1.0f, y1 = t1 * 2.0f - 1.0f;
+			GLfloat quad[] = {
+				x0, y0, depth, s0, t0,
+				x0, y1, depth, s0, t1,
+				x1, y0, depth, s1, t0,
+				x1, y0, depth, s1, t0,
+				x0, y1, depth, s0, t1,
+				x1, y1, depth, s1, t1};
+			vertices.insert(vertices.end(), quad, quad + 30);
 		}
-		else
+	};
+	addRects(opaque);
+	addRects(mixed);
 
-		{
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		}
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
+	CoverageMesh mesh;
+	mesh.opaqueCount = GLint(opaque.size() * 6);
+	mesh.mixedCount = GLint(mixed.size() * 6);
+	mesh.fill = coverage.fraction(COVERAGE_OPAQUE) + coverage.fraction(COVERAGE_MIXED);
+
+	GLuint VBO;
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
 
-	stbi_image_free(data);
+	glGenVertexArrays(1, &mesh.VAO);
+	GLState::bindVertexArray(mesh.VAO);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (GLvoid *)0);
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (GLvoid *)(3 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindVertexArray(0);
 
-	return texID;
+	return mesh;
 }
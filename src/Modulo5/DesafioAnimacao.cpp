@@ -8,17 +8,24 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
+#include <vector>
+#include "Shader.h"
+#include "ShaderProgram.h"
+#include "TextureAtlas.h"
+#include "GLState.h"
+#include "MainLoop.h"
+#include "Profiler.h"
 using namespace glm;
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
 using namespace std;
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
-int setupShader();
 
 const GLuint WIDTH = 600, HEIGHT = 600;
 
+// Passo fixo da simulação: a velocidade do personagem e das animações não depende dos frames
+const double TICK_S = 1.0 / 60.0;
+
 const GLchar *vertexShaderSource = R"(
 #version 400
 layout (location = 0) in vec3 position;
@@ -51,46 +58,33 @@ void main()
 }
 )";
 
+// Uma animação: os quadros de uma folha dentro do atlas
 class Sprite
 {
 private:
-    GLuint _vao, _vbo, _ebo, _texID;
-    GLuint _shaderID;
+    GLuint _vao, _vbo, _ebo;
+    ShaderProgram *_shader;
 
-    int _textureWidth, _textureHeight;
-    int _frameWidth, _frameHeight;
+    const TextureAtlas *_atlas;
+    int _sheet;
 
-    int _framesX, _framesY;
     int _currentFrame;
     float _timeSinceLastFrame;
     float _frameDuration;
 
 public:
     float _relWidth, _relHeight;
-    Sprite(const char *path, GLuint shaderID, int frameWidth, int frameHeight, int framesX, int framesY, float relWidth, float relHeight)
-        : _shaderID(shaderID), _frameWidth(frameWidth), _frameHeight(frameHeight), _framesX(framesX), _framesY(framesY), _currentFrame(0),
+    Sprite(const TextureAtlas *atlas, const char *sheetName, ShaderProgram *shader, float relWidth, float relHeight)
+        : _shader(shader), _atlas(atlas), _currentFrame(0),
           _timeSinceLastFrame(0.0f), _frameDuration(0.2f), _relWidth(relWidth), _relHeight(relHeight)
     {
-        int nrChannels;
-        unsigned char *data = stbi_load(path, &_textureWidth, &_textureHeight, &nrChannels, 4);
-        if (!data)
+        _sheet = _atlas->sheet(sheetName);
+        if (_sheet < 0)
         {
-            std::cerr << "Failed to load texture: " << path << std::endl;
+            cout << "Folha " << sheetName << " não está no atlas" << endl;
             return;
         }
 
-        glGenTextures(1, &_texID);
-        glBindTexture(GL_TEXTURE_2D, _texID);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _textureWidth, _textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-        stbi_image_free(data);
-
         float vertices[] = {
             // positions       // tex coords
             0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
@@ -106,7 +100,7 @@ public:
         glGenBuffers(1, &_vbo);
         glGenBuffers(1, &_ebo);
 
-        glBindVertexArray(_vao);
+        GLState::bindVertexArray(_vao);
 
         glBindBuffer(GL_ARRAY_BUFFER, _vbo);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -120,34 +114,36 @@ public:
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
 
-        glBindVertexArray(0);
+        GLState::bindVertexArray(0);
     }
 
-    void draw(int frameX, int frameY, mat4 modelMat, mat4 projMat)
+    int frameCount() const
     {
-        glUseProgram(_shaderID);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, _texID);
-        glUniform1i(glGetUniformLocation(_shaderID, "tex_buff"), 0);
+        return _sheet < 0 ? 0 : _atlas->frameCount(_sheet);
+    }
 
-        float offsetX = float(frameX * _frameWidth) / _textureWidth;
-        float offsetY = float(frameY * _frameHeight) / _textureHeight;
+    void draw(int frame, mat4 modelMat, mat4 projMat)
+    {
+        if (_sheet < 0)
+            return;
 
-        float scaleX = float(_frameWidth) / _textureWidth;
-        float scaleY = float(_frameHeight) / _textureHeight;
+        _shader->use();
 
-        offsetY = 1.0f - offsetY - scaleY;
+        // Todas as animações usam a mesma textura, então depois do primeiro frame nada disso chega ao driver
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, _atlas->texture());
+        _shader->setInt("tex_buff"_u, 0);
 
-        glUniform2f(glGetUniformLocation(_shaderID, "uvOffset"), offsetX, offsetY);
-        glUniform2f(glGetUniformLocation(_shaderID, "uvScale"), scaleX, scaleY);
+        // uv = (s0, t0, s1, t1) do quadro no atlas
+        vec4 uv = _atlas->uvRect(_sheet, frame % frameCount());
+        _shader->setVec2("uvOffset"_u, uv.x, uv.y);
+        _shader->setVec2("uvScale"_u, uv.z - uv.x, uv.w - uv.y);
 
-        glUniformMatrix4fv(glGetUniformLocation(_shaderID, "model"), 1, GL_FALSE, &modelMat[0][0]);
-        glUniformMatrix4fv(glGetUniformLocation(_shaderID, "projection"), 1, GL_FALSE, &projMat[0][0]);
+        _shader->setMat4("model"_u, modelMat);
+        _shader->setMat4("projection"_u, projMat);
 
-        glBindVertexArray(_vao);
+        GLState::bindVertexArray(_vao);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
     }
 };
 
@@ -171,24 +167,24 @@ private:
     bool _facingRight;
 
     float _x, _y;
-    int _frameX, _frameY;
+    float _prevX, _prevY; // posição no tique anterior, para interpolar o desenho
+    int _frame;
 
     float _animTimer;
     float _animSpeed;
 
 public:
     CharacterController(
-        const char *idlePath,
-        const char *walkPath,
-        const char *climbPath,
-        GLuint shaderID) : _idleSprite(idlePath, shaderID, 32, 32, 4, 1, 32, 32),
-                           _walkSprite(walkPath, shaderID, 32, 32, 4, 1, 32, 32),
-                           _climbSprite(climbPath, shaderID, 32, 32, 4, 2, 32, 32)
+        const TextureAtlas *atlas,
+        ShaderProgram *shader) : _idleSprite(atlas, "pinkMonsterIdle", shader, 32, 32),
+                                 _walkSprite(atlas, "pinkMonsterWalk", shader, 32, 32),
+                                 _climbSprite(atlas, "pinkMonsterClimb", shader, 32, 32)
     {
         _x = WIDTH / 2.0f;
         _y = HEIGHT / 2.0f;
-        _frameX = 0;
-        _frameY = 0;
+        _prevX = _x;
+        _prevY = _y;
+        _frame = 0;
         _currentSprite = &_idleSprite;
         _facingRight = true;
         _animTimer = 0.0f;
@@ -197,101 +193,64 @@ public:
         _projMat = glm::ortho(0.0f, float(WIDTH), float(HEIGHT), 0.0f, -1.0f, 1.0f);
     };
 
+    // Um tique da simulação, com dt fixo
     void handleInput(GLFWwindow *window, float dt)
     {
         const float speed = 150.0f;
-        bool isMoving = false;
+
+        _prevX = _x;
+        _prevY = _y;
 
         if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
         {
             _x += speed * dt;
             _currentSprite = &_walkSprite;
             _facingRight = true;
-            isMoving = true;
         }
         else if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
         {
             _x -= speed * dt;
             _currentSprite = &_walkSprite;
             _facingRight = false;
-            isMoving = true;
         }
         else if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
         {
             _y -= speed * dt;
             _currentSprite = &_climbSprite;
-            isMoving = true;
         }
         else
         {
             _currentSprite = &_idleSprite;
         }
 
-        if (isMoving)
-        {
-            animate(dt);
-            if (_currentSprite == &_climbSprite)
-                animateClimb(dt);
-        }
-        else
-        {
-            animateIdle(dt);
-        }
+        animate(dt);
     }
 
+    // Cada folha tem o seu número de quadros (a de andar tem 6)
     void animate(float dt)
     {
         _animTimer += dt;
         if (_animTimer >= _animSpeed)
         {
             _animTimer = 0.0f;
-            _frameX++;
-            if (_frameX >= 4)
-                _frameX = 0;
+            _frame = (_frame + 1) % std::max(1, _currentSprite->frameCount());
         }
     }
 
-    void update(float dt)
+    // alpha: fração do próximo tique já passada; a matriz só é montada aqui, com a posição interpolada
+    void draw(float alpha)
     {
-        _modelMat = mat4(1.0f);
-        _modelMat = translate(_modelMat, vec3(_x, _y, 0.0f));
-        float scaleX = _currentSprite->_relWidth * (_facingRight ? 1.0f : -1.0f);
-        float scaleY = _currentSprite->_relHeight;
-        _modelMat = scale(_modelMat, vec3(scaleX, scaleY, 1.0f));
-    }
+        float x = _prevX + (_x - _prevX) * alpha;
+        float y = _prevY + (_y - _prevY) * alpha;
 
-    void draw()
-    {
         _modelMat = glm::mat4(1.0f);
-        _modelMat = glm::translate(_modelMat, glm::vec3(_x, _y, 0.0f));
+        _modelMat = glm::translate(_modelMat, glm::vec3(x, y, 0.0f));
 
         float scaleX = _facingRight ? 1.0f : -1.0f;
 
         _modelMat = glm::scale(_modelMat, glm::vec3(scaleX * _currentSprite->_relWidth, _currentSprite->_relHeight, 1.0f));
 
-        _currentSprite->draw(_frameX, _frameY, _modelMat, _projMat);
-    }
-
-    void animateClimb(float dt)
-    {
-        _animTimer += dt;
-        if (_animTimer >= _animSpeed)
-        {
-            _animTimer = 0.0f;
-            _frameX = (_frameX + 1) % 4;
-            _frameY = 2;
-        }
-    }
-
-    void animateIdle(float dt)
-    {
-        _animTimer += dt;
-        if (_animTimer >= _animSpeed)
-        {
-            _animTimer = 0.0f;
-            _frameX = (_frameX + 1) % 4;
-            _frameY = 0;
-        }
+        _currentSprite->draw(_frame, _modelMat, _projMat);
     }
 };
 int main()
@@ -331,30 +290,52 @@ int main()
     glfwGetFramebufferSize(window, &width, &height);
     glViewport(0, 0, width, height);
 
-    GLuint shaderID = setupShader();
+    Profiler::init("DesafioAnimacao");
 
-    glUseProgram(shaderID);
+    ShaderProgram shader(createShaderProgram(vertexShaderSource, fragmentShaderSource));
+
+    shader.use();
 
     double prev_s = glfwGetTime();
     double title_countdown_s = 0.1;
 
-    float colorValue = 0.0;
+    GLState::activeTexture(GL_TEXTURE0);
 
-    glActiveTexture(GL_TEXTURE0);
+    shader.setInt("tex_buff"_u, 0);
 
-    glUniform1i(glGetUniformLocation(shaderID, "tex_buff"), 0);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_ALWAYS);
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_ALWAYS);
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // As três folhas do personagem em uma textura só; o atlas fica em cache ao lado dos PNGs
+    vector<AtlasSheet> sheets = {
+        {"pinkMonsterIdle", "../assets/sprites/pinkMonsterIdle.png", 32, 32},
+        {"pinkMonsterWalk", "../assets/sprites/pinkMonsterWalk.png", 32, 32},
+        {"pinkMonsterClimb", "../assets/sprites/pinkMonsterClimb.png", 32, 32},
+    };
+    TextureAtlas atlas;
+    if (!atlas.load("../assets/sprites/pinkMonster.atlas", sheets))
+    {
+        std::cerr << "Falha ao montar o atlas do personagem" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
 
-    CharacterController player("../assets/sprites/pinkMonsterIdle.png", "../assets/sprites/pinkMonsterWalk.png", "../assets/sprites/pinkMonsterClimb.png", shaderID);
+    CharacterController player(&atlas, &shader);
 
-    while (!glfwWindowShouldClose(window))
+    // As animações do personagem não param, nem ele parado
+    MainLoop loop(window);
+    loop.setAnimating(true);
+
+    auto tick = [&](double dt)
     {
+        player.handleInput(window, float(dt));
+    };
 
+    auto renderFrame = [&](double alpha)
+    {
         double curr_s = glfwGetTime();
         double elapsed_s = curr_s - prev_s;
         prev_s = curr_s;
@@ -362,79 +343,45 @@ int main()
         title_countdown_s -= elapsed_s;
         if (title_countdown_s <= 0.0 && elapsed_s > 0.0)
         {
-            double fps = 1.0 / elapsed_s;
+            const ShaderProgram::Stats &uniforms = ShaderProgram::frameStats();
+            const GLState::Stats &state = GLState::frameStats();
             char tmp[256];
-            snprintf(tmp, sizeof(tmp), "Ola Triangulo! -- Rossana\tFPS %.2lf", fps);
+            snprintf(tmp, sizeof(tmp), "Ola Triangulo! -- Rossana\t%s\tUniforms %d enviadas / %d evitadas\tEstado GL %d emitidas / %d evitadas",
+                     Profiler::frameSummary(), uniforms.uploads, uniforms.skipped, state.issued, state.skipped);
             glfwSetWindowTitle(window, tmp);
 
             title_countdown_s = 0.1;
         }
 
-        glfwPollEvents();
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        ShaderProgram::resetFrameStats();
+        GLState::resetFrameStats();
 
-        glLineWidth(10);
-        glPointSize(20);
+        {
+            ProfileScope cpu("draw");
+            GpuProfileScope gpu("draw");
 
-        glUseProgram(shaderID);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        player.handleInput(window, elapsed_s);
-        player.update(elapsed_s);
-        player.draw();
+            glLineWidth(10);
+            glPointSize(20);
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
+            shader.use();
+            player.draw(float(alpha));
+        }
+    };
+    loop.runFixed(TICK_S, tick, renderFrame);
 
+    atlas.clear();
+    Profiler::shutdown();
     glfwTerminate();
     return 0;
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
 {
+    Profiler::handleKey(key, action);
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
 }
-
-int setupShader()
-{
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    GLint success;
-    GLchar infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    GLuint shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n"
-                  << infoLog << std::endl;
-    }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return shaderProgram;
-}
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <stb_image.h>
+
+#include "MipChain.h"
+#include "TextureFile.h"
+#include "TiledImage.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/*
+ * TextureCook: gera os .ptex (pixels decodificados + mipmaps) ao lado de cada PNG.
+ *
+ * Uso:
+ *   TextureCook [--bgra] [--force] [--filter box|tent] [--tiles] [--tile-size N] <imagem.png | pasta>...
+ *   TextureCook --bench <imagem.png | pasta>...
+ *
+ * --bgra       grava os pixels já trocados para GL_BGRA
+ * --force      refaz mesmo se o .ptex for mais novo que a imagem
+ * --filter     filtro dos mipmaps (MipChain.h): box (padrão, igual ao glGenerateMipmap) ou tent
+ * --tiles      grava também a pirâmide de tiles (.ptiles) para o TileStreamer
+ * --tile-size  lado dos tiles em pixels, potência de 2 entre 64 e 1024 (padrão 256)
+ * --bench      compara, por asset, o tempo de stbi_load com o de mapear o .ptex
+ */
+
+struct Options
+{
+    bool bgra = false;
+    bool force = false;
+    bool bench = false;
+    bool tiles = false;
+    int tileSize = 256;
+    MipFilter filter = MIP_FILTER_BOX;
+};
+
+double elapsedMs(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+vector<string> collectImages(const vector<string> &inputs)
+{
+    vector<string> images;
+    for (const string &input : inputs)
+    {
+        if (fs::is_directory(input))
+        {
+            for (const auto &entry : fs::recursive_directory_iterator(input))
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".png")
+                    images.push_back(entry.path().string());
+            }
+        }
+        else
+        {
+            images.push_back(input);
+        }
+    }
+    sort(images.begin(), images.end());
+    return images;
+}
+
+// O .ptex existente serve se for mais novo que a imagem e tiver sido gerado com o mesmo filtro e a mesma ordem dos canais
+bool upToDate(const string &path, const string &output, const Options &options)
+{
+    error_code ec;
+    if (!fs::exists(output, ec) || fs::last_write_time(output, ec) < fs::last_write_time(path, ec))
+        return false;
+
+    MappedFile file;
+    const TextureFileHeader *header = file.open(output) ? textureFileHeader(file) : nullptr;
+    return header && header->filter == uint32_t(options.filter) &&
+           header->layout == uint32_t(options.bgra ? LAYOUT_BGRA : LAYOUT_RGBA);
+}
+
+// Mesma regra para o .ptiles, com o mesmo lado de tile, filtro e ordem dos canais
+bool tilesUpToDate(const string &path, const string &output, const Options &options)
+{
+    error_code ec;
+    if (!fs::exists(output, ec) || fs::last_write_time(output, ec) < fs::last_write_time(path, ec))
+        return false;
+
+    MappedFile file;
+    const TiledImageHeader *header = file.open(output) ? tiledImageHeader(file) : nullptr;
+    return header && header->tileSize == uint32_t(options.tileSize) && header->filter == uint32_t(options.filter) &&
+           header->layout == uint32_t(options.bgra ? LAYOUT_BGRA : LAYOUT_RGBA);
+}
+
+bool cook(const string &path, const Options &options)
+{
+    string output = textureFilePath(path);
+    string tilesOutput = tiledImagePath(path);
+
+    error_code ec;
+    bool cookTexture = options.force || !upToDate(path, output, options);
+    bool cookTiles = options.tiles && (options.force || !tilesUpToDate(path, tilesOutput, options));
+    if (!cookTexture && !cookTiles)
+    {
+        cout << "  " << path << " (atualizado)" << endl;
+        return true;
+    }
+
+    auto start = chrono::steady_clock::now();
+
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
+    if (!data)
+    {
+        cerr << "Falha ao carregar " << path << ": " << stbi_failure_reason() << endl;
+        return false;
+    }
+
+    auto mipStart = chrono::steady_clock::now();
+    vector<vector<uint8_t>> levels = buildMipChain(data, width, height, options.filter);
+    double mipMs = elapsedMs(mipStart);
+    stbi_image_free(data);
+
+    TextureFileLayout layout = options.bgra ? LAYOUT_BGRA : LAYOUT_RGBA;
+    if (cookTexture && !writeTextureFile(output, levels, width, height, layout, fs::file_size(path, ec), options.filter))
+    {
+        cerr << "Falha ao gravar " << output << endl;
+        return false;
+    }
+    if (cookTiles && !writeTiledImage(tilesOutput, levels, width, height, options.tileSize, layout, fs::file_size(path, ec),
+                                     options.filter))
+    {
+        cerr << "Falha ao gravar " << tilesOutput << endl;
+        return false;
+    }
+
+    string outputs = cookTexture ? output : "";
+    if (cookTiles)
+        outputs += (outputs.empty() ? "" : " + ") + tilesOutput;
+    printf("  %s -> %s (%dx%d, %zu níveis, mipmaps %.1f ms, total %.1f ms)\n", path.c_str(), outputs.c_str(),
+           width, height, levels.size(), mipMs, elapsedMs(start));
+    return true;
+}
+
+void bench(const string &path)
+{
+    auto start = chrono::steady_clock::now();
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
+    double stbiMs = elapsedMs(start);
+    if (!data)
+    {
+        cerr << "Falha ao carregar " << path << endl;
+        return;
+    }
+    stbi_image_free(data);
+
+    start = chrono::steady_clock::now();
+    MappedFile file;
+    const TextureFileHeader *header = file.open(textureFilePath(path)) ? textureFileHeader(file) : nullptr;
+    if (!header)
+    {
+        printf("%-40s %5dx%-5d %10.2f %10s\n", path.c_str(), width, height, stbiMs, "sem .ptex");
+        return;
+    }
+
+    // Toca uma vez em cada página do nível 0, como o upload faria
+    const TextureFileLevel &level = header->levels[0];
+    volatile uint8_t sink = 0;
+    for (uint64_t offset = 0; offset < level.size; offset += 4096)
+        sink += file.data()[level.offset + offset];
+    double ptexMs = elapsedMs(start);
+
+    printf("%-40s %5dx%-5d %10.2f %10.2f %8.1fx\n", path.c_str(), width, height, stbiMs, ptexMs,
+           stbiMs / max(ptexMs, 0.001));
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    vector<string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bgra") == 0)
+            options.bgra = true;
+        else if (strcmp(argv[i], "--force") == 0)
+            options.force = true;
+        else if (strcmp(argv[i], "--bench") == 0)
+            options.bench = true;
+        else if (strcmp(argv[i], "--tiles") == 0)
+            options.tiles = true;
+        else if (strcmp(argv[i], "--tile-size") == 0 && i + 1 < argc)
+        {
+            options.tileSize = atoi(argv[++i]);
+            if (options.tileSize < 64 || options.tileSize > 1024 || (options.tileSize & (options.tileSize - 1)) != 0)
+            {
+                cerr << "Tamanho de tile inválido: " << argv[i] << " (potência de 2 entre 64 e 1024)" << endl;
+                return 1;
+            }
+            options.tiles = true;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            string filter = argv[++i];
+            if (filter != "box" && filter != "tent")
+            {
+                cerr << "Filtro desconhecido: " << filter << " (use box ou tent)" << endl;
+                return 1;
+            }
+            options.filter = filter == "tent" ? MIP_FILTER_TENT : MIP_FILTER_BOX;
+        }
+        else
+            inputs.push_back(argv[i]);
+    }
+
+    if (inputs.empty())
+    {
+        cout << "Uso: TextureCook [--bgra] [--force] [--filter box|tent] [--tiles] [--tile-size N] [--bench] <imagem.png | pasta>..."
+             << endl;
+        return 1;
+    }
+
+    vector<string> images = collectImages(inputs);
+
+    if (options.bench)
+    {
+        printf("%-40s %11s %10s %10s %9s\n", "asset", "tamanho", "stbi (ms)", "ptex (ms)", "ganho");
+        for (const string &image : images)
+            bench(image);
+        return 0;
+    }
+
+    int failures = 0;
+    cout << "Cozinhando " << images.size() << " imagens (mipmaps " << mipFilterName(options.filter) << ", kernel "
+         << mipKernelName(resolveMipKernel(MIP_KERNEL_AUTO)) << ")" << endl;
+    for (const string &image : images)
+    {
+        if (!cook(image, options))
+            failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}